@@ -360,3 +360,25 @@ let package = Package(
         ),
     ]
 )
+
+// Like FOUNDATION_BUILD_BENCHMARKS in the CMake build, the benchmark suite is
+// only built when asked for, so that `swift build` and `swift test` skip it.
+if Context.environment["FOUNDATION_BUILD_BENCHMARKS"] == "1" {
+    package.targets.append(
+        .executableTarget(
+            name: "FoundationBenchmarks",
+            dependencies: [
+                "Foundation",
+                .target(name: "FoundationNetworking", condition: .when(platforms: platformsWithThreads)),
+                "CoreFoundation"
+            ],
+            exclude: [
+                "CMakeLists.txt"
+            ],
+            swiftSettings: [
+                .define("FOUNDATION_BENCHMARKS_NETWORKING", .when(platforms: platformsWithThreads)),
+                .swiftLanguageMode(.v6)
+            ]
+        )
+    )
+}
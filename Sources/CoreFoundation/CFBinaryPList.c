@@ -382,9 +382,129 @@ static void _appendNumber(__CFBinaryPlistWriteBuffer *buf, CFNumberRef num, Bool
     }
 }
 
-static Boolean _appendObject(__CFBinaryPlistWriteBuffer *buf, CFTypeRef obj, CFDictionaryRef objtable, uint32_t objRefSize, Boolean dryRun) {
-    uint64_t refnum;
-    CFIndex idx2;
+#pragma mark Object tables
+
+/* While a plist is flattened for writing, every object pointer seen is
+   entered in an identity table, mapping it to its object number; an object
+   met again through the same pointer costs one pointer-hashed probe. Leaves
+   (strings, numbers, dates and data) seen for the first time are then
+   uniqued by content in a second table, which keeps each leaf's CFHash, so
+   each distinct leaf is hashed once and compared with CFEqual only when the
+   hashes match. Both are flat, linearly probed tables. */
+
+typedef struct {
+    CFTypeRef object;   // NULL if the entry is empty
+    CFHashCode hash;
+    uint32_t refnum;
+} __CFBinaryPlistTableEntry;
+
+typedef struct {
+    __CFBinaryPlistTableEntry *entries;
+    CFIndex mask;
+    CFIndex count;
+} __CFBinaryPlistTable;
+
+typedef struct {
+    CFTypeRef *objects;
+    CFIndex count;
+    CFIndex capacity;
+} __CFBinaryPlistObjectList;
+
+CF_INLINE CFHashCode __CFBinaryPlistPointerHash(CFTypeRef obj) {
+    uint64_t h = (uint64_t)(uintptr_t)obj;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (CFHashCode)h;
+}
+
+static void __CFBinaryPlistTableInit(__CFBinaryPlistTable *table, uint64_t estimate) {
+    CFIndex size = 64;
+    while ((uint64_t)size < 2 * estimate && size < (1L << 24)) size *= 2;
+    table->entries = (__CFBinaryPlistTableEntry *)CFAllocatorAllocate(kCFAllocatorSystemDefault, size * sizeof(__CFBinaryPlistTableEntry), 0);
+    memset(table->entries, 0, size * sizeof(__CFBinaryPlistTableEntry));
+    table->mask = size - 1;
+    table->count = 0;
+}
+
+static void __CFBinaryPlistTableDestroy(__CFBinaryPlistTable *table) {
+    CFAllocatorDeallocate(kCFAllocatorSystemDefault, table->entries);
+}
+
+static void __CFBinaryPlistTableGrow(__CFBinaryPlistTable *table) {
+    __CFBinaryPlistTableEntry *old = table->entries;
+    CFIndex oldSize = table->mask + 1, size = oldSize * 2;
+    table->entries = (__CFBinaryPlistTableEntry *)CFAllocatorAllocate(kCFAllocatorSystemDefault, size * sizeof(__CFBinaryPlistTableEntry), 0);
+    memset(table->entries, 0, size * sizeof(__CFBinaryPlistTableEntry));
+    table->mask = size - 1;
+    for (CFIndex idx = 0; idx < oldSize; idx++) {
+        if (!old[idx].object) continue;
+        CFIndex probe = old[idx].hash & table->mask;
+        while (table->entries[probe].object) probe = (probe + 1) & table->mask;
+        table->entries[probe] = old[idx];
+    }
+    CFAllocatorDeallocate(kCFAllocatorSystemDefault, old);
+}
+
+// Returns the entry holding obj, or the empty entry where it would be inserted.
+CF_INLINE __CFBinaryPlistTableEntry *__CFBinaryPlistTableLookup(const __CFBinaryPlistTable *table, CFTypeRef obj, CFHashCode hash, Boolean byContent) {
+    CFIndex probe = hash & table->mask;
+    for (;;) {
+        __CFBinaryPlistTableEntry *entry = &table->entries[probe];
+        if (!entry->object) return entry;
+        if (entry->object == obj) return entry;
+        if (byContent && entry->hash == hash && CFEqual(entry->object, obj)) return entry;
+        probe = (probe + 1) & table->mask;
+    }
+}
+
+// Fills an empty entry returned by __CFBinaryPlistTableLookup; the entry must not be used afterwards.
+CF_INLINE void __CFBinaryPlistTableInsert(__CFBinaryPlistTable *table, __CFBinaryPlistTableEntry *entry, CFTypeRef obj, CFHashCode hash, uint32_t refnum) {
+    entry->object = obj;
+    entry->hash = hash;
+    entry->refnum = refnum;
+    table->count++;
+    if (2 * table->count > table->mask + 1) __CFBinaryPlistTableGrow(table);
+}
+
+CF_INLINE uint32_t __CFBinaryPlistTableGetRefnum(const __CFBinaryPlistTable *table, CFTypeRef obj) {
+    return __CFBinaryPlistTableLookup(table, obj, __CFBinaryPlistPointerHash(obj), false)->refnum;
+}
+
+static uint32_t __CFBinaryPlistObjectListAppend(__CFBinaryPlistObjectList *list, CFTypeRef obj) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 256;
+        list->objects = (CFTypeRef *)CFAllocatorReallocate(kCFAllocatorSystemDefault, list->objects, list->capacity * sizeof(CFTypeRef), 0);
+    }
+    list->objects[list->count] = CFRetain(obj);
+    return (uint32_t)list->count++;
+}
+
+static void __CFBinaryPlistObjectListDestroy(__CFBinaryPlistObjectList *list) {
+    for (CFIndex idx = 0; idx < list->count; idx++) CFRelease(list->objects[idx]);
+    if (list->objects) CFAllocatorDeallocate(kCFAllocatorSystemDefault, list->objects);
+}
+
+#pragma mark Objects
+
+// Writes the object references of a container, a block at a time rather than one reference per bufferWrite.
+static void _appendRefs(__CFBinaryPlistWriteBuffer *buf, const CFPropertyListRef *values, CFIndex count, const __CFBinaryPlistTable *objtable, uint32_t objRefSize, Boolean dryRun) {
+    uint8_t refs[1024];
+    CFIndex used = 0;
+    for (CFIndex idx = 0; idx < count; idx++) {
+        uint32_t refnum = __CFBinaryPlistTableGetRefnum(objtable, values[idx]);
+        for (uint32_t byte = objRefSize; byte > 0; byte--) {
+            refs[used++] = (uint8_t)(refnum >> (8 * (byte - 1)));
+        }
+        if ((CFIndex)sizeof(refs) - used < 4) {
+            bufferWrite(buf, refs, used, dryRun);
+            used = 0;
+        }
+    }
+    bufferWrite(buf, refs, used, dryRun);
+}
+
+static Boolean _appendObject(__CFBinaryPlistWriteBuffer *buf, CFTypeRef obj, const __CFBinaryPlistTable *objtable, uint32_t objRefSize, Boolean dryRun) {
     CFTypeID type = CFGetTypeID(obj);
 	if (_kCFRuntimeIDCFString == type) {
 	    _appendString(buf, (CFStringRef)obj, dryRun);
@@ -417,22 +537,7 @@ static Boolean _appendObject(__CFBinaryPlistWriteBuffer *buf, CFTypeRef obj, CFD
             CFPropertyListRef *list, buffer[512];
             list = (count <= 256) ? buffer : (CFPropertyListRef *)CFAllocatorAllocate(kCFAllocatorSystemDefault, 2 * count * sizeof(CFTypeRef), 0);
             CFDictionaryGetKeysAndValues((CFDictionaryRef)obj, list, list + count);
-            for (idx2 = 0; idx2 < 2 * count; idx2++) {
-		CFPropertyListRef value = list[idx2];
-		if (objtable) {
-		    uint32_t swapped = 0;
-		    uint8_t *source = (uint8_t *)&swapped;
-		    refnum = (uint32_t)(uintptr_t)CFDictionaryGetValue(objtable, value);
-		    swapped = CFSwapInt32HostToBig((uint32_t)refnum);
-		    bufferWrite(buf, source + sizeof(swapped) - objRefSize, objRefSize, dryRun);
-		} else {
-		    Boolean ret = _appendObject(buf, value, objtable, objRefSize, dryRun);
-		    if (!ret) {
-			if (list != buffer) CFAllocatorDeallocate(kCFAllocatorSystemDefault, list);
-			return false;
-		    }
-		}
-            }
+            _appendRefs(buf, list, 2 * count, objtable, objRefSize, dryRun);
             if (list != buffer) CFAllocatorDeallocate(kCFAllocatorSystemDefault, list);
 	} else if (_kCFRuntimeIDCFArray == type) {
 	    CFIndex count = CFArrayGetCount((CFArrayRef)obj);
@@ -444,22 +549,7 @@ static Boolean _appendObject(__CFBinaryPlistWriteBuffer *buf, CFTypeRef obj, CFD
 	    }
 	    list = (count <= 256) ? buffer : (CFPropertyListRef *)CFAllocatorAllocate(kCFAllocatorSystemDefault, count * sizeof(CFTypeRef), 0);
 	    CFArrayGetValues((CFArrayRef)obj, CFRangeMake(0, count), list);
-	    for (idx2 = 0; idx2 < count; idx2++) {
-		CFPropertyListRef value = list[idx2];
-		if (objtable) {
-		    uint32_t swapped = 0;
-		    uint8_t *source = (uint8_t *)&swapped;
-		    refnum = (uint32_t)(uintptr_t)CFDictionaryGetValue(objtable, value);
-		    swapped = CFSwapInt32HostToBig((uint32_t)refnum);
-		    bufferWrite(buf, source + sizeof(swapped) - objRefSize, objRefSize, dryRun);
-		} else {
-		    Boolean ret = _appendObject(buf, value, objtable, objRefSize, dryRun);
-		    if (!ret) {
-			if (list != buffer) CFAllocatorDeallocate(kCFAllocatorSystemDefault, list);
-			return false;
-		    }
-		}
-	    }
+	    _appendRefs(buf, list, count, objtable, objRefSize, dryRun);
 	    if (list != buffer) CFAllocatorDeallocate(kCFAllocatorSystemDefault, list);
 	} else if (_CFKeyedArchiverUIDGetTypeID() == type) {
 	    _appendUID(buf, (CFKeyedArchiverUIDRef)obj, dryRun);
@@ -469,36 +559,39 @@ static Boolean _appendObject(__CFBinaryPlistWriteBuffer *buf, CFTypeRef obj, CFD
     return true;
 }
 
-static void _flattenPlist(CFPropertyListRef plist, CFMutableArrayRef objlist, CFMutableDictionaryRef objtable, CFMutableSetRef uniquingset) {
-    uint32_t refnum;
+static void _flattenPlist(CFPropertyListRef plist, __CFBinaryPlistObjectList *objlist, __CFBinaryPlistTable *identities, __CFBinaryPlistTable *contents) {
+    CFHashCode pointerHash = __CFBinaryPlistPointerHash(plist);
+    __CFBinaryPlistTableEntry *identity = __CFBinaryPlistTableLookup(identities, plist, pointerHash, false);
+    if (identity->object) {
+        // This very object has already been flattened.
+        return;
+    }
+
+    uint32_t refnum = (uint32_t)objlist->count;
     CFTypeID type = CFGetTypeID(plist);
 
-    // Do not unique dictionaries or arrays, because: they
+    // Do not unique dictionaries or arrays by content, because: they
     // are slow to compare, and have poor hash codes.
     // Uniquing bools is unnecessary.
     if (_kCFRuntimeIDCFString == type || _kCFRuntimeIDCFNumber == type || _kCFRuntimeIDCFDate == type || _kCFRuntimeIDCFData == type) {
-	CFIndex before = CFSetGetCount(uniquingset);
-	CFSetAddValue(uniquingset, plist);
-	CFIndex after = CFSetGetCount(uniquingset);
-	if (after == before) {	// already in set
-	    CFPropertyListRef unique = CFSetGetValue(uniquingset, plist);
-	    if (unique != plist) {
-		refnum = (uint32_t)(uintptr_t)CFDictionaryGetValue(objtable, unique);
-		CFDictionaryAddValue(objtable, plist, (const void *)(uintptr_t)refnum);
-	    }
-	    return;
-	}
+        CFHashCode hash = CFHash(plist);
+        __CFBinaryPlistTableEntry *unique = __CFBinaryPlistTableLookup(contents, plist, hash, true);
+        if (unique->object) {
+            __CFBinaryPlistTableInsert(identities, identity, plist, pointerHash, unique->refnum);
+            return;
+        }
+        __CFBinaryPlistTableInsert(contents, unique, plist, hash, refnum);
     }
-    refnum = CFArrayGetCount(objlist);
-    CFArrayAppendValue(objlist, plist);
-    CFDictionaryAddValue(objtable, plist, (const void *)(uintptr_t)refnum);
+    __CFBinaryPlistTableInsert(identities, identity, plist, pointerHash, refnum);
+    __CFBinaryPlistObjectListAppend(objlist, plist);
+
     if (_kCFRuntimeIDCFDictionary == type) {
         CFIndex count = CFDictionaryGetCount((CFDictionaryRef)plist);
         STACK_BUFFER_DECL(CFPropertyListRef, buffer, (count > 0 && count <= 128) ? count * 2 : 1);
         CFPropertyListRef *list = (count <= 128) ? buffer : (CFPropertyListRef *)CFAllocatorAllocate(kCFAllocatorSystemDefault, 2 * count * sizeof(CFTypeRef), 0);
         CFDictionaryGetKeysAndValues((CFDictionaryRef)plist, list, list + count);
         for (CFIndex idx = 0; idx < 2 * count; idx++) {
-            _flattenPlist(list[idx], objlist, objtable, uniquingset);
+            _flattenPlist(list[idx], objlist, identities, contents);
         }
         if (list != buffer) CFAllocatorDeallocate(kCFAllocatorSystemDefault, list);
     } else if (_kCFRuntimeIDCFArray == type) {
@@ -507,7 +600,7 @@ static void _flattenPlist(CFPropertyListRef plist, CFMutableArrayRef objlist, CF
         CFPropertyListRef *list = (count <= 256) ? buffer : (CFPropertyListRef *)CFAllocatorAllocate(kCFAllocatorSystemDefault, count * sizeof(CFTypeRef), 0);
         CFArrayGetValues((CFArrayRef)plist, CFRangeMake(0, count), list);
         for (CFIndex idx = 0; idx < count; idx++) {
-            _flattenPlist(list[idx], objlist, objtable, uniquingset);
+            _flattenPlist(list[idx], objlist, identities, contents);
         }
         if (list != buffer) CFAllocatorDeallocate(kCFAllocatorSystemDefault, list);
     }
@@ -537,9 +630,8 @@ CF_INLINE uint8_t _byteCount(uint64_t count) {
 // stream can be a CFWriteStreamRef (on supported platforms) or a CFMutableDataRef
 /* Write a property list to a stream, in binary format. plist is the property list to write (one of the basic property list types), stream is the destination of the property list, and estimate is a best-guess at the total number of objects in the property list. The estimate parameter is for efficiency in pre-allocating memory for the uniquing step. Pass in a 0 if no estimate is available. The options flag specifies sort options. If sizeOnly is true, then no actual buffer allocations will be done, but the necessary buffer size will be calculated and return. If the error parameter is non-NULL and an error occurs, it will be used to return a CFError explaining the problem. It is the callers responsibility to release the error. */
 CF_PRIVATE CFIndex __CFBinaryPlistWriteOrPresize(CFPropertyListRef plist, CFTypeRef stream, uint64_t estimate, CFOptionFlags options, Boolean sizeOnly, CFErrorRef *error) {
-    CFMutableDictionaryRef objtable = NULL;
-    CFMutableArrayRef objlist = NULL;
-    CFMutableSetRef uniquingset = NULL;
+    __CFBinaryPlistTable objtable, uniquingtable;
+    __CFBinaryPlistObjectList objlist = {NULL, 0, 0};
     CFBinaryPlistTrailer trailer;
     uint64_t *offsets, length_so_far;
     int64_t idx, cnt;
@@ -548,30 +640,14 @@ CF_PRIVATE CFIndex __CFBinaryPlistWriteOrPresize(CFPropertyListRef plist, CFType
     //If we're actually serializing, rather than just pre-sizing, we have to have something to serialize into.
     CFAssert(stream || sizeOnly, __kCFLogAssertion, "Passing NULL for the stream argument to __CFBinaryPlistWriteOrPresize is only valid if sizeOnly is true");
 
-    /*
-     This is exactly the same as a CFDictionary with NULL callbacks, except that it has the "aggressive growth" flag set, since we're not keeping it around. Radar 21883482
-     */
-    CFBasicHashCallbacks callbacks = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    objtable = 	(CFMutableDictionaryRef)CFBasicHashCreate(kCFAllocatorSystemDefault, kCFBasicHashHasKeys | kCFBasicHashLinearHashing | kCFBasicHashAggressiveGrowth, &callbacks);
-    _CFRuntimeSetInstanceTypeIDAndIsa(objtable, _kCFRuntimeIDCFDictionary);
-    
-    const CFArrayCallBacks arrayCallbacks = {0, __CFTypeCollectionRetain, __CFTypeCollectionRelease, 0, 0};
-    objlist = CFArrayCreateMutable(kCFAllocatorSystemDefault, 0, &arrayCallbacks);
-    
-    const CFSetCallBacks setCallbacks = {0, __CFTypeCollectionRetain, __CFTypeCollectionRelease, 0, 0, 0};
-    uniquingset = CFSetCreateMutable(kCFAllocatorSystemDefault, 0, &setCallbacks);
-
-#if TARGET_OS_OSX
-    _CFDictionarySetCapacity(objtable, estimate ? estimate : 650);
-    _CFArraySetCapacity(objlist, estimate ? estimate : 650);
-    _CFSetSetCapacity(uniquingset, estimate ? estimate : 1000);
-#endif
+    __CFBinaryPlistTableInit(&objtable, estimate ? estimate : 650);
+    __CFBinaryPlistTableInit(&uniquingtable, estimate ? estimate : 650);
 
-    _flattenPlist(plist, objlist, objtable, uniquingset);
+    _flattenPlist(plist, &objlist, &objtable, &uniquingtable);
 
-    CFRelease(uniquingset);
+    __CFBinaryPlistTableDestroy(&uniquingtable);
     
-    cnt = CFArrayGetCount(objlist);
+    cnt = objlist.count;
     offsets = (uint64_t *)CFAllocatorAllocate(kCFAllocatorSystemDefault, (CFIndex)(cnt * sizeof(*offsets)), 0);
 
     buf = (__CFBinaryPlistWriteBuffer *)CFAllocatorAllocate(kCFAllocatorSystemDefault, sizeof(__CFBinaryPlistWriteBuffer), 0);
@@ -590,11 +666,11 @@ CF_PRIVATE CFIndex __CFBinaryPlistWriteOrPresize(CFPropertyListRef plist, CFType
     trailer._objectRefSize = _byteCount(cnt);    
     for (idx = 0; idx < cnt; idx++) {
 	offsets[idx] = buf->written + buf->used;
-	CFPropertyListRef obj = CFArrayGetValueAtIndex(objlist, (CFIndex)idx);
-	Boolean success = _appendObject(buf, obj, objtable, trailer._objectRefSize, sizeOnly);
+	CFPropertyListRef obj = objlist.objects[idx];
+	Boolean success = _appendObject(buf, obj, &objtable, trailer._objectRefSize, sizeOnly);
 	if (!success) {
-	    CFRelease(objtable);
-	    CFRelease(objlist);
+	    __CFBinaryPlistTableDestroy(&objtable);
+	    __CFBinaryPlistObjectListDestroy(&objlist);
 	    if (error && buf->error) {
 		// caller will release error
 		*error = buf->error;
@@ -607,18 +683,22 @@ CF_PRIVATE CFIndex __CFBinaryPlistWriteOrPresize(CFPropertyListRef plist, CFType
 	    return 0;
 	}
     }
-    CFRelease(objtable);
-    CFRelease(objlist);
+    __CFBinaryPlistTableDestroy(&objtable);
+    __CFBinaryPlistObjectListDestroy(&objlist);
     
     length_so_far = buf->written + buf->used;
     trailer._offsetTableOffset = CFSwapInt64HostToBig(length_so_far);
     trailer._offsetIntSize = _byteCount(length_so_far);
     
+    // Encode the offset table in place, over the offsets already consumed, and write it all at once.
+    uint8_t *table = (uint8_t *)offsets;
     for (idx = 0; idx < cnt; idx++) {
-	uint64_t swapped = CFSwapInt64HostToBig(offsets[idx]);
-	uint8_t *source = (uint8_t *)&swapped;
-	bufferWrite(buf, source + sizeof(*offsets) - trailer._offsetIntSize, trailer._offsetIntSize, sizeOnly);
+	uint64_t offset = offsets[idx];
+	for (uint8_t byte = trailer._offsetIntSize; byte > 0; byte--) {
+	    *table++ = (uint8_t)(offset >> (8 * (byte - 1)));
+	}
     }
+    bufferWrite(buf, (uint8_t *)offsets, (CFIndex)(cnt * trailer._offsetIntSize), sizeOnly);
     length_so_far += cnt * trailer._offsetIntSize;
     CFAllocatorDeallocate(kCFAllocatorSystemDefault, offsets);
 
@@ -844,6 +844,29 @@ CF_BREAKPOINT_FUNCTION(void _CFRunLoopError_MainThreadHasExited(void));
 
 typedef struct __CFRunLoopMode *CFRunLoopModeRef;
 
+/* Each mode keeps its timers in a binary min-heap ordered by fire TSR, with ties broken by a
+ * sequence number so that timers with equal fire dates still fire in the order they were
+ * (re)scheduled, as they did in the sorted array this replaces.  A timer owns one node per mode
+ * it is in, chained through _nextInTimer; the node tracks its own heap index so that adding,
+ * removing and rescheduling a timer are O(log n) instead of an O(n) search and memmove.
+ * Nodes and heaps are protected by the run loop lock and the mode lock.
+ */
+typedef struct __CFRunLoopTimerHeapNode {
+    CFRunLoopTimerRef _timer;   /* retained */
+    CFRunLoopModeRef _mode;     /* not retained */
+    struct __CFRunLoopTimerHeapNode *_nextInTimer;
+    uint64_t _fireTSR;          /* the timer's _fireTSR when it was last positioned */
+    uint64_t _sequence;
+    CFIndex _index;             /* position in _mode's heap */
+} __CFRunLoopTimerHeapNode;
+
+typedef struct {
+    __CFRunLoopTimerHeapNode **_nodes;
+    CFIndex _count;
+    CFIndex _capacity;
+    uint64_t _nextSequence;
+} __CFRunLoopTimerHeap;
+
 struct __CFRunLoopMode {
     CFRuntimeBase _base;
     _CFRecursiveMutex _lock;	/* must have the run loop locked before locking this */
@@ -853,7 +876,7 @@ struct __CFRunLoopMode {
     CFMutableSetRef _sources0;
     CFMutableSetRef _sources1;
     CFMutableArrayRef _observers;
-    CFMutableArrayRef _timers;
+    __CFRunLoopTimerHeap _timers;
     CFMutableDictionaryRef _portToV1SourceMap;
     __CFPortSet _portSet;
     CFIndex _observerMask;
@@ -871,8 +894,11 @@ struct __CFRunLoopMode {
 #endif
     uint64_t _timerSoftDeadline; /* TSR */
     uint64_t _timerHardDeadline; /* TSR */
+    _CFRunLoopStatistics _statistics; /* protected by _lock */
 };
 
+static CFArrayRef __CFRunLoopTimerHeapCopyTimers(__CFRunLoopTimerHeap *heap, uint64_t limitTSR, Boolean onlyFireable);
+
 CF_INLINE void __CFRunLoopModeLock(CFRunLoopModeRef rlm) {
     _CFRecursiveMutexLock(&(rlm->_lock));
     //CFLog(6, CFSTR("__CFRunLoopModeLock locked %p"), rlm);
@@ -883,6 +909,53 @@ CF_INLINE void __CFRunLoopModeUnlock(CFRunLoopModeRef rlm) {
     _CFRecursiveMutexUnlock(&(rlm->_lock));
 }
 
+#pragma mark -
+#pragma mark Statistics
+
+CF_INLINE CFIndex __CFRunLoopCalloutHistogramBucket(uint64_t nanoseconds) {
+    uint64_t microseconds = nanoseconds / 1000;
+    CFIndex bucket = 0;
+    while (microseconds && bucket < _kCFRunLoopCalloutHistogramBucketCount - 1) {
+        microseconds >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+CF_INLINE void __CFRunLoopCalloutStatisticsAdd(_CFRunLoopCalloutStatistics *stats, const void *callout, uint64_t startTSR, uint64_t endTSR) {
+    uint64_t nanoseconds = (endTSR > startTSR) ? __CFTSRToNanoseconds(endTSR - startTSR) : 0;
+    if (0 == stats->count || stats->maxNanoseconds < nanoseconds) {
+        stats->maxNanoseconds = nanoseconds;
+        stats->slowestCallout = callout;
+    }
+    stats->count++;
+    stats->totalNanoseconds += nanoseconds;
+    stats->histogram[__CFRunLoopCalloutHistogramBucket(nanoseconds)]++;
+}
+
+static void __CFRunLoopCalloutStatisticsMerge(_CFRunLoopCalloutStatistics *into, const _CFRunLoopCalloutStatistics *from) {
+    if (0 == from->count) return;
+    if (0 == into->count || into->maxNanoseconds < from->maxNanoseconds) {
+        into->maxNanoseconds = from->maxNanoseconds;
+        into->slowestCallout = from->slowestCallout;
+    }
+    into->count += from->count;
+    into->totalNanoseconds += from->totalNanoseconds;
+    for (CFIndex idx = 0; idx < _kCFRunLoopCalloutHistogramBucketCount; idx++) {
+        into->histogram[idx] += from->histogram[idx];
+    }
+}
+
+static void __CFRunLoopStatisticsMerge(_CFRunLoopStatistics *into, const _CFRunLoopStatistics *from) {
+    into->wakeUps += from->wakeUps;
+    into->nanosecondsAsleep += from->nanosecondsAsleep;
+    into->totalTimerLatenessNanoseconds += from->totalTimerLatenessNanoseconds;
+    if (into->maxTimerLatenessNanoseconds < from->maxTimerLatenessNanoseconds) into->maxTimerLatenessNanoseconds = from->maxTimerLatenessNanoseconds;
+    for (CFIndex kind = 0; kind < _kCFRunLoopCalloutKindCount; kind++) {
+        __CFRunLoopCalloutStatisticsMerge(&into->callouts[kind], &from->callouts[kind]);
+    }
+}
+
 static Boolean __CFRunLoopModeEqual(CFTypeRef cf1, CFTypeRef cf2) {
     CFRunLoopModeRef rlm1 = (CFRunLoopModeRef)cf1;
     CFRunLoopModeRef rlm2 = (CFRunLoopModeRef)cf2;
@@ -908,7 +981,9 @@ static CFStringRef __CFRunLoopModeCopyDescription(CFTypeRef cf) {
 #if TARGET_OS_WIN32
     CFStringAppendFormat(result, NULL, CFSTR("MSGQ mask = %p, "), rlm->_msgQMask);
 #endif
-    CFStringAppendFormat(result, NULL, CFSTR("\n\tsources0 = %@,\n\tsources1 = %@,\n\tobservers = %@,\n\ttimers = %@,\n\tcurrently %0.09g (%lld) / soft deadline in: %0.09g sec (@ %lld) / hard deadline in: %0.09g sec (@ %lld)\n},\n"), rlm->_sources0, rlm->_sources1, rlm->_observers, rlm->_timers, CFAbsoluteTimeGetCurrent(), mach_absolute_time(), __CFTSRToTimeInterval(rlm->_timerSoftDeadline - mach_absolute_time()), rlm->_timerSoftDeadline, __CFTSRToTimeInterval(rlm->_timerHardDeadline - mach_absolute_time()), rlm->_timerHardDeadline);
+    CFArrayRef timers = __CFRunLoopTimerHeapCopyTimers(&rlm->_timers, UINT64_MAX, false);
+    CFStringAppendFormat(result, NULL, CFSTR("\n\tsources0 = %@,\n\tsources1 = %@,\n\tobservers = %@,\n\ttimers = %@,\n\tcurrently %0.09g (%lld) / soft deadline in: %0.09g sec (@ %lld) / hard deadline in: %0.09g sec (@ %lld)\n},\n"), rlm->_sources0, rlm->_sources1, rlm->_observers, timers, CFAbsoluteTimeGetCurrent(), mach_absolute_time(), __CFTSRToTimeInterval(rlm->_timerSoftDeadline - mach_absolute_time()), rlm->_timerSoftDeadline, __CFTSRToTimeInterval(rlm->_timerHardDeadline - mach_absolute_time()), rlm->_timerHardDeadline);
+    if (timers) CFRelease(timers);
     return result;
 }
 
@@ -917,7 +992,12 @@ static void __CFRunLoopModeDeallocate(CFTypeRef cf) {
     if (NULL != rlm->_sources0) CFRelease(rlm->_sources0);
     if (NULL != rlm->_sources1) CFRelease(rlm->_sources1);
     if (NULL != rlm->_observers) CFRelease(rlm->_observers);
-    if (NULL != rlm->_timers) CFRelease(rlm->_timers);
+    for (CFIndex idx = 0; idx < rlm->_timers._count; idx++) {
+        __CFRunLoopTimerHeapNode *node = rlm->_timers._nodes[idx];
+        CFRelease(node->_timer);
+        CFAllocatorDeallocate(kCFAllocatorSystemDefault, node);
+    }
+    if (NULL != rlm->_timers._nodes) CFAllocatorDeallocate(kCFAllocatorSystemDefault, rlm->_timers._nodes);
     if (NULL != rlm->_portToV1SourceMap) CFRelease(rlm->_portToV1SourceMap);
     CFRelease(rlm->_name);
     __CFPortSetFree(rlm->_portSet);
@@ -1171,7 +1251,7 @@ static Boolean __CFRunLoopModeIsEmpty(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFR
 #endif
     if (NULL != rlm->_sources0 && 0 < CFSetGetCount(rlm->_sources0)) return false;
     if (NULL != rlm->_sources1 && 0 < CFSetGetCount(rlm->_sources1)) return false;
-    if (NULL != rlm->_timers && 0 < CFArrayGetCount(rlm->_timers)) return false;
+    if (0 < rlm->_timers._count) return false;
     struct _block_item *item = rl->_blocks_head;
     while (item) {
         struct _block_item *curr = item;
@@ -1405,6 +1485,7 @@ struct __CFRunLoopTimer {
     CFIndex _order;			/* immutable */
     CFRunLoopTimerCallBack _callout;	/* immutable */
     CFRunLoopTimerContext _context;	/* immutable, except invalidation */
+    __CFRunLoopTimerHeapNode *_heapNodes;	/* one per mode, protected by the run loop lock */
 };
 
 /* Bit 0 of the base reserved bits is used for firing state */
@@ -1441,6 +1522,182 @@ CF_INLINE void __CFRunLoopTimerUnlock(CFRunLoopTimerRef rlt) {
     _CFRecursiveMutexUnlock(&(rlt->_lock));
 }
 
+#pragma mark Timer Heap
+
+CF_INLINE Boolean __CFRunLoopTimerHeapNodeIsLess(const __CFRunLoopTimerHeapNode *node1, const __CFRunLoopTimerHeapNode *node2) {
+    return node1->_fireTSR < node2->_fireTSR || (node1->_fireTSR == node2->_fireTSR && node1->_sequence < node2->_sequence);
+}
+
+CF_INLINE void __CFRunLoopTimerHeapPlace(__CFRunLoopTimerHeap *heap, __CFRunLoopTimerHeapNode *node, CFIndex idx) {
+    heap->_nodes[idx] = node;
+    node->_index = idx;
+}
+
+static void __CFRunLoopTimerHeapSiftUp(__CFRunLoopTimerHeap *heap, CFIndex idx) {
+    __CFRunLoopTimerHeapNode *node = heap->_nodes[idx];
+    while (0 < idx) {
+        CFIndex parent = (idx - 1) / 2;
+        if (!__CFRunLoopTimerHeapNodeIsLess(node, heap->_nodes[parent])) break;
+        __CFRunLoopTimerHeapPlace(heap, heap->_nodes[parent], idx);
+        idx = parent;
+    }
+    __CFRunLoopTimerHeapPlace(heap, node, idx);
+}
+
+static void __CFRunLoopTimerHeapSiftDown(__CFRunLoopTimerHeap *heap, CFIndex idx) {
+    __CFRunLoopTimerHeapNode *node = heap->_nodes[idx];
+    for (;;) {
+        CFIndex child = 2 * idx + 1;
+        if (heap->_count <= child) break;
+        if (child + 1 < heap->_count && __CFRunLoopTimerHeapNodeIsLess(heap->_nodes[child + 1], heap->_nodes[child])) child++;
+        if (!__CFRunLoopTimerHeapNodeIsLess(heap->_nodes[child], node)) break;
+        __CFRunLoopTimerHeapPlace(heap, heap->_nodes[child], idx);
+        idx = child;
+    }
+    __CFRunLoopTimerHeapPlace(heap, node, idx);
+}
+
+// restores the heap order around idx after the node there changed its key
+static void __CFRunLoopTimerHeapFix(__CFRunLoopTimerHeap *heap, CFIndex idx) {
+    if (0 < idx && __CFRunLoopTimerHeapNodeIsLess(heap->_nodes[idx], heap->_nodes[(idx - 1) / 2])) {
+        __CFRunLoopTimerHeapSiftUp(heap, idx);
+    } else {
+        __CFRunLoopTimerHeapSiftDown(heap, idx);
+    }
+}
+
+// call with rl and rlm locked
+static __CFRunLoopTimerHeapNode *__CFRunLoopTimerHeapFindNode(CFRunLoopModeRef rlm, CFRunLoopTimerRef rlt) {
+    for (__CFRunLoopTimerHeapNode *node = rlt->_heapNodes; NULL != node; node = node->_nextInTimer) {
+        if (node->_mode == rlm) return node;
+    }
+    return NULL;
+}
+
+// call with rl and rlm locked
+static void __CFRunLoopTimerHeapInsert(CFRunLoopModeRef rlm, CFRunLoopTimerRef rlt) {
+    __CFRunLoopTimerHeap *heap = &rlm->_timers;
+    if (heap->_count == heap->_capacity) {
+        CFIndex newCapacity = (0 == heap->_capacity) ? 16 : 2 * heap->_capacity;
+        heap->_nodes = (__CFRunLoopTimerHeapNode **)__CFSafelyReallocate(heap->_nodes, newCapacity * sizeof(__CFRunLoopTimerHeapNode *), NULL);
+        heap->_capacity = newCapacity;
+    }
+    __CFRunLoopTimerHeapNode *node = (__CFRunLoopTimerHeapNode *)CFAllocatorAllocate(kCFAllocatorSystemDefault, sizeof(__CFRunLoopTimerHeapNode), 0);
+    node->_timer = (CFRunLoopTimerRef)CFRetain(rlt);
+    node->_mode = rlm;
+    node->_nextInTimer = rlt->_heapNodes;
+    rlt->_heapNodes = node;
+    node->_fireTSR = rlt->_fireTSR;
+    node->_sequence = heap->_nextSequence++;
+    __CFRunLoopTimerHeapPlace(heap, node, heap->_count);
+    heap->_count++;
+    __CFRunLoopTimerHeapSiftUp(heap, node->_index);
+}
+
+// call with rl and rlm locked; picks up the timer's current _fireTSR
+static void __CFRunLoopTimerHeapUpdate(CFRunLoopModeRef rlm, __CFRunLoopTimerHeapNode *node) {
+    __CFRunLoopTimerHeap *heap = &rlm->_timers;
+    node->_fireTSR = node->_timer->_fireTSR;
+    node->_sequence = heap->_nextSequence++;
+    __CFRunLoopTimerHeapFix(heap, node->_index);
+}
+
+// call with rl and rlm locked; releases the node's timer
+static void __CFRunLoopTimerHeapRemove(CFRunLoopModeRef rlm, __CFRunLoopTimerHeapNode *node) {
+    __CFRunLoopTimerHeap *heap = &rlm->_timers;
+    CFIndex idx = node->_index;
+    heap->_count--;
+    if (idx < heap->_count) {
+        __CFRunLoopTimerHeapPlace(heap, heap->_nodes[heap->_count], idx);
+        __CFRunLoopTimerHeapFix(heap, idx);
+    }
+    heap->_nodes[heap->_count] = NULL;
+    CFRunLoopTimerRef rlt = node->_timer;
+    for (__CFRunLoopTimerHeapNode **link = &rlt->_heapNodes; NULL != *link; link = &(*link)->_nextInTimer) {
+        if (*link == node) {
+            *link = node->_nextInTimer;
+            break;
+        }
+    }
+    CFAllocatorDeallocate(kCFAllocatorSystemDefault, node);
+    CFRelease(rlt);
+}
+
+CF_INLINE CFRunLoopTimerRef __CFRunLoopTimerHeapGetFirst(__CFRunLoopTimerHeap *heap) {
+    return (0 < heap->_count) ? heap->_nodes[0]->_timer : NULL;
+}
+
+typedef void (*__CFRunLoopTimerHeapApplierFunction)(__CFRunLoopTimerHeapNode *node, uint64_t *limitTSR, void *context);
+
+/* Calls applier, in no particular order, on every node whose fire TSR is not after *limitTSR.
+ * Subtrees rooted after the limit are never entered, so this costs O(matching nodes); the
+ * applier may lower *limitTSR as it goes to cut the walk short. */
+static void __CFRunLoopTimerHeapApplyUpTo(__CFRunLoopTimerHeap *heap, uint64_t *limitTSR, __CFRunLoopTimerHeapApplierFunction applier, void *context) {
+    // depth first, so at most one pending sibling per level of the tree
+    CFIndex stack[2 * sizeof(CFIndex) * 8];
+    CFIndex depth = 0;
+    if (0 < heap->_count) stack[depth++] = 0;
+    while (0 < depth) {
+        CFIndex idx = stack[--depth];
+        __CFRunLoopTimerHeapNode *node = heap->_nodes[idx];
+        if (*limitTSR < node->_fireTSR) continue;
+        applier(node, limitTSR, context);
+        CFIndex child = 2 * idx + 1;
+        if (child + 1 < heap->_count) stack[depth++] = child + 1;
+        if (child < heap->_count) stack[depth++] = child;
+    }
+}
+
+typedef struct {
+    uint64_t _fireTSR;
+    uint64_t _sequence;
+    CFRunLoopTimerRef _timer;
+} __CFRunLoopTimerHeapSortEntry;
+
+typedef struct {
+    __CFRunLoopTimerHeapSortEntry *_entries;
+    CFIndex _count;
+    CFIndex _capacity;
+    Boolean _onlyFireable;
+} __CFRunLoopTimerHeapCollector;
+
+static void __CFRunLoopTimerHeapCollect(__CFRunLoopTimerHeapNode *node, uint64_t *limitTSR, void *context) {
+    __CFRunLoopTimerHeapCollector *collector = (__CFRunLoopTimerHeapCollector *)context;
+    CFRunLoopTimerRef rlt = node->_timer;
+    if (collector->_onlyFireable && (!__CFIsValid(rlt) || __CFRunLoopTimerIsFiring(rlt) || *limitTSR < rlt->_fireTSR)) return;
+    if (collector->_count == collector->_capacity) {
+        collector->_capacity = (0 == collector->_capacity) ? 16 : 2 * collector->_capacity;
+        collector->_entries = (__CFRunLoopTimerHeapSortEntry *)__CFSafelyReallocate(collector->_entries, collector->_capacity * sizeof(__CFRunLoopTimerHeapSortEntry), NULL);
+    }
+    __CFRunLoopTimerHeapSortEntry *entry = &collector->_entries[collector->_count++];
+    entry->_fireTSR = node->_fireTSR;
+    entry->_sequence = node->_sequence;
+    entry->_timer = rlt;
+}
+
+static int __CFRunLoopTimerHeapSortEntryCompare(const void *ptr1, const void *ptr2) {
+    const __CFRunLoopTimerHeapSortEntry *entry1 = (const __CFRunLoopTimerHeapSortEntry *)ptr1;
+    const __CFRunLoopTimerHeapSortEntry *entry2 = (const __CFRunLoopTimerHeapSortEntry *)ptr2;
+    if (entry1->_fireTSR != entry2->_fireTSR) return (entry1->_fireTSR < entry2->_fireTSR) ? -1 : 1;
+    if (entry1->_sequence != entry2->_sequence) return (entry1->_sequence < entry2->_sequence) ? -1 : 1;
+    return 0;
+}
+
+/* Returns the timers due by limitTSR in firing order, or NULL if there are none.  With
+ * onlyFireable, invalid timers and timers already in their callout are left out. */
+static CFArrayRef __CFRunLoopTimerHeapCopyTimers(__CFRunLoopTimerHeap *heap, uint64_t limitTSR, Boolean onlyFireable) {
+    __CFRunLoopTimerHeapCollector collector = {NULL, 0, 0, onlyFireable};
+    __CFRunLoopTimerHeapApplyUpTo(heap, &limitTSR, __CFRunLoopTimerHeapCollect, &collector);
+    if (0 == collector._count) return NULL;
+    qsort(collector._entries, collector._count, sizeof(__CFRunLoopTimerHeapSortEntry), __CFRunLoopTimerHeapSortEntryCompare);
+    CFMutableArrayRef timers = CFArrayCreateMutable(kCFAllocatorSystemDefault, collector._count, &kCFTypeArrayCallBacks);
+    for (CFIndex idx = 0; idx < collector._count; idx++) {
+        CFArrayAppendValue(timers, collector._entries[idx]._timer);
+    }
+    free(collector._entries);
+    return timers;
+}
+
 
 #pragma mark -
 
@@ -1550,17 +1807,27 @@ static void __CFRunLoopKillOneTimer(const void *value, void *context) {
     // a little heavy-handed and direct
     CFSetRemoveAllValues(rlt->_rlModes);
     rlt->_runLoop = NULL;
+    rlt->_heapNodes = NULL;
     __CFRunLoopTimerUnlock(rlt);
 }
 
 static void __CFRunLoopDeallocateTimers(const void *value, void *context) {
     CFRunLoopModeRef rlm = (CFRunLoopModeRef)value;
-    if (NULL == rlm->_timers) return;
-    
-    const CFRange range = CFRangeMake(0, CFArrayGetCount(rlm->_timers));
-    if (range.length) {
-        CFArrayApplyFunction(rlm->_timers, range, __CFRunLoopKillOneTimer, context);
-        CFArrayRemoveAllValues(rlm->_timers);
+    __CFRunLoopTimerHeap *heap = &rlm->_timers;
+    if (0 == heap->_count) return;
+
+    // every node of every timer in this run loop goes away here, so the
+    // per-timer node lists can simply be dropped
+    for (CFIndex idx = 0; idx < heap->_count; idx++) {
+        __CFRunLoopKillOneTimer(heap->_nodes[idx]->_timer, context);
+    }
+    CFIndex cnt = heap->_count;
+    heap->_count = 0;
+    for (CFIndex idx = 0; idx < cnt; idx++) {
+        __CFRunLoopTimerHeapNode *node = heap->_nodes[idx];
+        heap->_nodes[idx] = NULL;
+        CFRelease(node->_timer);
+        CFAllocatorDeallocate(kCFAllocatorSystemDefault, node);
     }
 }
 
@@ -1922,6 +2189,57 @@ CFArrayRef CFRunLoopCopyAllModes(CFRunLoopRef rl) {
     return array;
 }
 
+static void __CFRunLoopModeAddStatistics(const void *value, void *context) {
+    CFRunLoopModeRef rlm = (CFRunLoopModeRef)value;
+    __CFRunLoopModeLock(rlm);
+    __CFRunLoopStatisticsMerge((_CFRunLoopStatistics *)context, &rlm->_statistics);
+    __CFRunLoopModeUnlock(rlm);
+}
+
+static void __CFRunLoopModeResetStatistics(const void *value, void *context) {
+    CFRunLoopModeRef rlm = (CFRunLoopModeRef)value;
+    __CFRunLoopModeLock(rlm);
+    memset(&rlm->_statistics, 0, sizeof(rlm->_statistics));
+    __CFRunLoopModeUnlock(rlm);
+}
+
+Boolean _CFRunLoopGetStatistics(CFRunLoopRef rl, CFStringRef modeName, _CFRunLoopStatistics *stats) {
+    CF_ASSERT_TYPE(_kCFRuntimeIDCFRunLoop, rl);
+    CHECK_FOR_FORK();
+    Boolean found = true;
+    memset(stats, 0, sizeof(*stats));
+    __CFRunLoopLock(rl);
+    if (NULL == modeName) {
+        CFSetApplyFunction(rl->_modes, (__CFRunLoopModeAddStatistics), stats);
+    } else {
+        CFRunLoopModeRef rlm = __CFRunLoopCopyMode(rl, modeName, false);
+        if (NULL != rlm) {
+            __CFRunLoopModeAddStatistics(rlm, stats);
+            CFRelease(rlm);
+        } else {
+            found = false;
+        }
+    }
+    __CFRunLoopUnlock(rl);
+    return found;
+}
+
+void _CFRunLoopResetStatistics(CFRunLoopRef rl, CFStringRef modeName) {
+    CF_ASSERT_TYPE(_kCFRuntimeIDCFRunLoop, rl);
+    CHECK_FOR_FORK();
+    __CFRunLoopLock(rl);
+    if (NULL == modeName) {
+        CFSetApplyFunction(rl->_modes, (__CFRunLoopModeResetStatistics), NULL);
+    } else {
+        CFRunLoopModeRef rlm = __CFRunLoopCopyMode(rl, modeName, false);
+        if (NULL != rlm) {
+            __CFRunLoopModeResetStatistics(rlm, NULL);
+            CFRelease(rlm);
+        }
+    }
+    __CFRunLoopUnlock(rl);
+}
+
 static void __CFRunLoopAddItemsToCommonMode(const void *value, void *ctx) {
     CFTypeRef item = (CFTypeRef)value;
     CFRunLoopRef rl = (CFRunLoopRef)(((CFTypeRef *)ctx)[0]);
@@ -2105,6 +2423,7 @@ static void __CFRunLoopDoObservers(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRunL
     }
     __CFRunLoopModeUnlock(rlm);
     __CFRunLoopUnlock(rl);
+    _CFRunLoopCalloutStatistics calloutStats = {0};
     for (CFIndex idx = 0; idx < obs_cnt; idx++) {
         CFRunLoopObserverRef rlo = collectedObservers[idx];
         __CFRunLoopObserverLock(rlo);
@@ -2116,7 +2435,9 @@ static void __CFRunLoopDoObservers(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRunL
             void *info = rlo->_context.info;
             CFRUNLOOP_ARP_BEGIN(rl)
             cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_OBSERVER | DBG_FUNC_START, callout, rlo, activity, info);
+            uint64_t calloutStartTSR = mach_absolute_time();
             __CFRUNLOOP_IS_CALLING_OUT_TO_AN_OBSERVER_CALLBACK_FUNCTION__(callout, rlo, activity, info);
+            __CFRunLoopCalloutStatisticsAdd(&calloutStats, (const void *)callout, calloutStartTSR, mach_absolute_time());
             cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_OBSERVER | DBG_FUNC_END, callout, rlo, activity, info);
             CFRUNLOOP_ARP_END()
             if (doInvalidate) {
@@ -2130,6 +2451,7 @@ static void __CFRunLoopDoObservers(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRunL
     }
     __CFRunLoopLock(rl);
     __CFRunLoopModeLock(rlm);
+    __CFRunLoopCalloutStatisticsMerge(&rlm->_statistics.callouts[_kCFRunLoopCalloutObserver], &calloutStats);
 
     if (collectedObservers != buffer) free(collectedObservers);
     
@@ -2203,7 +2525,7 @@ static void __CFRUNLOOP_IS_CALLING_OUT_TO_A_SOURCE1_PERFORM_FUNCTION__(
     __asm __volatile__(""); // thwart tail-call optimization
 }
 
-static Boolean __CFRunLoopDoSource0(CFRunLoopRef rl, CFRunLoopSourceRef rls) {
+static Boolean __CFRunLoopDoSource0(CFRunLoopRef rl, CFRunLoopSourceRef rls, _CFRunLoopCalloutStatistics *calloutStats) {
     
     Boolean sourceHandled = false;
     __CFRunLoopSourceLock(rls);
@@ -2215,7 +2537,9 @@ static Boolean __CFRunLoopDoSource0(CFRunLoopRef rl, CFRunLoopSourceRef rls) {
             void *info = rls->_context.version0.info;
             CFRUNLOOP_ARP_BEGIN(rl)
             cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_SOURCE0 | DBG_FUNC_START, perform, info, 0, 0);
+            uint64_t calloutStartTSR = mach_absolute_time();
             __CFRUNLOOP_IS_CALLING_OUT_TO_A_SOURCE0_PERFORM_FUNCTION__(perform, info);
+            __CFRunLoopCalloutStatisticsAdd(calloutStats, (const void *)perform, calloutStartTSR, mach_absolute_time());
             cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_SOURCE0 | DBG_FUNC_END, perform, info, 0, 0);
             CFRUNLOOP_ARP_END()
             CHECK_FOR_FORK();
@@ -2246,13 +2570,14 @@ static Boolean __CFRunLoopDoSources0(CFRunLoopRef rl, CFRunLoopModeRef rlm, Bool
 	CFSetApplyFunction(rlm->_sources0, (__CFRunLoopCollectSources0), &sources);
     }
     if (NULL != sources) {
+        _CFRunLoopCalloutStatistics calloutStats = {0};
         __CFRunLoopModeUnlock(rlm);
         __CFRunLoopUnlock(rl);
         // sources is either a single (retained) CFRunLoopSourceRef or an array of (retained) CFRunLoopSourceRef
         if (CFGetTypeID(sources) == CFRunLoopSourceGetTypeID()) {
             CFRunLoopSourceRef rls = (CFRunLoopSourceRef)sources;
             
-            sourceHandled = __CFRunLoopDoSource0(rl, rls);
+            sourceHandled = __CFRunLoopDoSource0(rl, rls, &calloutStats);
             
         } else {
             CFIndex cnt = CFArrayGetCount((CFArrayRef)sources);
@@ -2260,7 +2585,7 @@ static Boolean __CFRunLoopDoSources0(CFRunLoopRef rl, CFRunLoopModeRef rlm, Bool
             for (CFIndex idx = 0; idx < cnt; idx++) {
                 CFRunLoopSourceRef rls = (CFRunLoopSourceRef)CFArrayGetValueAtIndex((CFArrayRef)sources, idx);
                 
-                sourceHandled = __CFRunLoopDoSource0(rl, rls);
+                sourceHandled = __CFRunLoopDoSource0(rl, rls, &calloutStats);
                 
                 if (stopAfterHandle && sourceHandled) {
                     break;
@@ -2270,6 +2595,7 @@ static Boolean __CFRunLoopDoSources0(CFRunLoopRef rl, CFRunLoopModeRef rlm, Bool
         CFRelease(sources);
         __CFRunLoopLock(rl);
         __CFRunLoopModeLock(rlm);
+        __CFRunLoopCalloutStatisticsMerge(&rlm->_statistics.callouts[_kCFRunLoopCalloutSource0], &calloutStats);
     }
     
     cf_trace(KDEBUG_EVENT_CFRL_IS_DOING_SOURCES0 | DBG_FUNC_END, rl, rlm, stopAfterHandle, 0);
@@ -2305,6 +2631,8 @@ static Boolean __CFRunLoopDoSource1(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRun
     
     CHECK_FOR_FORK();
     Boolean sourceHandled = false;
+    const void *callout = NULL;
+    uint64_t calloutStartTSR = 0, calloutEndTSR = 0;
 
     /* Fire a version 1 source */
     CFRetain(rls);
@@ -2319,11 +2647,14 @@ static Boolean __CFRunLoopDoSource1(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRun
         void *info = rls->_context.version1.info;
         CFRUNLOOP_ARP_BEGIN(rl)
         cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_SOURCE1 | DBG_FUNC_START, rl, rlm, perform, info);
+        callout = (const void *)perform;
+        calloutStartTSR = mach_absolute_time();
         __CFRUNLOOP_IS_CALLING_OUT_TO_A_SOURCE1_PERFORM_FUNCTION__(perform,
 #if TARGET_OS_MAC
             msg, size, reply,
 #endif
             info);
+        calloutEndTSR = mach_absolute_time();
         cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_SOURCE1 | DBG_FUNC_END, rl, rlm, perform, info);
         CFRUNLOOP_ARP_END()
         CHECK_FOR_FORK();
@@ -2335,78 +2666,55 @@ static Boolean __CFRunLoopDoSource1(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRun
     CFRelease(rls);
     __CFRunLoopLock(rl);
     __CFRunLoopModeLock(rlm);
+    if (sourceHandled) {
+        __CFRunLoopCalloutStatisticsAdd(&rlm->_statistics.callouts[_kCFRunLoopCalloutSource1], callout, calloutStartTSR, calloutEndTSR);
+    }
     
     return sourceHandled;
 }
 
-static CFIndex __CFRunLoopInsertionIndexInTimerArray(CFArrayRef array, CFRunLoopTimerRef rlt) __attribute__((noinline));
-static CFIndex __CFRunLoopInsertionIndexInTimerArray(CFArrayRef array, CFRunLoopTimerRef rlt) {
-    CFIndex cnt = CFArrayGetCount(array);
-    if (cnt <= 0) {
-        return 0;
-    }
-    if (256 < cnt) {
-        CFRunLoopTimerRef item = (CFRunLoopTimerRef)CFArrayGetValueAtIndex(array, cnt - 1);
-        if (item->_fireTSR <= rlt->_fireTSR) {
-            return cnt;
-        }
-        item = (CFRunLoopTimerRef)CFArrayGetValueAtIndex(array, 0);
-        if (rlt->_fireTSR < item->_fireTSR) {
-            return 0;
-        }
+typedef struct {
+    uint64_t _nextSoftDeadline;
+    uint64_t _nextHardDeadline;
+} __CFRunLoopTimerDeadlines;
+
+static void __CFRunLoopTimerHeapFindDeadlines(__CFRunLoopTimerHeapNode *node, uint64_t *limitTSR, void *context) {
+    __CFRunLoopTimerDeadlines *deadlines = (__CFRunLoopTimerDeadlines *)context;
+    CFRunLoopTimerRef t = node->_timer;
+    // discount timers currently firing
+    if (__CFRunLoopTimerIsFiring(t)) return;
+
+    uint64_t oneTimerHardDeadline;
+    uint64_t oneTimerSoftDeadline = node->_fireTSR;
+    if (os_add_overflow(node->_fireTSR, __CFTimeIntervalToTSR(t->_tolerance), &oneTimerHardDeadline)) {
+        oneTimerHardDeadline = UINT64_MAX;
     }
 
-    CFIndex add = (1 << flsl(cnt)) * 2;
-    CFIndex idx = 0;
-    Boolean lastTestLEQ;
-    do {
-        add = add / 2;
-	lastTestLEQ = false;
-        CFIndex testIdx = idx + add;
-        if (testIdx < cnt) {
-            CFRunLoopTimerRef item = (CFRunLoopTimerRef)CFArrayGetValueAtIndex(array, testIdx);
-            if (item->_fireTSR <= rlt->_fireTSR) {
-                idx = testIdx;
-		lastTestLEQ = true;
-            }
-        }
-    } while (0 < add);
+    if (oneTimerSoftDeadline < deadlines->_nextSoftDeadline) {
+        deadlines->_nextSoftDeadline = oneTimerSoftDeadline;
+    }
 
-    return lastTestLEQ ? idx + 1 : idx;
+    if (oneTimerHardDeadline < deadlines->_nextHardDeadline) {
+        deadlines->_nextHardDeadline = oneTimerHardDeadline;
+        // Timers whose soft deadline is after the current hard deadline cannot move either deadline, so stop looking at them.
+        *limitTSR = oneTimerHardDeadline;
+    }
 }
 
 static void __CFArmNextTimerInMode(CFRunLoopModeRef rlm, CFRunLoopRef rl) {    
     uint64_t nextHardDeadline = UINT64_MAX;
     uint64_t nextSoftDeadline = UINT64_MAX;
 
-    if (rlm->_timers) {
-        // Look at the list of timers. We will calculate two TSR values; the next soft and next hard deadline.
-        // The next soft deadline is the first time we can fire any timer. This is the fire date of the first timer in our sorted list of timers.
-        // The next hard deadline is the last time at which we can fire the timer before we've moved out of the allowable tolerance of the timers in our list.
-        for (CFIndex idx = 0, cnt = CFArrayGetCount(rlm->_timers); idx < cnt; idx++) {
-            CFRunLoopTimerRef t = (CFRunLoopTimerRef)CFArrayGetValueAtIndex(rlm->_timers , idx);
-            // discount timers currently firing
-            if (__CFRunLoopTimerIsFiring(t)) continue;
-            
-            uint64_t oneTimerHardDeadline;
-            uint64_t oneTimerSoftDeadline = t->_fireTSR;
-            if (os_add_overflow(t->_fireTSR, __CFTimeIntervalToTSR(t->_tolerance), &oneTimerHardDeadline)) {
-                oneTimerHardDeadline = UINT64_MAX;
-            }
-            
-            // We can stop searching if the soft deadline for this timer exceeds the current hard deadline. Otherwise, later timers with lower tolerance could still have earlier hard deadlines.
-            if (oneTimerSoftDeadline > nextHardDeadline) {
-                break;
-            }
-            
-            if (oneTimerSoftDeadline < nextSoftDeadline) {
-                nextSoftDeadline = oneTimerSoftDeadline;
-            }
-            
-            if (oneTimerHardDeadline < nextHardDeadline) {
-                nextHardDeadline = oneTimerHardDeadline;
-            }
-        }
+    {
+        // Look at the heap of timers. We will calculate two TSR values; the next soft and next hard deadline.
+        // The next soft deadline is the first time we can fire any timer. This is the earliest fire date of the timers that are not firing.
+        // The next hard deadline is the last time at which we can fire the timer before we've moved out of the allowable tolerance of the timers in our heap.
+        // Only timers whose soft deadline is not after the running hard deadline are visited; later timers with lower tolerance could still have earlier hard deadlines, but nothing past that bound can.
+        __CFRunLoopTimerDeadlines deadlines = {UINT64_MAX, UINT64_MAX};
+        uint64_t limitTSR = UINT64_MAX;
+        __CFRunLoopTimerHeapApplyUpTo(&rlm->_timers, &limitTSR, __CFRunLoopTimerHeapFindDeadlines, &deadlines);
+        nextSoftDeadline = deadlines._nextSoftDeadline;
+        nextHardDeadline = deadlines._nextHardDeadline;
         
         if (nextSoftDeadline < UINT64_MAX && (nextHardDeadline != rlm->_timerHardDeadline || nextSoftDeadline != rlm->_timerSoftDeadline)) {
             if (CFRUNLOOP_NEXT_TIMER_ARMED_ENABLED()) {
@@ -2477,24 +2785,15 @@ static void __CFRepositionTimerInMode(CFRunLoopModeRef rlm, CFRunLoopTimerRef rl
 static void __CFRepositionTimerInMode(CFRunLoopModeRef rlm, CFRunLoopTimerRef rlt, Boolean isInArray) {
     if (!rlt) return;
     
-    CFMutableArrayRef timerArray = rlm->_timers;
-    if (!timerArray) return;
-    Boolean found = false;
-    
-    // If we know in advance that the timer is not in the array (just being added now) then we can skip this search
-    if (isInArray) {
-        CFIndex idx = CFArrayGetFirstIndexOfValue(timerArray, CFRangeMake(0, CFArrayGetCount(timerArray)), rlt);
-        if (kCFNotFound != idx) {
-            CFRetain(rlt);
-            CFArrayRemoveValueAtIndex(timerArray, idx);
-            found = true;
-        }
+    // If we know in advance that the timer is not in the heap (just being added now) then we can skip this search
+    __CFRunLoopTimerHeapNode *node = isInArray ? __CFRunLoopTimerHeapFindNode(rlm, rlt) : NULL;
+    if (!node && isInArray) return;
+    if (node) {
+        __CFRunLoopTimerHeapUpdate(rlm, node);
+    } else {
+        __CFRunLoopTimerHeapInsert(rlm, rlt);
     }
-    if (!found && isInArray) return;
-    CFIndex newIdx = __CFRunLoopInsertionIndexInTimerArray(timerArray, rlt);
-    CFArrayInsertValueAtIndex(timerArray, newIdx, rlt);
     __CFArmNextTimerInMode(rlm, rlt->_runLoop);
-    if (isInArray) CFRelease(rlt);
 }
 
 
@@ -2537,7 +2836,9 @@ static Boolean __CFRunLoopDoTimer(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRunLo
         CFRunLoopTimerCallBack callout = rlt->_callout;
         CFRUNLOOP_ARP_BEGIN(NULL)
         cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_TIMER | DBG_FUNC_START, callout, rlt, context_info, 0);
+        uint64_t calloutStartTSR = mach_absolute_time();
 	__CFRUNLOOP_IS_CALLING_OUT_TO_A_TIMER_CALLBACK_FUNCTION__(callout, rlt, context_info);
+        uint64_t calloutEndTSR = mach_absolute_time();
         cf_trace(KDEBUG_EVENT_CFRL_IS_CALLING_TIMER | DBG_FUNC_END, callout, rlt, context_info, 0);
         CFRUNLOOP_ARP_END()
 
@@ -2551,6 +2852,10 @@ static Boolean __CFRunLoopDoTimer(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFRunLo
         
 	__CFRunLoopLock(rl);
 	__CFRunLoopModeLock(rlm);
+        __CFRunLoopCalloutStatisticsAdd(&rlm->_statistics.callouts[_kCFRunLoopCalloutTimer], (const void *)callout, calloutStartTSR, calloutEndTSR);
+        uint64_t latenessNanoseconds = (calloutStartTSR > oldFireTSR) ? __CFTSRToNanoseconds(calloutStartTSR - oldFireTSR) : 0;
+        rlm->_statistics.totalTimerLatenessNanoseconds += latenessNanoseconds;
+        if (rlm->_statistics.maxTimerLatenessNanoseconds < latenessNanoseconds) rlm->_statistics.maxTimerLatenessNanoseconds = latenessNanoseconds;
         __CFRunLoopTimerLock(rlt);
 	timerHandled = true;
 	__CFRunLoopTimerUnsetFiring(rlt);
@@ -2657,17 +2962,7 @@ static Boolean __CFRunLoopDoTimers(CFRunLoopRef rl, CFRunLoopModeRef rlm, uint64
     cf_trace(KDEBUG_EVENT_CFRL_IS_DOING_TIMERS | DBG_FUNC_START, rl, rlm, limitTSR, 0);
     
     Boolean timerHandled = false;
-    CFMutableArrayRef timers = NULL;
-    for (CFIndex idx = 0, cnt = rlm->_timers ? CFArrayGetCount(rlm->_timers) : 0; idx < cnt; idx++) {
-        CFRunLoopTimerRef rlt = (CFRunLoopTimerRef)CFArrayGetValueAtIndex(rlm->_timers, idx);
-        
-        if (__CFIsValid(rlt) && !__CFRunLoopTimerIsFiring(rlt)) {
-            if (rlt->_fireTSR <= limitTSR) {
-                if (!timers) timers = CFArrayCreateMutable(kCFAllocatorSystemDefault, 0, &kCFTypeArrayCallBacks);
-                CFArrayAppendValue(timers, rlt);
-            }
-        }
-    }
+    CFArrayRef timers = __CFRunLoopTimerHeapCopyTimers(&rlm->_timers, limitTSR, true);
 
     for (CFIndex idx = 0, cnt = timers ? CFArrayGetCount(timers) : 0; idx < cnt; idx++) {
         CFRunLoopTimerRef rlt = (CFRunLoopTimerRef)CFArrayGetValueAtIndex(timers, idx);
@@ -3115,7 +3410,12 @@ static int32_t __CFRunLoopRun(CFRunLoopRef rl, CFRunLoopModeRef rlm, CFTimeInter
         __CFRunLoopLock(rl);
         __CFRunLoopModeLock(rlm);
 
-        rl->_sleepTime += (poll ? 0.0 : (CFAbsoluteTimeGetCurrent() - sleepStart));
+        if (!poll) {
+            CFAbsoluteTime slept = CFAbsoluteTimeGetCurrent() - sleepStart;
+            rl->_sleepTime += slept;
+            rlm->_statistics.wakeUps++;
+            if (slept > 0.0) rlm->_statistics.nanosecondsAsleep += (uint64_t)(slept * 1000000000.0);
+        }
 
         // Must remove the local-to-this-activation ports in on every loop
         // iteration, as this mode could be run re-entrantly and we don't
@@ -3361,7 +3661,7 @@ CFAbsoluteTime CFRunLoopGetNextTimerFireDate(CFRunLoopRef rl, CFStringRef modeNa
         __CFRunLoopModeLock(rlm);
     }
     CFAbsoluteTime at = 0.0;
-    CFRunLoopTimerRef nextTimer = (rlm && rlm->_timers && 0 < CFArrayGetCount(rlm->_timers)) ? (CFRunLoopTimerRef)CFArrayGetValueAtIndex(rlm->_timers, 0) : NULL;
+    CFRunLoopTimerRef nextTimer = rlm ? __CFRunLoopTimerHeapGetFirst(&rlm->_timers) : NULL;
     if (nextTimer) {
         at = CFRunLoopTimerGetNextFireDate(nextTimer);
     }
@@ -3919,10 +4219,7 @@ Boolean CFRunLoopContainsTimer(CFRunLoopRef rl, CFRunLoopTimerRef rlt, CFStringR
 	CFRunLoopModeRef rlm = __CFRunLoopCopyMode(rl, modeName, false);
 	if (NULL != rlm) {
             __CFRunLoopModeLock(rlm);
-            if (NULL != rlm->_timers) {
-                CFIndex idx = CFArrayGetFirstIndexOfValue(rlm->_timers, CFRangeMake(0, CFArrayGetCount(rlm->_timers)), rlt);
-                hasValue = (kCFNotFound != idx);
-            }
+            hasValue = (NULL != __CFRunLoopTimerHeapFindNode(rlm, rlt));
 	    __CFRunLoopModeUnlock(rlm);
             CFRelease(rlm);
 	}
@@ -3963,11 +4260,6 @@ void CFRunLoopAddTimer(CFRunLoopRef rl, CFRunLoopTimerRef rlt, CFStringRef modeN
 	CFRunLoopModeRef rlm = __CFRunLoopCopyMode(rl, modeName, true);
 	if (NULL != rlm) {
             __CFRunLoopModeLock(rlm);
-            if (NULL == rlm->_timers) {
-                CFArrayCallBacks cb = kCFTypeArrayCallBacks;
-                cb.equal = NULL;
-                rlm->_timers = CFArrayCreateMutable(kCFAllocatorSystemDefault, 0, &cb);
-            }
 	}
 	if (NULL != rlm && !CFSetContainsValue(rlt->_rlModes, rlm->_name)) {
             __CFRunLoopTimerLock(rlt);
@@ -4017,23 +4309,19 @@ void CFRunLoopRemoveTimer(CFRunLoopRef rl, CFRunLoopTimerRef rlt, CFStringRef mo
 	}
     } else {
 	CFRunLoopModeRef rlm = __CFRunLoopCopyMode(rl, modeName, false);
-        CFIndex idx = kCFNotFound;
-        CFMutableArrayRef timerList = NULL;
+        __CFRunLoopTimerHeapNode *node = NULL;
         if (NULL != rlm) {
             __CFRunLoopModeLock(rlm);
-            timerList = rlm->_timers;
-            if (NULL != timerList) {
-                idx = CFArrayGetFirstIndexOfValue(timerList, CFRangeMake(0, CFArrayGetCount(timerList)), rlt);
-            }
+            node = __CFRunLoopTimerHeapFindNode(rlm, rlt);
         }
-        if (kCFNotFound != idx) {
+        if (NULL != node) {
             __CFRunLoopTimerLock(rlt);
             CFSetRemoveValue(rlt->_rlModes, rlm->_name);
             if (0 == CFSetGetCount(rlt->_rlModes)) {
                 rlt->_runLoop = NULL;
             }
             __CFRunLoopTimerUnlock(rlt);
-	    CFArrayRemoveValueAtIndex(timerList, idx);
+            __CFRunLoopTimerHeapRemove(rlm, node);
             __CFArmNextTimerInMode(rlm, rl);
         }
         if (NULL != rlm) {
@@ -41,6 +41,9 @@
 #include <unistd.h>
 #endif
 #include <fcntl.h>
+#if TARGET_OS_LINUX && !TARGET_OS_CYGWIN
+#include <sys/epoll.h>
+#endif
 #include "CFArray.h"
 #include "CFData.h"
 #include "CFDictionary.h"
@@ -101,6 +104,14 @@ static void timeradd(struct timeval *a, struct timeval *b, struct timeval *res)
 
 // On Mach we use a v0 RunLoopSource to make client callbacks.  That source is signalled by a
 // separate SocketManager thread who uses select() to watch the sockets' fds.
+// On Linux the SocketManager thread waits on an epoll instance instead, so a wakeup costs
+// O(ready sockets) rather than O(highest fd) and there is no FD_SETSIZE ceiling.
+
+#if TARGET_OS_LINUX && !TARGET_OS_CYGWIN
+#define USE_EPOLL_FOR_SOCKET_MANAGER 1
+#else
+#define USE_EPOLL_FOR_SOCKET_MANAGER 0
+#endif
 
 #undef LOG_CFSOCKET
 //#define LOG_CFSOCKET            1
@@ -225,12 +236,26 @@ CF_INLINE CFIndex __CFSocketFdGetSize(CFDataRef fdSet) {
 #endif
 }
 
+#if !TARGET_OS_WIN32
+// The fd sets below grow with the highest descriptor, so test and flip their bits directly rather
+// than through FD_SET and friends, which may be checked against FD_SETSIZE.
+#define __CFSOCKET_FD_MASK(sock) ((fd_mask)(1UL << ((sock) % NFDBITS)))
+#define __CFSOCKET_FD_ISSET(sock, bits) (0 != ((bits)[(sock) / NFDBITS] & __CFSOCKET_FD_MASK(sock)))
+#define __CFSOCKET_FD_SET(sock, bits) ((bits)[(sock) / NFDBITS] |= __CFSOCKET_FD_MASK(sock))
+#define __CFSOCKET_FD_CLR(sock, bits) ((bits)[(sock) / NFDBITS] &= ~__CFSOCKET_FD_MASK(sock))
+
+CF_INLINE Boolean __CFSocketFdIsSet(CFSocketNativeHandle sock, CFDataRef fdSet) {
+    if (INVALID_SOCKET == sock || 0 > sock || sock >= NBBY * CFDataGetLength(fdSet)) return false;
+    return __CFSOCKET_FD_ISSET(sock, (const fd_mask *)CFDataGetBytePtr(fdSet));
+}
+#endif
+
 CF_INLINE Boolean __CFSocketFdSet(CFSocketNativeHandle sock, CFMutableDataRef fdSet) {
     /* returns true if a change occurred, false otherwise */
     Boolean retval = false;
     if (INVALID_SOCKET != sock && 0 <= sock) {
-        fd_set *fds;
 #if TARGET_OS_WIN32
+        fd_set *fds;
         if (CFDataGetLength(fdSet) == 0) {
             CFDataIncreaseLength(fdSet, sizeof(fd_set));
             fds = (fd_set *)CFDataGetMutableBytePtr(fdSet);
@@ -238,6 +263,10 @@ CF_INLINE Boolean __CFSocketFdSet(CFSocketNativeHandle sock, CFMutableDataRef fd
         } else {
             fds = (fd_set *)CFDataGetMutableBytePtr(fdSet);
         }
+        if (!FD_ISSET(sock, fds)) {
+            retval = true;
+            FD_SET(sock, fds);
+        }
 #else
         CFIndex numFds = NBBY * CFDataGetLength(fdSet);
         fd_mask *fds_bits;
@@ -249,12 +278,11 @@ CF_INLINE Boolean __CFSocketFdSet(CFSocketNativeHandle sock, CFMutableDataRef fd
         } else {
             fds_bits = (fd_mask *)CFDataGetMutableBytePtr(fdSet);
         }
-        fds = (fd_set *)fds_bits;
-#endif
-        if (!FD_ISSET(sock, fds)) {
+        if (!__CFSOCKET_FD_ISSET(sock, fds_bits)) {
             retval = true;
-            FD_SET(sock, fds);
+            __CFSOCKET_FD_SET(sock, fds_bits);
         }
+#endif
     }
     return retval;
 }
@@ -282,6 +310,11 @@ static Boolean __CFReadSocketsTimeoutInvalid = true;  /* rebuild the timeout val
 
 static CFSocketNativeHandle __CFWakeupSocketPair[2] = {INVALID_SOCKET, INVALID_SOCKET};
 static void *__CFSocketManagerThread = NULL;
+#if USE_EPOLL_FOR_SOCKET_MANAGER
+static int __CFSocketEpollFd = -1;  /* INVALID when epoll could not be set up; the manager then falls back to select */
+static CFMutableDictionaryRef __CFActiveSocketsByNative = NULL;  /* native handle -> socket in __CFRead/WriteSockets, controlled by __CFActiveSocketsLock */
+static Boolean __CFReadSocketsHaveTimeout = false;  /* did the last timeout calculation find a socket wanting one */
+#endif
 
 static void __CFSocketDoCallback(CFSocketRef s, CFDataRef data, CFDataRef address, CFSocketNativeHandle sock);
 
@@ -326,6 +359,9 @@ struct __CFSocket {
     // We need to notify any waiting buffered read clients if there is data available without relying on select timing out.
     struct timeval _readBufferTimeoutNotificationTime;
     Boolean _hitTheTimeout;
+#if USE_EPOLL_FOR_SOCKET_MANAGER
+    UInt32 _readReadyIteration;  /* __CFSocketManagerIteration in which epoll last reported this socket readable */
+#endif
 };
 
 /* Bit 6 in the base reserved bits is used for write-signalled state (mutable) */
@@ -450,9 +486,9 @@ CF_INLINE Boolean __CFSocketFdClr(CFSocketNativeHandle sock, CFMutableDataRef fd
         fd_mask *fds_bits;
         if (sock < numFds) {
             fds_bits = (fd_mask *)CFDataGetMutableBytePtr(fdSet);
-            if (FD_ISSET(sock, (fd_set *)fds_bits)) {
+            if (__CFSOCKET_FD_ISSET(sock, fds_bits)) {
                 retval = true;
-                FD_CLR(sock, (fd_set *)fds_bits);
+                __CFSOCKET_FD_CLR(sock, fds_bits);
             }
         }
 #endif
@@ -503,12 +539,69 @@ static SInt32 __CFSocketCreateWakeupSocketPair(void) {
 }
 
 
+#if USE_EPOLL_FOR_SOCKET_MANAGER
+CF_INLINE Boolean __CFSocketUsesEpoll(void) {
+    return 0 <= __CFSocketEpollFd;
+}
+
+/* Mirrors the read and write bits of sock into its epoll registration.  Registrations are
+ * edge-triggered and one-shot, so the manager gets a single event per arming and the kernel
+ * rechecks readiness each time a bit is set again.  Must be called with __CFActiveSocketsLock held.
+ */
+static void __CFSocketEpollSync(CFSocketNativeHandle sock) {
+    if (!__CFSocketUsesEpoll() || INVALID_SOCKET == sock || 0 > sock || sock == __CFWakeupSocketPair[1]) return;
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    if (__CFSocketFdIsSet(sock, __CFReadSocketsFds)) event.events |= EPOLLIN;
+    if (__CFSocketFdIsSet(sock, __CFWriteSocketsFds)) event.events |= EPOLLOUT;
+    event.data.fd = sock;
+    if (0 == event.events) {
+        // ENOENT and EBADF just mean there is nothing left to remove
+        epoll_ctl(__CFSocketEpollFd, EPOLL_CTL_DEL, sock, &event);
+        return;
+    }
+    event.events |= EPOLLET | EPOLLONESHOT;
+    if (0 != epoll_ctl(__CFSocketEpollFd, EPOLL_CTL_MOD, sock, &event) && ENOENT == errno) {
+        if (0 != epoll_ctl(__CFSocketEpollFd, EPOLL_CTL_ADD, sock, &event)) {
+            __CFSOCKETLOG("could not add socket %d to epoll set, errno %d", sock, errno);
+        }
+    }
+}
+
+/* Only sockets with a read buffer timeout or leftover bytes take part in the timeout
+ * calculation, so only they need to make the manager thread recompute it. */
+CF_INLINE Boolean __CFSocketAffectsReadTimeout(CFSocketRef s) {
+    return !__CFSocketUsesEpoll() || __CFReadSocketsHaveTimeout || timerisset(&s->_readBufferTimeout) || NULL != s->_leftoverBytes;
+}
+
+CF_INLINE void __CFSocketSetActive(CFSocketRef s) {
+    if (INVALID_SOCKET != s->_socket) CFDictionarySetValue(__CFActiveSocketsByNative, (void *)(uintptr_t)s->_socket, s);
+}
+
+CF_INLINE void __CFSocketUnsetActive(CFSocketRef s) {
+    if (INVALID_SOCKET != s->_socket && CFDictionaryGetValue(__CFActiveSocketsByNative, (void *)(uintptr_t)s->_socket) == s) {
+        CFDictionaryRemoveValue(__CFActiveSocketsByNative, (void *)(uintptr_t)s->_socket);
+    }
+}
+#else
+CF_INLINE Boolean __CFSocketUsesEpoll(void) { return false; }
+CF_INLINE void __CFSocketEpollSync(CFSocketNativeHandle sock) {}
+CF_INLINE Boolean __CFSocketAffectsReadTimeout(CFSocketRef s) { return true; }
+CF_INLINE void __CFSocketSetActive(CFSocketRef s) {}
+CF_INLINE void __CFSocketUnsetActive(CFSocketRef s) {}
+#endif
+
 // Version 0 RunLoopSources set a mask in an FD set to control what socket activity we hear about.
 // Changes to the master fs_sets occur via these 4 functions.
+// With epoll, the epoll set follows the masks directly and the wakeup socket is only needed
+// when the read timeouts must be recalculated.
 CF_INLINE Boolean __CFSocketSetFDForRead(CFSocketRef s) {
     __CFSOCKETLOG_WS(s, "");
-    __CFReadSocketsTimeoutInvalid = true;
     Boolean b = __CFSocketFdSet(s->_socket, __CFReadSocketsFds);
+    // always resync: the descriptor may have been closed and reused behind our back
+    __CFSocketEpollSync(s->_socket);
+    if (!__CFSocketAffectsReadTimeout(s)) return b;
+    __CFReadSocketsTimeoutInvalid = true;
     if (b && INVALID_SOCKET != __CFWakeupSocketPair[0]) {
         uint8_t c = 'r';
         send(__CFWakeupSocketPair[0], (const char *)&c, sizeof(c), 0);
@@ -518,8 +611,10 @@ CF_INLINE Boolean __CFSocketSetFDForRead(CFSocketRef s) {
 
 CF_INLINE Boolean __CFSocketClearFDForRead(CFSocketRef s) {
     __CFSOCKETLOG_WS(s, "");
-    __CFReadSocketsTimeoutInvalid = true;
     Boolean b = __CFSocketFdClr(s->_socket, __CFReadSocketsFds);
+    if (b) __CFSocketEpollSync(s->_socket);
+    if (!__CFSocketAffectsReadTimeout(s)) return b;
+    __CFReadSocketsTimeoutInvalid = true;
     if (b && INVALID_SOCKET != __CFWakeupSocketPair[0]) {
         uint8_t c = 's';
         send(__CFWakeupSocketPair[0], (const char *)&c, sizeof(c), 0);
@@ -530,6 +625,10 @@ CF_INLINE Boolean __CFSocketClearFDForRead(CFSocketRef s) {
 CF_INLINE Boolean __CFSocketSetFDForWrite(CFSocketRef s) {
     __CFSOCKETLOG_WS(s, "");
     Boolean b = __CFSocketFdSet(s->_socket, __CFWriteSocketsFds);
+    if (__CFSocketUsesEpoll()) {
+        __CFSocketEpollSync(s->_socket);
+        return b;
+    }
     if (b && INVALID_SOCKET != __CFWakeupSocketPair[0]) {
         uint8_t c = 'w';
         send(__CFWakeupSocketPair[0], (const char *)&c, sizeof(c), 0);
@@ -540,6 +639,10 @@ CF_INLINE Boolean __CFSocketSetFDForWrite(CFSocketRef s) {
 CF_INLINE Boolean __CFSocketClearFDForWrite(CFSocketRef s) {
     __CFSOCKETLOG_WS(s, "");
     Boolean b = __CFSocketFdClr(s->_socket, __CFWriteSocketsFds);
+    if (__CFSocketUsesEpoll()) {
+        if (b) __CFSocketEpollSync(s->_socket);
+        return b;
+    }
     if (b && INVALID_SOCKET != __CFWakeupSocketPair[0]) {
         uint8_t c = 'x';
         send(__CFWakeupSocketPair[0], (const char *)&c, sizeof(c), 0);
@@ -605,6 +708,24 @@ static void __CFSocketInitializeSockets(void) {
         ioctlsocket(__CFWakeupSocketPair[1], FIONBIO, (u_long *)&yes);
         __CFSocketFdSet(__CFWakeupSocketPair[1], __CFReadSocketsFds);
     }
+#if USE_EPOLL_FOR_SOCKET_MANAGER
+    __CFActiveSocketsByNative = CFDictionaryCreateMutable(kCFAllocatorSystemDefault, 0, NULL, NULL);
+    __CFSocketEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (0 <= __CFSocketEpollFd && INVALID_SOCKET != __CFWakeupSocketPair[1]) {
+        // the wakeup socket stays level-triggered and permanently armed
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = __CFWakeupSocketPair[1];
+        if (0 != epoll_ctl(__CFSocketEpollFd, EPOLL_CTL_ADD, __CFWakeupSocketPair[1], &event)) {
+            close(__CFSocketEpollFd);
+            __CFSocketEpollFd = -1;
+        }
+    }
+    if (0 > __CFSocketEpollFd) {
+        CFLog(kCFLogLevelWarning, CFSTR("*** Could not create epoll instance for CFSocket, falling back to select()"));
+    }
+#endif
 }
 
 static CFRunLoopRef __CFSocketCopyRunLoopToWakeUp(CFRunLoopSourceRef src, CFMutableArrayRef runLoops) {
@@ -1304,12 +1425,160 @@ manageSelectError(SInt32 selectError)
     }
 }
 
+#if USE_EPOLL_FOR_SOCKET_MANAGER
+#define __CFSOCKET_EPOLL_MAX_EVENTS 256
+
+static int __CFSocketEpollTimeoutFromTimeval(const struct timeval *tv) {
+    if (NULL == tv) return -1;
+    if (tv->tv_sec >= INT_MAX / 1000 - 1) return INT_MAX;
+    /* round up so that we never wake before the earliest read buffer timeout */
+    return (int)(tv->tv_sec * 1000 + (tv->tv_usec + 999) / 1000);
+}
+
+/* The epoll flavor of the manager loop below.  Only the sockets epoll reports are looked at, via
+ * __CFActiveSocketsByNative; the full read socket list is walked only when some socket has asked
+ * for a read buffer timeout, exactly as the select loop does.
+ */
+static void *__CFSocketManagerEpoll(void *arg)
+{
+    struct epoll_event events[__CFSOCKET_EPOLL_MAX_EVENTS];
+    SInt32 nevents, idx, cnt;
+    uint8_t buffer[256];
+    CFMutableArrayRef selectedWriteSockets = CFArrayCreateMutable(kCFAllocatorSystemDefault, 0, &kCFTypeArrayCallBacks);
+    CFMutableArrayRef selectedReadSockets = CFArrayCreateMutable(kCFAllocatorSystemDefault, 0, &kCFTypeArrayCallBacks);
+    CFIndex selectedWriteSocketsIndex = 0, selectedReadSocketsIndex = 0;
+
+    struct timeval tv;
+    struct timeval* pTimeout = NULL;
+
+    for (;;) {
+        __CFLock(&__CFActiveSocketsLock);
+        __CFSocketManagerIteration++;
+
+        if (__CFReadSocketsTimeoutInvalid) {
+            struct timeval* minTimeout = NULL;
+            __CFReadSocketsTimeoutInvalid = false;
+
+            CFArrayApplyFunction(__CFReadSockets, CFRangeMake(0, CFArrayGetCount(__CFReadSockets)), _calcMinTimeout_locked, (void*) &minTimeout);
+
+            if (minTimeout == NULL) {
+                __CFSOCKETLOG("No one wants a timeout!");
+                pTimeout = NULL;
+            } else {
+                __CFSOCKETLOG("timeout will be %ld, %d!", minTimeout->tv_sec, minTimeout->tv_usec);
+                tv = *minTimeout;
+                pTimeout = &tv;
+            }
+            __CFReadSocketsHaveTimeout = (NULL != pTimeout);
+        }
+        __CFUnlock(&__CFActiveSocketsLock);
+
+        nevents = epoll_wait(__CFSocketEpollFd, events, __CFSOCKET_EPOLL_MAX_EVENTS, __CFSocketEpollTimeoutFromTimeval(pTimeout));
+        if (0 > nevents) {
+            if (EINTR != errno) __CFSOCKETLOG("socket manager received error %d from epoll_wait", errno);
+            continue;
+        }
+
+        __CFSOCKETLOG("socket manager woke from epoll_wait, ret=%ld", (long)nevents);
+
+        __CFLock(&__CFActiveSocketsLock);
+        if (0 == nevents) {
+            /* epoll_wait timed out; kick off expired reads */
+            cnt = CFArrayGetCount(__CFReadSockets);
+            for (idx = 0; idx < cnt; idx++) {
+                CFSocketRef s = (CFSocketRef)CFArrayGetValueAtIndex(__CFReadSockets, idx);
+                CFSocketNativeHandle sock = s->_socket;
+                if ((timerisset(&s->_readBufferTimeout) || s->_leftoverBytes) && INVALID_SOCKET != sock) {
+                    __CFSOCKETLOG_WS(s, "Expiring socket (delta %ld, %d)", s->_readBufferTimeout.tv_sec, s->_readBufferTimeout.tv_usec);
+                    CFArraySetValueAtIndex(selectedReadSockets, selectedReadSocketsIndex, s);
+                    selectedReadSocketsIndex++;
+                    /* socket is removed from fds here, will be restored in read handling or in perform function */
+                    if (__CFSocketFdClr(sock, __CFReadSocketsFds)) __CFSocketEpollSync(sock);
+                }
+            }
+        }
+        for (idx = 0; idx < nevents; idx++) {
+            CFSocketNativeHandle sock = events[idx].data.fd;
+            uint32_t revents = events[idx].events;
+            if (sock == __CFWakeupSocketPair[1]) {
+                while (0 < recv(__CFWakeupSocketPair[1], (char *)buffer, sizeof(buffer), 0)) {
+                    __CFSOCKETLOG("socket manager received %c on wakeup socket\n", buffer[0]);
+                }
+                continue;
+            }
+            CFSocketRef s = (CFSocketRef)CFDictionaryGetValue(__CFActiveSocketsByNative, (void *)(uintptr_t)sock);
+            if (NULL == s) {
+                /* stale event for a socket that has since been unscheduled */
+                continue;
+            }
+            /* errors and hangups are reported as both readable and writable, as select does */
+            Boolean failed = (0 != (revents & (EPOLLERR | EPOLLHUP)));
+            /* sockets are removed from fds here, restored by CFSocketReschedule or in read handling */
+            if ((failed || 0 != (revents & EPOLLOUT)) && __CFSocketFdClr(sock, __CFWriteSocketsFds)) {
+                CFArraySetValueAtIndex(selectedWriteSockets, selectedWriteSocketsIndex, s);
+                selectedWriteSocketsIndex++;
+                __CFSOCKETLOG_WS(s, "Manager: cleared socket from write fds");
+            }
+            if ((failed || 0 != (revents & EPOLLIN)) && __CFSocketFdClr(sock, __CFReadSocketsFds)) {
+                s->_hitTheTimeout = false;
+                s->_readReadyIteration = __CFSocketManagerIteration;
+                CFArraySetValueAtIndex(selectedReadSockets, selectedReadSocketsIndex, s);
+                selectedReadSocketsIndex++;
+            }
+            /* one-shot disarmed the whole registration; re-arm whatever did not fire */
+            __CFSocketEpollSync(sock);
+        }
+        if (pTimeout && 0 < nevents) {
+            /* Sockets that are busy never see epoll_wait time out, so check for waiting buffered readers by hand */
+            struct timeval timeNow = { 0 };
+            gettimeofday(&timeNow, NULL);
+            cnt = CFArrayGetCount(__CFReadSockets);
+            for (idx = 0; idx < cnt; idx++) {
+                CFSocketRef s = (CFSocketRef)CFArrayGetValueAtIndex(__CFReadSockets, idx);
+                CFSocketNativeHandle sock = s->_socket;
+                if (INVALID_SOCKET == sock || s->_readReadyIteration == __CFSocketManagerIteration) continue;
+                s->_hitTheTimeout = false;
+                if (timerisset(&s->_readBufferTimeoutNotificationTime) && timercmp(&timeNow, &s->_readBufferTimeoutNotificationTime, >)) {
+                    s->_hitTheTimeout = true;
+                    CFArraySetValueAtIndex(selectedReadSockets, selectedReadSocketsIndex, s);
+                    selectedReadSocketsIndex++;
+                    if (__CFSocketFdClr(sock, __CFReadSocketsFds)) __CFSocketEpollSync(sock);
+                }
+            }
+        }
+        __CFUnlock(&__CFActiveSocketsLock);
+
+        for (idx = 0; idx < selectedWriteSocketsIndex; idx++) {
+            CFSocketRef s = (CFSocketRef)CFArrayGetValueAtIndex(selectedWriteSockets, idx);
+            if (kCFNull == (CFNullRef)s) continue;
+            __CFSOCKETLOG_WS(s, "socket manager signaling for write", s, s->_socket);
+            __CFSocketHandleWrite(s, FALSE);
+            CFArraySetValueAtIndex(selectedWriteSockets, idx, kCFNull);
+        }
+        selectedWriteSocketsIndex = 0;
+
+        for (idx = 0; idx < selectedReadSocketsIndex; idx++) {
+            CFSocketRef s = (CFSocketRef)CFArrayGetValueAtIndex(selectedReadSockets, idx);
+            if (kCFNull == (CFNullRef)s) continue;
+            __CFSOCKETLOG_WS(s, "socket manager signaling for read", s, s->_socket);
+            __CFSocketHandleRead(s, nevents == 0 || s->_hitTheTimeout);
+            CFArraySetValueAtIndex(selectedReadSockets, idx, kCFNull);
+        }
+        selectedReadSocketsIndex = 0;
+    }
+    return NULL;
+}
+#endif
+
 static void *__CFSocketManager(void * arg)
 {
 #if TARGET_OS_LINUX && !TARGET_OS_CYGWIN
     pthread_setname_np(pthread_self(), "com.apple.CFSocket.private");
 #elif !TARGET_OS_CYGWIN && !TARGET_OS_BSD
     pthread_setname_np("com.apple.CFSocket.private");
+#endif
+#if USE_EPOLL_FOR_SOCKET_MANAGER
+    if (__CFSocketUsesEpoll()) return __CFSocketManagerEpoll(arg);
 #endif
     SInt32 nrfds, maxnrfds, fdentries = 1;
     SInt32 rfds, wfds;
@@ -1816,6 +2085,7 @@ void CFSocketInvalidate(CFSocketRef s) {
             CFArrayRemoveValueAtIndex(__CFReadSockets, idx);
             __CFSocketClearFDForRead(s);
         }
+        __CFSocketUnsetActive(s);
         previousSocketManagerIteration = __CFSocketManagerIteration;
         __CFUnlock(&__CFActiveSocketsLock);
         CFDictionaryRemoveValue(__CFAllSockets, (void *)(uintptr_t)(s->_socket));
@@ -2027,6 +2297,7 @@ void __CFSocketEnableCallBacks(CFSocketRef s, CFOptionFlags callBackTypes, Boole
                         CFArrayAppendValue(__CFWriteSockets, s);
                     if (kCFNotFound == idx)
                         __CFSOCKETLOG_WS(s, "put %p __CFWriteSockets list due to force and non-presence");
+                    __CFSocketSetActive(s);
                 }
                 if (__CFSocketSetFDForWrite(s)) wakeup = true;
             }
@@ -2034,6 +2305,7 @@ void __CFSocketEnableCallBacks(CFSocketRef s, CFOptionFlags callBackTypes, Boole
                 if (force) {
                     SInt32 idx = CFArrayGetFirstIndexOfValue(__CFReadSockets, CFRangeMake(0, CFArrayGetCount(__CFReadSockets)), s);
                     if (kCFNotFound == idx) CFArrayAppendValue(__CFReadSockets, s);
+                    __CFSocketSetActive(s);
                 }
                 if (__CFSocketSetFDForRead(s)) wakeup = true;
             }
@@ -2092,6 +2364,7 @@ static void __CFSocketCancel(void *info, CFRunLoopRef rl, CFStringRef mode) {
             CFArrayRemoveValueAtIndex(__CFReadSockets, idx);
             __CFSocketClearFDForRead(s);
         }
+        __CFSocketUnsetActive(s);
         __CFUnlock(&__CFActiveSocketsLock);
     }
     if (NULL != s->_runLoops) {
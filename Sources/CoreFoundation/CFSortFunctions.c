@@ -68,94 +68,275 @@ typedef CFIndex INDEX_TYPE;
 typedef CFComparisonResult CMP_RESULT_TYPE;
 typedef CMP_RESULT_TYPE (^COMPARATOR_BLOCK)(VALUE_TYPE, VALUE_TYPE);
 
-/*
-Number of elements in a list and expected number of compares,
-when the initial short-circuiting compare is not done.
-1	0
-2	1
-3	2.667
-4	4.667
-5	7.167
-6	9.833
-7	12.733
-8	15.733
-9	19.167
-10	22.667
-11	26.2857
-12	29.9524
+/* Per-thread scratch arena.
+
+   Sorting a large array needs an index buffer and, on the concurrent path, as much
+   again for merging. Rather than going to malloc for every call (and for every
+   section of a concurrent sort), each thread keeps one bump-allocated arena that
+   is handed out and returned in LIFO order, so a comparator that itself sorts
+   still works. Requests that do not fit are satisfied by malloc; the arena only
+   grows to __CF_SORT_SCRATCH_RETAINED_LIMIT so that one huge sort does not pin
+   its buffers to the thread forever.
 */
 
-static void __CFSimpleMerge(VALUE_TYPE listp[], INDEX_TYPE cnt1, INDEX_TYPE cnt2, VALUE_TYPE tmp[], COMPARATOR_BLOCK cmp) {
-    if (cnt1 <= 0 || cnt2 <= 0) return;
-    // if the last element of listp1 <= the first of listp2, lists are already ordered
-    if (16 < cnt1 + cnt2 && cmp(listp[cnt1 - 1], listp[cnt1]) <= 0) return;
+#define __CF_SORT_SCRATCH_RETAINED_LIMIT (1024 * 1024)
+#define __CF_SORT_SCRATCH_ALIGNMENT (16)
 
-    INDEX_TYPE idx = 0, idx1 = 0, idx2 = cnt1;
-    for (;;) {
-        if (cnt1 <= idx1) {
-            while (idx--) {
-                listp[idx] = tmp[idx];
-            }
-            return;
-        }
-        if (cnt1 + cnt2 <= idx2) {
-            for (INDEX_TYPE t = cnt1 + cnt2 - 1; idx <= t; t--) {
-                listp[t] = listp[t - cnt2];
+typedef struct {
+    uint8_t *_base;
+    size_t _capacity;
+    size_t _used;
+} __CFSortScratch;
+
+static void __CFSortScratchDestructor(void *data) {
+    __CFSortScratch *scratch = (__CFSortScratch *)data;
+    if (NULL == scratch) return;
+    free(scratch->_base);
+    free(scratch);
+}
+
+static __CFSortScratch *__CFSortScratchGetThreadArena(void) {
+    __CFSortScratch *scratch = (__CFSortScratch *)_CFGetTSD(__CFTSDKeySortScratch);
+    if (NULL == scratch) {
+        scratch = (__CFSortScratch *)calloc(1, sizeof(__CFSortScratch));
+        if (NULL == scratch) return NULL;
+        _CFSetTSD(__CFTSDKeySortScratch, (void *)scratch, __CFSortScratchDestructor);
+    }
+    return scratch;
+}
+
+CF_INLINE size_t __CFSortScratchRoundedSize(size_t size) {
+    return (size + __CF_SORT_SCRATCH_ALIGNMENT - 1) & ~(size_t)(__CF_SORT_SCRATCH_ALIGNMENT - 1);
+}
+
+static void *__CFSortScratchAcquire(size_t size) {
+    size_t rounded = __CFSortScratchRoundedSize(size);
+    if (rounded <= __CF_SORT_SCRATCH_RETAINED_LIMIT) {
+        __CFSortScratch *scratch = __CFSortScratchGetThreadArena();
+        if (scratch) {
+            if (0 == scratch->_used && scratch->_capacity < rounded) {
+                // Nothing is outstanding, so the arena can move.
+                void *base = realloc(scratch->_base, rounded);
+                if (base) {
+                    scratch->_base = (uint8_t *)base;
+                    scratch->_capacity = rounded;
+                }
             }
-            while (idx--) {
-                listp[idx] = tmp[idx];
+            if (rounded <= scratch->_capacity - scratch->_used) {
+                void *result = scratch->_base + scratch->_used;
+                scratch->_used += rounded;
+                return result;
             }
-            return;
         }
-        VALUE_TYPE v1 = listp[idx1], v2 = listp[idx2];
-        if (cmp(v1, v2) <= 0) {
-            tmp[idx] = v1;
-            idx1++;
-        } else {
-            tmp[idx] = v2;
-            idx2++;
+    }
+    void *result = malloc(size);
+    if (NULL == result) {
+        CRSetCrashLogMessage("sort - scratch allocation failed");
+        HALT;
+    }
+    return result;
+}
+
+static void __CFSortScratchRelease(void *ptr, size_t size) {
+    __CFSortScratch *scratch = (__CFSortScratch *)_CFGetTSDCreateIfNeeded(__CFTSDKeySortScratch, false);
+    if (scratch && scratch->_base <= (uint8_t *)ptr && (uint8_t *)ptr < scratch->_base + scratch->_capacity) {
+        scratch->_used -= __CFSortScratchRoundedSize(size);
+        return;
+    }
+    free(ptr);
+}
+
+/* Pattern-defeating quicksort (Orson Peters), specialised for sorting indexes.
+
+   The values being sorted are indexes into the caller's collection, so ties on
+   the comparator are broken by the index itself. That makes every key distinct,
+   which both turns the in-place quicksort into a stable sort and lets us drop
+   pdqsort's equal-elements partition: an element equal to the previous pivot
+   can no longer occur.
+*/
+
+#define __CF_SORT_INSERTION_THRESHOLD (24)
+#define __CF_SORT_NINTHER_THRESHOLD (128)
+#define __CF_SORT_PARTIAL_INSERTION_LIMIT (8)
+
+CF_INLINE Boolean __CFSortLess(VALUE_TYPE v1, VALUE_TYPE v2, COMPARATOR_BLOCK cmp) {
+    CMP_RESULT_TYPE res = cmp(v1, v2);
+    return res < 0 || (0 == res && v1 < v2);
+}
+
+CF_INLINE void __CFSortSwap(VALUE_TYPE *a, VALUE_TYPE *b) {
+    VALUE_TYPE vt = *a;
+    *a = *b;
+    *b = vt;
+}
+
+CF_INLINE void __CFSortSort2(VALUE_TYPE *a, VALUE_TYPE *b, COMPARATOR_BLOCK cmp) {
+    if (__CFSortLess(*b, *a, cmp)) __CFSortSwap(a, b);
+}
+
+CF_INLINE void __CFSortSort3(VALUE_TYPE *a, VALUE_TYPE *b, VALUE_TYPE *c, COMPARATOR_BLOCK cmp) {
+    __CFSortSort2(a, b, cmp);
+    __CFSortSort2(b, c, cmp);
+    __CFSortSort2(a, b, cmp);
+}
+
+static void __CFSortInsertion(VALUE_TYPE *begin, VALUE_TYPE *end, COMPARATOR_BLOCK cmp) {
+    if (begin == end) return;
+    for (VALUE_TYPE *cur = begin + 1; cur < end; cur++) {
+        VALUE_TYPE *sift = cur;
+        VALUE_TYPE *sift_1 = cur - 1;
+        if (__CFSortLess(*sift, *sift_1, cmp)) {
+            VALUE_TYPE vt = *sift;
+            do {
+                *sift-- = *sift_1;
+            } while (sift != begin && __CFSortLess(vt, *--sift_1, cmp));
+            *sift = vt;
         }
-        idx++;
     }
 }
 
-static void __CFSimpleMergeSort(VALUE_TYPE listp[], INDEX_TYPE cnt, VALUE_TYPE tmp[], COMPARATOR_BLOCK cmp) {
-    if (cnt < 2) {
-        /* do nothing */
-    } else if (2 == cnt) {
-        VALUE_TYPE v0 = listp[0], v1 = listp[1];
-        if (0 < cmp(v0, v1)) {
-            listp[0] = v1;
-            listp[1] = v0;
+// Insertion sorts [begin, end), giving up once too many elements have had to move. Returns true if the range ended up sorted.
+static Boolean __CFSortPartialInsertion(VALUE_TYPE *begin, VALUE_TYPE *end, COMPARATOR_BLOCK cmp) {
+    if (begin == end) return true;
+    INDEX_TYPE moved = 0;
+    for (VALUE_TYPE *cur = begin + 1; cur < end; cur++) {
+        VALUE_TYPE *sift = cur;
+        VALUE_TYPE *sift_1 = cur - 1;
+        if (__CFSortLess(*sift, *sift_1, cmp)) {
+            VALUE_TYPE vt = *sift;
+            do {
+                *sift-- = *sift_1;
+            } while (sift != begin && __CFSortLess(vt, *--sift_1, cmp));
+            *sift = vt;
+            moved += cur - sift;
+            if (__CF_SORT_PARTIAL_INSERTION_LIMIT < moved) return false;
         }
-    } else if (3 == cnt) {
-        VALUE_TYPE v0 = listp[0], v1 = listp[1], v2 = listp[2], vt;
-        if (0 < cmp(v0, v1)) {
-            vt = v0;
-            v0 = v1;
-            v1 = vt;
+    }
+    return true;
+}
+
+static void __CFSortHeapSiftDown(VALUE_TYPE *base, INDEX_TYPE root, INDEX_TYPE cnt, COMPARATOR_BLOCK cmp) {
+    VALUE_TYPE v = base[root];
+    for (;;) {
+        INDEX_TYPE child = 2 * root + 1;
+        if (cnt <= child) break;
+        if (child + 1 < cnt && __CFSortLess(base[child], base[child + 1], cmp)) child++;
+        if (!__CFSortLess(v, base[child], cmp)) break;
+        base[root] = base[child];
+        root = child;
+    }
+    base[root] = v;
+}
+
+static void __CFSortHeap(VALUE_TYPE *begin, VALUE_TYPE *end, COMPARATOR_BLOCK cmp) {
+    INDEX_TYPE cnt = end - begin;
+    for (INDEX_TYPE idx = cnt / 2; 0 < idx--;) {
+        __CFSortHeapSiftDown(begin, idx, cnt, cmp);
+    }
+    for (INDEX_TYPE idx = cnt - 1; 0 < idx; idx--) {
+        __CFSortSwap(begin, begin + idx);
+        __CFSortHeapSiftDown(begin, 0, idx, cmp);
+    }
+}
+
+/* Partitions [begin, end) around *begin.
+   With a consistent comparator, the median-of-3 selection and the swaps keep every scan inside the range on their own. The comparator is the caller's, though, so each scan also checks its bounds: a comparator that contradicts itself gets an unsorted result, never a read or write outside the buffer. */
+static VALUE_TYPE *__CFSortPartitionRight(VALUE_TYPE *begin, VALUE_TYPE *end, Boolean *alreadyPartitioned, COMPARATOR_BLOCK cmp) {
+    VALUE_TYPE pivot = *begin;
+    VALUE_TYPE *first = begin;
+    VALUE_TYPE *last = end;
+
+    while (++first < end && __CFSortLess(*first, pivot, cmp));
+    if (first - 1 == begin) {
+        while (first < last && !__CFSortLess(*--last, pivot, cmp));
+    } else {
+        while (begin < --last && !__CFSortLess(*last, pivot, cmp));
+    }
+
+    *alreadyPartitioned = (last <= first);
+    while (first < last) {
+        __CFSortSwap(first, last);
+        while (++first < last && __CFSortLess(*first, pivot, cmp));
+        while (first < --last && !__CFSortLess(*last, pivot, cmp));
+    }
+
+    VALUE_TYPE *pivotPos = first - 1;
+    *begin = *pivotPos;
+    *pivotPos = pivot;
+    return pivotPos;
+}
+
+static void __CFSortPDQLoop(VALUE_TYPE *begin, VALUE_TYPE *end, int32_t badAllowed, COMPARATOR_BLOCK cmp) {
+    for (;;) {
+        INDEX_TYPE cnt = end - begin;
+        if (cnt < __CF_SORT_INSERTION_THRESHOLD) {
+            // Always the guarded insertion sort: the unguarded one relies on the element before begin, and so on the comparator being consistent.
+            __CFSortInsertion(begin, end, cmp);
+            return;
         }
-        if (0 < cmp(v1, v2)) {
-            vt = v1;
-            v1 = v2;
-            v2 = vt;
-            if (0 < cmp(v0, v1)) {
-                vt = v0;
-                v0 = v1;
-                v1 = vt;
+
+        INDEX_TYPE half_cnt = cnt / 2;
+        if (__CF_SORT_NINTHER_THRESHOLD < cnt) {
+            __CFSortSort3(begin, begin + half_cnt, end - 1, cmp);
+            __CFSortSort3(begin + 1, begin + (half_cnt - 1), end - 2, cmp);
+            __CFSortSort3(begin + 2, begin + (half_cnt + 1), end - 3, cmp);
+            __CFSortSort3(begin + (half_cnt - 1), begin + half_cnt, begin + (half_cnt + 1), cmp);
+            __CFSortSwap(begin, begin + half_cnt);
+        } else {
+            __CFSortSort3(begin + half_cnt, begin, end - 1, cmp);
+        }
+
+        Boolean alreadyPartitioned = false;
+        VALUE_TYPE *pivotPos = __CFSortPartitionRight(begin, end, &alreadyPartitioned, cmp);
+        INDEX_TYPE l_cnt = pivotPos - begin;
+        INDEX_TYPE r_cnt = end - (pivotPos + 1);
+
+        if (l_cnt < cnt / 8 || r_cnt < cnt / 8) {
+            // A bad partition; after too many of these, give up on quicksort for this range.
+            if (0 == --badAllowed) {
+                __CFSortHeap(begin, end, cmp);
+                return;
+            }
+            // Otherwise shuffle a few elements around to break up whatever pattern caused it.
+            if (__CF_SORT_INSERTION_THRESHOLD <= l_cnt) {
+                __CFSortSwap(begin, begin + l_cnt / 4);
+                __CFSortSwap(pivotPos - 1, pivotPos - l_cnt / 4);
+                if (__CF_SORT_NINTHER_THRESHOLD < l_cnt) {
+                    __CFSortSwap(begin + 1, begin + (l_cnt / 4 + 1));
+                    __CFSortSwap(begin + 2, begin + (l_cnt / 4 + 2));
+                    __CFSortSwap(pivotPos - 2, pivotPos - (l_cnt / 4 + 1));
+                    __CFSortSwap(pivotPos - 3, pivotPos - (l_cnt / 4 + 2));
+                }
+            }
+            if (__CF_SORT_INSERTION_THRESHOLD <= r_cnt) {
+                __CFSortSwap(pivotPos + 1, pivotPos + (1 + r_cnt / 4));
+                __CFSortSwap(end - 1, end - r_cnt / 4);
+                if (__CF_SORT_NINTHER_THRESHOLD < r_cnt) {
+                    __CFSortSwap(pivotPos + 2, pivotPos + (2 + r_cnt / 4));
+                    __CFSortSwap(pivotPos + 3, pivotPos + (3 + r_cnt / 4));
+                    __CFSortSwap(end - 2, end - (1 + r_cnt / 4));
+                    __CFSortSwap(end - 3, end - (2 + r_cnt / 4));
+                }
             }
+        } else if (alreadyPartitioned && __CFSortPartialInsertion(begin, pivotPos, cmp) && __CFSortPartialInsertion(pivotPos + 1, end, cmp)) {
+            // The input looked sorted already and both halves turned out to be.
+            return;
         }
-        listp[0] = v0;
-        listp[1] = v1;
-        listp[2] = v2;
-    } else {
-        INDEX_TYPE half_cnt = cnt / 2;
-        __CFSimpleMergeSort(listp, half_cnt, tmp, cmp);
-        __CFSimpleMergeSort(listp + half_cnt, cnt - half_cnt, tmp, cmp);
-        __CFSimpleMerge(listp, half_cnt, cnt - half_cnt, tmp, cmp);
+
+        __CFSortPDQLoop(begin, pivotPos, badAllowed, cmp);
+        begin = pivotPos + 1;
     }
 }
 
+// Stable and in place; needs no scratch space.
+static void __CFSortIndexes1(VALUE_TYPE listp[], INDEX_TYPE cnt, COMPARATOR_BLOCK cmp) {
+    if (cnt < 2) return;
+    int32_t badAllowed = 0;
+    for (INDEX_TYPE n = cnt; 1 < n; n >>= 1) badAllowed++;
+    __CFSortPDQLoop(listp, listp + cnt, badAllowed, cmp);
+}
+
+
 #if __HAS_DISPATCH__
 
 // if !right, put the cnt1 smallest values in tmp, else put the cnt2 largest values in tmp
@@ -229,15 +410,18 @@ static void __CFSortIndexesN(VALUE_TYPE listp[], INDEX_TYPE count, int32_t ncore
     INDEX_TYPE num_sect = (count + sz - 1) / sz;
     INDEX_TYPE last_sect_len = count + sz - sz * num_sect;
 
+    /* One scratch block for every section, carved out of a single allocation */
+    size_t scratch_size = (size_t)num_sect * sz * sizeof(VALUE_TYPE);
+    VALUE_TYPE *scratch = (VALUE_TYPE *)__CFSortScratchAcquire(scratch_size);
     STACK_BUFFER_DECL(VALUE_TYPE *, stack_tmps, num_sect);
     for (INDEX_TYPE idx = 0; idx < num_sect; idx++) {
-        stack_tmps[idx] = (VALUE_TYPE *)malloc(sz * sizeof(VALUE_TYPE));
+        stack_tmps[idx] = scratch + idx * sz;
     }
     VALUE_TYPE **tmps = stack_tmps;
 
     dispatch_apply(num_sect, DISPATCH_APPLY_AUTO, ^(size_t sect) {
             INDEX_TYPE sect_len = (sect < num_sect - 1) ? sz : last_sect_len;
-            __CFSimpleMergeSort(listp + sect * sz, sect_len, tmps[sect], cmp); // naturally stable
+            __CFSortIndexes1(listp + sect * sz, sect_len, cmp); // stable, since ties are broken by index
         });
 
     INDEX_TYPE even_phase_cnt = ((num_sect / 2) * 2);
@@ -266,9 +450,7 @@ static void __CFSortIndexesN(VALUE_TYPE listp[], INDEX_TYPE count, int32_t ncore
         }
     }
 
-    for (INDEX_TYPE idx = 0; idx < num_sect; idx++) {
-        free(stack_tmps[idx]);
-    }
+    __CFSortScratchRelease(scratch, scratch_size);
 }
 #endif
 
@@ -278,8 +460,7 @@ static void __CFSortIndexesN(VALUE_TYPE listp[], INDEX_TYPE count, int32_t ncore
 #define _CF_SORT_INDEXES_EXPORT
 #endif
 
-// fills an array of indexes (of length count) giving the indexes 0 - count-1, as sorted by the comparator block
-_CF_SORT_INDEXES_EXPORT void CFSortIndexes(CFIndex *indexBuffer, CFIndex count, CFOptionFlags opts, CFComparisonResult (^cmp)(CFIndex, CFIndex)) {
+static void __CFSortIndexes(CFIndex *indexBuffer, CFIndex count, CFOptionFlags opts, CFIndex maximumConcurrency, CFComparisonResult (^cmp)(CFIndex, CFIndex)) {
     if (count < 1) return;
     if (INTPTR_MAX / sizeof(CFIndex) < count) {
         CRSetCrashLogMessage("Size of array to be sorted is too big");
@@ -288,6 +469,9 @@ _CF_SORT_INDEXES_EXPORT void CFSortIndexes(CFIndex *indexBuffer, CFIndex count,
     int32_t ncores = 0;
     if (opts & kCFSortConcurrent) {
         ncores = __CFActiveProcessorCount();
+        if (0 < maximumConcurrency && maximumConcurrency < ncores) {
+            ncores = (int32_t)maximumConcurrency;
+        }
         if (count < 160 || ncores < 2) {
             opts = (opts & ~kCFSortConcurrent);
         } else if (count < 640 && 2 < ncores) {
@@ -319,14 +503,73 @@ _CF_SORT_INDEXES_EXPORT void CFSortIndexes(CFIndex *indexBuffer, CFIndex count,
 #endif
 #if __HAS_DISPATCH__
     if (opts & kCFSortConcurrent) {
-        __CFSortIndexesN(indexBuffer, count, ncores, cmp); // naturally stable
+        __CFSortIndexesN(indexBuffer, count, ncores, cmp); // stable
         return;
     }
 #endif
-    STACK_BUFFER_DECL(VALUE_TYPE, local, count <= 4096 ? count : 1);
-    VALUE_TYPE *tmp = (count <= 4096) ? local : (VALUE_TYPE *)malloc(count * sizeof(VALUE_TYPE));
-    __CFSimpleMergeSort(indexBuffer, count, tmp, cmp); // naturally stable
-    if (local != tmp) free(tmp);
+    __CFSortIndexes1(indexBuffer, count, cmp); // stable, and needs no scratch space
+}
+
+// fills an array of indexes (of length count) giving the indexes 0 - count-1, as sorted by the comparator block
+_CF_SORT_INDEXES_EXPORT void CFSortIndexes(CFIndex *indexBuffer, CFIndex count, CFOptionFlags opts, CFComparisonResult (^cmp)(CFIndex, CFIndex)) {
+    __CFSortIndexes(indexBuffer, count, opts, 0, cmp);
+}
+
+// as CFSortIndexes, but a concurrent sort uses at most maximumConcurrency threads; 0 means no limit beyond the active processor count
+_CF_SORT_INDEXES_EXPORT void _CFSortIndexesWithMaximumConcurrency(CFIndex *indexBuffer, CFIndex count, CFOptionFlags opts, CFIndex maximumConcurrency, CFComparisonResult (^cmp)(CFIndex, CFIndex)) {
+    __CFSortIndexes(indexBuffer, count, opts, maximumConcurrency, cmp);
+}
+
+/* Moves each element of list to where indexes says it belongs: afterwards list[idx] holds what was at list[indexes[idx]].
+   Each cycle of the permutation is followed in place, so only one element is ever held aside. indexes is consumed. */
+static void __CFSortApplyIndexes(void *list, CFIndex count, CFIndex elementSize, CFIndex *indexes) {
+    if (sizeof(uintptr_t) == elementSize) {
+        uintptr_t *values = (uintptr_t *)list;
+        for (CFIndex start = 0; start < count; start++) {
+            if (indexes[start] == start) continue;
+            uintptr_t held = values[start];
+            CFIndex dst = start;
+            for (;;) {
+                CFIndex src = indexes[dst];
+                indexes[dst] = dst;
+                if (src == start) {
+                    values[dst] = held;
+                    break;
+                }
+                values[dst] = values[src];
+                dst = src;
+            }
+        }
+        return;
+    }
+    uint8_t local[64];
+    uint8_t *held = (elementSize <= (CFIndex)sizeof(local)) ? local : (uint8_t *)__CFSortScratchAcquire(elementSize);
+    uint8_t *bytes = (uint8_t *)list;
+    for (CFIndex start = 0; start < count; start++) {
+        if (indexes[start] == start) continue;
+        memmove(held, bytes + start * elementSize, elementSize);
+        CFIndex dst = start;
+        for (;;) {
+            CFIndex src = indexes[dst];
+            indexes[dst] = dst;
+            if (src == start) {
+                memmove(bytes + dst * elementSize, held, elementSize);
+                break;
+            }
+            memmove(bytes + dst * elementSize, bytes + src * elementSize, elementSize);
+            dst = src;
+        }
+    }
+    if (held != local) __CFSortScratchRelease(held, elementSize);
+}
+
+static void __CFSortArrayValidated(void *list, CFIndex count, CFIndex elementSize, CFComparatorFunction comparator, void *context, CFOptionFlags opts) {
+    STACK_BUFFER_DECL(CFIndex, locali, count <= 4096 ? count : 1);
+    CFIndex *indexes = (count <= 4096) ? locali : (CFIndex *)__CFSortScratchAcquire(count * sizeof(CFIndex));
+    __CFSortIndexes(indexes, count, opts, 0, ^(CFIndex a, CFIndex b) { return comparator((char *)list + a * elementSize, (char *)list + b * elementSize, context); });
+    // no swapping or modification of the original list has occurred until this point
+    __CFSortApplyIndexes(list, count, elementSize, indexes);
+    if (locali != indexes) __CFSortScratchRelease(indexes, count * sizeof(CFIndex));
 }
 
 /* Comparator is passed the address of the values. */
@@ -344,35 +587,7 @@ void CFQSortArray(void *list, CFIndex count, CFIndex elementSize, CFComparatorFu
         CRSetCrashLogMessage("qsort - array access overflow");
         HALT;
     }
-    STACK_BUFFER_DECL(CFIndex, locali, count <= 4096 ? count : 1);
-    CFIndex *indexes = (count <= 4096) ? locali : (CFIndex *)malloc(count * sizeof(CFIndex));
-    if (indexes == NULL) {
-        CFLog(kCFLogLevelError, CFSTR("unable to qsort array - malloc failed"));
-        CRSetCrashLogMessage("qsort - malloc failed");
-        HALT;
-    }
-    CFSortIndexes(indexes, count, 0, ^(CFIndex a, CFIndex b) { return comparator((char *)list + a * elementSize, (char *)list + b * elementSize, context); });
-    STACK_BUFFER_DECL(uint8_t, locals, count <= (16 * 1024 / elementSize) ? count * elementSize : 1);
-    void *store = (count <= (16 * 1024 / elementSize)) ? locals : malloc(count * elementSize);
-    overflowResult = _CFPointerSumWouldOverflow(store, count * elementSize, NULL);
-    if (overflowResult != _CFOverflowResultOK) {
-        CFLog(kCFLogLevelError, CFSTR("Unable to qsort array - list: %lu count: %ld elementSize: %ld array - store overflows"), (unsigned long)list, (long)count, (long)elementSize);
-        CRSetCrashLogMessage("qsort - array storage overflow");
-        HALT;
-    }
-    for (CFIndex idx = 0; idx < count; idx++) {
-        if (sizeof(uintptr_t) == elementSize) {
-            uintptr_t *a = (uintptr_t *)list + indexes[idx];
-            uintptr_t *b = (uintptr_t *)store + idx;
-            *b = *a;
-        } else {
-            memmove((char *)store + idx * elementSize, (char *)list + indexes[idx] * elementSize, elementSize);
-        }
-    }
-    // no swapping or modification of the original list has occurred until this point
-    memmove(list, store, count * elementSize);
-    if (locals != store) free(store);
-    if (locali != indexes) free(indexes);
+    __CFSortArrayValidated(list, count, elementSize, comparator, context, 0);
 }
 
 /* Comparator is passed the address of the values. */
@@ -390,35 +605,5 @@ void CFMergeSortArray(void *list, CFIndex count, CFIndex elementSize, CFComparat
         CRSetCrashLogMessage("merge sort - array access overflow");
         HALT;
     }
-    STACK_BUFFER_DECL(CFIndex, locali, count <= 4096 ? count : 1);
-    CFIndex *indexes = (count <= 4096) ? locali : (CFIndex *)malloc(count * sizeof(CFIndex));
-    if (indexes == NULL) {
-        CFLog(kCFLogLevelError, CFSTR("unable to mergesort array - malloc failed"));
-        CRSetCrashLogMessage("merge sort - malloc failure");
-        HALT;
-    }
-    CFSortIndexes(indexes, count, kCFSortStable, ^(CFIndex a, CFIndex b) { return comparator((char *)list + a * elementSize, (char *)list + b * elementSize, context); });
-    STACK_BUFFER_DECL(uint8_t, locals, count <= (16 * 1024 / elementSize) ? count * elementSize : 1);
-    void *store = (count <= (16 * 1024 / elementSize)) ? locals : malloc(count * elementSize);
-    overflowResult = _CFPointerSumWouldOverflow(store, count * elementSize, NULL);
-    if (overflowResult != _CFOverflowResultOK) {
-        CFLog(kCFLogLevelError, CFSTR("Unable to mergesort array - list: %lu count: %ld elementSize: %ld - array store overflows"), (unsigned long)list, (long)count, (long)elementSize);
-        CRSetCrashLogMessage("merge sort - overflow array storage");
-        HALT;
-    }
-    for (CFIndex idx = 0; idx < count; idx++) {
-        if (sizeof(uintptr_t) == elementSize) {
-            uintptr_t *a = (uintptr_t *)list + indexes[idx];
-            uintptr_t *b = (uintptr_t *)store + idx;
-            *b = *a;
-        } else {
-            memmove((char *)store + idx * elementSize, (char *)list + indexes[idx] * elementSize, elementSize);
-        }
-    }
-    // no swapping or modification of the original list has occurred until this point
-    memmove(list, store, count * elementSize);
-    if (locals != store) free(store);
-    if (locali != indexes) free(indexes);
+    __CFSortArrayValidated(list, count, elementSize, comparator, context, kCFSortStable);
 }
-
-
@@ -715,6 +715,47 @@ CF_EXPORT void * _CFGetHandleForInsertedOrInterposingLibrary(char const *namePre
 CF_EXPORT Boolean _CFRunLoopPerCalloutAutoreleasepoolEnabled(void) API_AVAILABLE(macos(10.16), ios(14.0), watchos(7.0), tvos(14.0));
 CF_EXPORT Boolean _CFRunLoopSetPerCalloutAutoreleasepoolEnabled(Boolean enabled) API_AVAILABLE(macos(10.16), ios(14.0), watchos(7.0), tvos(14.0));
 
+/* Run loop statistics. Every run loop mode counts its wake ups, the time spent
+   waiting for them, how late its timers fire, and how long each kind of
+   callout takes, from the moment the mode is created. Durations and lateness
+   are in nanoseconds.
+*/
+typedef CF_ENUM(CFIndex, _CFRunLoopCalloutKind) {
+    _kCFRunLoopCalloutSource0 = 0,
+    _kCFRunLoopCalloutSource1,
+    _kCFRunLoopCalloutTimer,
+    _kCFRunLoopCalloutObserver,
+    _kCFRunLoopCalloutKindCount
+};
+
+/* Bucket 0 counts callouts that took less than a microsecond; bucket n counts
+   those that took at least 2^(n-1) and less than 2^n microseconds, except for
+   the last bucket, which counts everything longer. */
+enum {
+    _kCFRunLoopCalloutHistogramBucketCount = 20
+};
+
+typedef struct {
+    uint64_t count;
+    uint64_t totalNanoseconds;
+    uint64_t maxNanoseconds;
+    const void *slowestCallout; // the function that took maxNanoseconds
+    uint64_t histogram[_kCFRunLoopCalloutHistogramBucketCount];
+} _CFRunLoopCalloutStatistics;
+
+typedef struct {
+    uint64_t wakeUps;
+    uint64_t nanosecondsAsleep;
+    uint64_t totalTimerLatenessNanoseconds;
+    uint64_t maxTimerLatenessNanoseconds;
+    _CFRunLoopCalloutStatistics callouts[_kCFRunLoopCalloutKindCount];
+} _CFRunLoopStatistics;
+
+// Copies the statistics for the named mode into stats, or the sum over all modes if modeName is NULL. Returns false if the mode does not exist.
+CF_EXPORT Boolean _CFRunLoopGetStatistics(CFRunLoopRef rl, CFStringRef modeName, _CFRunLoopStatistics *stats);
+// Starts counting again from zero for the named mode, or for all modes if modeName is NULL.
+CF_EXPORT void _CFRunLoopResetStatistics(CFRunLoopRef rl, CFStringRef modeName);
+
 CF_EXTERN_C_END
 
 #endif /* ! __COREFOUNDATION_CFPRIV__ */
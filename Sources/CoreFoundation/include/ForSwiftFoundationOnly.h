@@ -416,6 +416,7 @@ CF_EXPORT CFHashCode __CFHashDouble(double d);
 
 #if __BLOCKS__
 CF_CROSS_PLATFORM_EXPORT void CFSortIndexes(CFIndex *indexBuffer, CFIndex count, CFOptionFlags opts, CFComparisonResult (^cmp)(CFIndex, CFIndex));
+CF_CROSS_PLATFORM_EXPORT void _CFSortIndexesWithMaximumConcurrency(CFIndex *indexBuffer, CFIndex count, CFOptionFlags opts, CFIndex maximumConcurrency, CFComparisonResult (^cmp)(CFIndex, CFIndex));
 #endif
 
 CF_EXPORT CFTypeRef _Nullable _CFThreadSpecificGet(_CFThreadSpecificKey key);
@@ -381,6 +381,7 @@ enum {
         __CFTSDKeyWeakReferenceHandler = 14,
         __CFTSDKeyIsInPreferences = 15,
         __CFTSDKeyPendingPreferencesKVONotifications = 16,
+        __CFTSDKeySortScratch = 17,
 	// autorelease pool stuff must be higher than run loop constants
 	__CFTSDKeyAutoreleaseData2 = 61,
 	__CFTSDKeyAutoreleaseData1 = 62,
@@ -315,45 +315,109 @@ open class FileHandle : NSObject, @unchecked Sendable {
             throw _NSErrorWithErrno(errno, reading: true)
         }
 
-        let readBlockSize: Int
         if statbuf.st_mode & S_IFMT == S_IFREG {
-            // TODO: Should files over a certain size always be mmap()'d?
-            if options.contains(.alwaysMapped) {
-                // Filesizes are often 64bit even on 32bit systems
-                let mapSize = min(length, Int(clamping: statbuf.st_size))
-                let data = mmap(nil, mapSize, PROT_READ, MAP_PRIVATE, _fd, 0)
-                // Swift does not currently expose MAP_FAILURE
-                if data != UnsafeMutableRawPointer(bitPattern: -1) {
-                    return NSData.NSDataReadResult(bytes: data!, length: mapSize) { buffer, length in
-                        munmap(buffer, length)
-                    }
+            // Reads start wherever the handle currently is, not necessarily at the start of the file.
+            let offset = lseek(_fd, 0, SEEK_CUR)
+            if offset < 0 {
+                throw _NSErrorWithErrno(errno, reading: true)
+            }
+            // Filesizes are often 64bit even on 32bit systems
+            let remainingInFile = Int(clamping: max(Int64(statbuf.st_size) - Int64(offset), 0))
+            let mapSize = min(length, remainingInFile)
+            if mapSize > 0 && _shouldMap(mapSize, untilEOF: untilEOF, options: options) {
+                if let result = _mapRegion(at: Int64(offset), length: mapSize) {
+                    return result
                 }
             }
+            return try _readRegularFile(length, untilEOF: untilEOF, expected: remainingInFile, blockSize: statbuf.st_blksize > 0 ? Int(clamping: statbuf.st_blksize) : 1024 * 8)
+        }
 
-            if statbuf.st_blksize > 0 {
-                readBlockSize = Int(clamping: statbuf.st_blksize)
-            } else {
-                readBlockSize = 1024 * 8
-            }
-        } else {
-            /* We get here on sockets, character special files, FIFOs ... */
-            readBlockSize = 1024 * 8
+        /* We get here on sockets, character special files, FIFOs ... */
+        return try _readStream(length, untilEOF: untilEOF)
+#endif
+    }
+
+#if !os(Windows)
+    /// Files are only mapped when the caller asks for it. The returned data
+    /// shares the file's pages, so later writes to the file show through it,
+    /// and touching pages past a truncation raises SIGBUS.
+    private func _shouldMap(_ size: Int, untilEOF: Bool, options: NSData.ReadingOptions) -> Bool {
+        if options.contains(.alwaysMapped) {
+            return true
+        }
+        guard options.contains(.mappedIfSafe) else {
+            return false
+        }
+        return _isOnLocalFileSystem
+    }
+
+    /// A mapping of a file on a network or user space file system can fault
+    /// if the server goes away or the file changes underneath it, so only map
+    /// files we know to be local.
+    private var _isOnLocalFileSystem: Bool {
+#if os(Linux)
+        var fs = statfs()
+        guard fstatfs(_fd, &fs) == 0 else { return false }
+        switch UInt32(truncatingIfNeeded: fs.f_type) {
+        case 0x6969,        // NFS
+             0x517B,        // SMB
+             0xFE534D42,    // SMB2
+             0xFF534D42,    // CIFS
+             0x65735546,    // FUSE
+             0x00C36400,    // Ceph
+             0x5346414F,    // AFS
+             0x01021997:    // 9P
+            return false
+        default:
+            return true
+        }
+#else
+        return true
+#endif
+    }
+
+    /// Maps `length` bytes of the file starting at `offset`, and moves the
+    /// file position past them as a read would have.
+    private func _mapRegion(at offset: Int64, length: Int) -> NSData.NSDataReadResult? {
+        let pageSize = Int64(NSPageSize())
+        let alignedOffset = offset & ~(pageSize - 1)
+        let lead = Int(offset - alignedOffset)
+        let mapLength = lead + length
+        let base = mmap(nil, mapLength, PROT_READ, MAP_PRIVATE, _fd, off_t(alignedOffset))
+        // Swift does not currently expose MAP_FAILURE
+        guard let base, base != UnsafeMutableRawPointer(bitPattern: -1) else {
+            return nil
+        }
+        guard lseek(_fd, off_t(offset + Int64(length)), SEEK_SET) >= 0 else {
+            munmap(base, mapLength)
+            return nil
+        }
+#if os(Linux)
+        // Most mapped reads are consumed front to back; let the kernel read ahead aggressively.
+        _ = madvise(base, mapLength, MADV_SEQUENTIAL)
+#endif
+        return NSData.NSDataReadResult(bytes: base.advanced(by: lead), length: length) { buffer, length in
+            munmap(buffer.advanced(by: -lead), length + lead)
         }
-        var currentAllocationSize = readBlockSize
-        var dynamicBuffer = malloc(currentAllocationSize)!
+    }
+
+    /// Reads a regular file into one allocation sized from `fstat`, growing
+    /// it only if the file turns out to be longer than it was when we looked.
+    private func _readRegularFile(_ length: Int, untilEOF: Bool, expected: Int, blockSize: Int) throws -> NSData.NSDataReadResult {
+        // One byte more than expected lets the read that sees EOF land in the same buffer.
+        var capacity = expected > 0 ? min(length, expected < Int.max ? expected + 1 : expected) : min(length, blockSize)
+        var buffer = malloc(max(capacity, 1))!
         var total = 0
 
         while total < length {
-            let remaining = length - total
-            let amountToRead = min(readBlockSize, remaining)
-            // Make sure there is always at least amountToRead bytes available in the buffer.
-            if (currentAllocationSize - total) < amountToRead {
-                currentAllocationSize *= 2
-                dynamicBuffer = _CFReallocf(dynamicBuffer, currentAllocationSize)
+            if total == capacity {
+                capacity = min(length, capacity > Int.max / 2 ? Int.max : capacity * 2)
+                buffer = _CFReallocf(buffer, capacity)
             }
-            let amtRead = _read(_fd, dynamicBuffer.advanced(by: total), amountToRead)
+            let amtRead = _read(_fd, buffer.advanced(by: total), capacity - total)
             if amtRead < 0 {
-                free(dynamicBuffer)
+                if errno == EINTR { continue }
+                free(buffer)
                 throw _NSErrorWithErrno(errno, reading: true)
             }
             total += amtRead
@@ -362,18 +426,63 @@ open class FileHandle : NSObject, @unchecked Sendable {
             }
         }
 
+        return _readResult(buffer, length: total, capacity: capacity)
+    }
+
+    /// Reads from a pipe, socket or device. Each read fills whatever is left of
+    /// the buffer and spills into a fixed side buffer, so the buffer only grows
+    /// once data has actually arrived for it, and grows to fit what arrived.
+    private func _readStream(_ length: Int, untilEOF: Bool) throws -> NSData.NSDataReadResult {
+        let spillSize = 64 * 1024
+        var capacity = min(length, 1024 * 8)
+        var buffer = malloc(max(capacity, 1))!
+        var total = 0
+
+        try withUnsafeTemporaryAllocation(byteCount: spillSize, alignment: 16) { spill in
+            while total < length {
+                let remaining = length - total
+                let intoBuffer = min(capacity - total, remaining)
+                let intoSpill = min(spillSize, remaining - intoBuffer)
+                var vectors = (iovec(iov_base: buffer.advanced(by: total), iov_len: intoBuffer),
+                               iovec(iov_base: spill.baseAddress, iov_len: intoSpill))
+                let amtRead = withUnsafeBytes(of: &vectors) { vectors in
+                    readv(_fd, vectors.baseAddress!.assumingMemoryBound(to: iovec.self), intoSpill > 0 ? 2 : 1)
+                }
+                if amtRead < 0 {
+                    if errno == EINTR { continue }
+                    free(buffer)
+                    throw _NSErrorWithErrno(errno, reading: true)
+                }
+                if amtRead > intoBuffer {
+                    let spilled = amtRead - intoBuffer
+                    let needed = total + amtRead
+                    capacity = min(length, max(needed, capacity > Int.max / 2 ? Int.max : capacity * 2))
+                    buffer = _CFReallocf(buffer, capacity)
+                    memcpy(buffer.advanced(by: total + intoBuffer), spill.baseAddress!, spilled)
+                }
+                total += amtRead
+                if amtRead == 0 || !untilEOF { // If there is nothing more to read or we shouldn't keep reading then exit
+                    break
+                }
+            }
+        }
+
+        return _readResult(buffer, length: total, capacity: capacity)
+    }
+
+    private func _readResult(_ buffer: UnsafeMutableRawPointer, length total: Int, capacity: Int) -> NSData.NSDataReadResult {
         if total == 0 {
-            free(dynamicBuffer)
+            free(buffer)
             return NSData.NSDataReadResult(bytes: nil, length: 0, deallocator: nil)
         }
-        dynamicBuffer = _CFReallocf(dynamicBuffer, total)
-        let bytePtr = dynamicBuffer.bindMemory(to: UInt8.self, capacity: total)
+        let trimmed = total < capacity ? _CFReallocf(buffer, total) : buffer
+        let bytePtr = trimmed.bindMemory(to: UInt8.self, capacity: total)
         return NSData.NSDataReadResult(bytes: bytePtr, length: total) { buffer, length in
             free(buffer)
         }
-#endif
     }
-    
+#endif
+
     internal func _readBytes(into buffer: UnsafeMutablePointer<UInt8>, length: Int) throws -> Int {
 #if os(Windows)
         var BytesRead: DWORD = 0
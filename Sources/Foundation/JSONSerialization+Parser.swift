@@ -11,16 +11,21 @@
 //===----------------------------------------------------------------------===//
 
 
+/// Parses UTF-8 JSON straight into the objects `JSONSerialization` returns,
+/// without building an intermediate tree. The bytes are borrowed, so a parser
+/// must not outlive the buffer it was created with.
 internal struct JSONParser {
     var reader: DocumentReader
     var depth: Int = 0
+    let options: JSONSerialization.ReadingOptions
 
-    init(bytes: [UInt8]) {
-        self.reader = DocumentReader(array: bytes)
+    init(bytes: UnsafeRawBufferPointer, options: JSONSerialization.ReadingOptions) {
+        self.reader = DocumentReader(bytes: bytes)
+        self.options = options
     }
 
-    mutating func parse() throws -> JSONValue {
-        try reader.consumeWhitespace()
+    mutating func parse() throws -> Any {
+        let first = try reader.consumeWhitespace()
         let value = try self.parseValue()
         #if DEBUG
         defer {
@@ -42,38 +47,51 @@ internal struct JSONParser {
             }
         }
 
+        if first != ._openbrace, first != ._openbracket, !options.contains(.fragmentsAllowed) {
+            throw JSONError.singleFragmentFoundButNotAllowed
+        }
+
         return value
     }
 
     // MARK: Generic Value Parsing
 
-    mutating func parseValue() throws -> JSONValue {
+    mutating func parseValue() throws -> Any {
         var whitespace = 0
         while let byte = reader.peek(offset: whitespace) {
             switch byte {
             case UInt8(ascii: "\""):
                 reader.moveReaderIndex(forwardBy: whitespace)
-                return .string(try reader.readString())
+                let string = try reader.readString()
+                if options.contains(.mutableLeaves) {
+                    return NSMutableString(string: string)
+                }
+                return string
             case ._openbrace:
                 reader.moveReaderIndex(forwardBy: whitespace)
                 let object = try parseObject()
-                return .object(object)
+                if options.contains(.mutableContainers) {
+                    return NSMutableDictionary(dictionary: object, copyItems: false)
+                }
+                return object
             case ._openbracket:
                 reader.moveReaderIndex(forwardBy: whitespace)
                 let array = try parseArray()
-                return .array(array)
+                if options.contains(.mutableContainers) {
+                    return NSMutableArray(array: array, copyItems: false)
+                }
+                return array
             case UInt8(ascii: "f"), UInt8(ascii: "t"):
                 reader.moveReaderIndex(forwardBy: whitespace)
                 let bool = try reader.readBool()
-                return .bool(bool)
+                return NSNumber(value: bool)
             case UInt8(ascii: "n"):
                 reader.moveReaderIndex(forwardBy: whitespace)
                 try reader.readNull()
-                return .null
+                return NSNull()
             case UInt8(ascii: "-"), UInt8(ascii: "0") ... UInt8(ascii: "9"):
                 reader.moveReaderIndex(forwardBy: whitespace)
-                let number = try self.reader.readNumber()
-                return .number(number)
+                return try self.reader.readNumber()
             case ._space, ._return, ._newline, ._tab:
                 whitespace += 1
                 continue
@@ -88,7 +106,7 @@ internal struct JSONParser {
 
     // MARK: - Parse Array -
 
-    mutating func parseArray() throws -> [JSONValue] {
+    mutating func parseArray() throws -> [Any] {
         precondition(self.reader.read() == ._openbracket)
         guard self.depth < 512 else {
             throw JSONError.tooManyNestedArraysOrDictionaries(characterIndex: self.reader.readerIndex - 1)
@@ -108,7 +126,7 @@ internal struct JSONParser {
             break
         }
 
-        var array = [JSONValue]()
+        var array = [Any]()
         array.reserveCapacity(10)
 
         // parse values
@@ -142,7 +160,7 @@ internal struct JSONParser {
 
     // MARK: - Object parsing -
 
-    mutating func parseObject() throws -> [String: JSONValue] {
+    mutating func parseObject() throws -> [String: Any] {
         precondition(self.reader.read() == ._openbrace)
         guard self.depth < 512 else {
             throw JSONError.tooManyNestedArraysOrDictionaries(characterIndex: self.reader.readerIndex - 1)
@@ -162,7 +180,7 @@ internal struct JSONParser {
             break
         }
 
-        var object = [String: JSONValue]()
+        var object = [String: Any]()
         object.reserveCapacity(20)
 
         while true {
@@ -198,44 +216,44 @@ internal struct JSONParser {
 extension JSONParser {
 
     struct DocumentReader {
-        let array: [UInt8]
+        let bytes: UnsafeRawBufferPointer
 
         private(set) var readerIndex: Int = 0
 
         private var readableBytes: Int {
-            self.array.endIndex - self.readerIndex
+            self.bytes.endIndex - self.readerIndex
         }
 
         var isEOF: Bool {
-            self.readerIndex >= self.array.endIndex
+            self.readerIndex >= self.bytes.endIndex
         }
 
 
-        init(array: [UInt8]) {
-            self.array = array
+        init(bytes: UnsafeRawBufferPointer) {
+            self.bytes = bytes
         }
 
-        subscript<R: RangeExpression<Int>>(bounds: R) -> ArraySlice<UInt8> {
-            self.array[bounds]
+        subscript<R: RangeExpression<Int>>(bounds: R) -> Slice<UnsafeRawBufferPointer> {
+            self.bytes[bounds]
         }
 
         mutating func read() -> UInt8? {
-            guard self.readerIndex < self.array.endIndex else {
-                self.readerIndex = self.array.endIndex
+            guard self.readerIndex < self.bytes.endIndex else {
+                self.readerIndex = self.bytes.endIndex
                 return nil
             }
 
             defer { self.readerIndex += 1 }
 
-            return self.array[self.readerIndex]
+            return self.bytes[self.readerIndex]
         }
 
         func peek(offset: Int = 0) -> UInt8? {
-            guard self.readerIndex + offset < self.array.endIndex else {
+            guard self.readerIndex + offset < self.bytes.endIndex else {
                 return nil
             }
 
-            return self.array[self.readerIndex + offset]
+            return self.bytes[self.readerIndex + offset]
         }
 
         mutating func moveReaderIndex(forwardBy offset: Int) {
@@ -263,8 +281,12 @@ extension JSONParser {
             try self.readUTF8StringTillNextUnescapedQuote()
         }
 
-        mutating func readNumber() throws -> String {
-            try self.parseNumber()
+        mutating func readNumber() throws -> NSNumber {
+            let bytes = try self.parseNumber()
+            guard let number = NSNumber.fromJSONNumber(bytes) else {
+                throw JSONError.numberIsNotRepresentableInSwift(parsed: String(decoding: bytes, as: Unicode.UTF8.self))
+            }
+            return number
         }
 
         mutating func readBool() throws -> Bool {
@@ -393,9 +415,9 @@ extension JSONParser {
         }
 
         private func makeString<R: RangeExpression<Int>>(at range: R) throws -> String {
-            let raw = array[range]
-            guard let str = String(bytes: raw, encoding: .utf8) else {
-                throw JSONError.invalidUTF8Sequence(Data(raw), characterIndex: range.relative(to: array).lowerBound)
+            let raw = bytes[range]
+            guard let str = String(validating: raw, as: Unicode.UTF8.self) else {
+                throw JSONError.invalidUTF8Sequence(Data(raw), characterIndex: range.relative(to: bytes).lowerBound)
             }
             return str
         }
@@ -521,7 +543,7 @@ extension JSONParser {
             case expOperator
         }
 
-        private mutating func parseNumber() throws -> String {
+        private mutating func parseNumber() throws -> Slice<UnsafeRawBufferPointer> {
             var pastControlChar: ControlCharacter = .operand
             var numbersSinceControlChar: UInt = 0
             var hasLeadingZero = false
@@ -603,7 +625,7 @@ extension JSONParser {
                     let numberStartIndex = self.readerIndex
                     self.moveReaderIndex(forwardBy: numberchars)
 
-                    return String(decoding: self[numberStartIndex ..< self.readerIndex], as: Unicode.UTF8.self)
+                    return self[numberStartIndex ..< self.readerIndex]
                 default:
                     throw JSONError.unexpectedCharacter(ascii: byte, characterIndex: readerIndex + numberchars)
                 }
@@ -613,8 +635,8 @@ extension JSONParser {
                 throw JSONError.unexpectedEndOfFile
             }
 
-            defer { self.readerIndex = self.array.endIndex }
-            return String(decoding: self.array.suffix(from: readerIndex), as: Unicode.UTF8.self)
+            defer { self.readerIndex = self.bytes.endIndex }
+            return self.bytes[readerIndex...]
         }
     }
 }
@@ -663,3 +685,33 @@ enum JSONError: Swift.Error, Equatable {
     case singleFragmentFoundButNotAllowed
     case invalidUTF8Sequence(Data, characterIndex: Int)
 }
+
+extension JSONError {
+    /// Returns this error with every character index moved forward by `offset`,
+    /// for values that were parsed out of a larger stream.
+    func offset(by offset: Int) -> JSONError {
+        guard offset != 0 else { return self }
+        switch self {
+        case .unexpectedCharacter(let ascii, let characterIndex):
+            return .unexpectedCharacter(ascii: ascii, characterIndex: characterIndex + offset)
+        case .tooManyNestedArraysOrDictionaries(let characterIndex):
+            return .tooManyNestedArraysOrDictionaries(characterIndex: characterIndex + offset)
+        case .invalidHexDigitSequence(let string, let index):
+            return .invalidHexDigitSequence(string, index: index + offset)
+        case .unexpectedEscapedCharacter(let ascii, let string, let index):
+            return .unexpectedEscapedCharacter(ascii: ascii, in: string, index: index + offset)
+        case .unescapedControlCharacterInString(let ascii, let string, let index):
+            return .unescapedControlCharacterInString(ascii: ascii, in: string, index: index + offset)
+        case .expectedLowSurrogateUTF8SequenceAfterHighSurrogate(let string, let index):
+            return .expectedLowSurrogateUTF8SequenceAfterHighSurrogate(in: string, index: index + offset)
+        case .couldNotCreateUnicodeScalarFromUInt32(let string, let index, let unicodeScalarValue):
+            return .couldNotCreateUnicodeScalarFromUInt32(in: string, index: index + offset, unicodeScalarValue: unicodeScalarValue)
+        case .numberWithLeadingZero(let index):
+            return .numberWithLeadingZero(index: index + offset)
+        case .invalidUTF8Sequence(let data, let characterIndex):
+            return .invalidUTF8Sequence(data, characterIndex: characterIndex + offset)
+        case .cannotConvertInputDataToUTF8, .unexpectedEndOfFile, .numberIsNotRepresentableInSwift, .singleFragmentFoundButNotAllowed:
+            return self
+        }
+    }
+}
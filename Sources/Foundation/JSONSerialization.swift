@@ -146,17 +146,8 @@ open class JSONSerialization : NSObject {
     
     /* Generate JSON data from a Foundation object. If the object will not produce valid JSON then an exception will be thrown. Setting the NSJSONWritingPrettyPrinted option will generate JSON with whitespace designed to make the output more readable. If that option is not set, the most compact possible JSON will be generated. If an error occurs, the error parameter will be set and the return value will be nil. The resulting data is a encoded in UTF-8.
      */
-    internal class func _data(withJSONObject value: Any, options opt: WritingOptions, stream: Bool) throws -> Data {
-        var jsonStr = [UInt8]()
-        
-        var writer = JSONWriter(
-            options: opt,
-            writer: { (str: String?) in
-                if let str = str {
-                    jsonStr.append(contentsOf: str.utf8)
-                }
-            }
-        )
+    fileprivate class func _serialize(_ value: Any, options opt: WritingOptions, to output: JSONOutputBuffer) throws {
+        var writer = JSONWriter(options: opt, output: output)
         
         if let container = value as? NSArray {
             try writer.serializeJSON(container._bridgeToSwift())
@@ -173,12 +164,13 @@ open class JSONSerialization : NSObject {
             try writer.serializeJSON(value)
         }
 
-        let count = jsonStr.count
-        return Data(bytes: &jsonStr, count: count)
+        try output.flush()
     }
 
     open class func data(withJSONObject value: Any, options opt: WritingOptions = []) throws -> Data {
-        return try _data(withJSONObject: value, options: opt, stream: false)
+        let output = JSONOutputBuffer()
+        try _serialize(value, options: opt, to: output)
+        return Data(output.bytes)
     }
     
     /* Create a Foundation object from JSON data. Set the NSJSONReadingAllowFragments option if the parser should allow top-level objects that are not an NSArray or NSDictionary. Setting the NSJSONReadingMutableContainers option will make the parser generate mutable NSArrays and NSDictionaries. Setting the NSJSONReadingMutableLeaves option will make the parser generate mutable NSString objects. If an error occurs during the parse, then the error parameter will be set and the result will be nil.
@@ -186,88 +178,26 @@ open class JSONSerialization : NSObject {
      */
     open class func jsonObject(with data: Data, options opt: ReadingOptions = []) throws -> Any {
         do {
-            let jsonValue = try data.withUnsafeBytes { (ptr) -> JSONValue in
+            return try data.withUnsafeBytes { (ptr) -> Any in
                 let (encoding, advanceBy) = JSONSerialization.detectEncoding(ptr)
                 
                 if encoding == .utf8 {
-                    // we got utf8... happy path
-                    var parser = JSONParser(bytes: Array(ptr[advanceBy..<ptr.count]))
+                    // we got utf8... happy path, parse the bytes in place
+                    var parser = JSONParser(bytes: UnsafeRawBufferPointer(rebasing: ptr[advanceBy..<ptr.count]), options: opt)
                     return try parser.parse()
                 }
                 
-                guard let utf8String = String(bytes: ptr[advanceBy..<ptr.count], encoding: encoding) else {
+                guard var utf8String = String(bytes: ptr[advanceBy..<ptr.count], encoding: encoding) else {
                     throw JSONError.cannotConvertInputDataToUTF8
                 }
                 
-                var parser = JSONParser(bytes: Array(utf8String.utf8))
-                return try parser.parse()
-            }
-            
-            if jsonValue.isValue, !opt.contains(.fragmentsAllowed) {
-                throw JSONError.singleFragmentFoundButNotAllowed
+                return try utf8String.withUTF8 { utf8 in
+                    var parser = JSONParser(bytes: UnsafeRawBufferPointer(utf8), options: opt)
+                    return try parser.parse()
+                }
             }
-            
-            return try jsonValue.toObjcRepresentation(options: opt)
         } catch let error as JSONError {
-            switch error {
-            case .cannotConvertInputDataToUTF8:
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "Cannot convert input string to valid utf8 input."
-                ])
-            case .unexpectedEndOfFile:
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "Unexpected end of file during JSON parse."
-                ])
-            case .unexpectedCharacter(_, let characterIndex):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "Invalid value around character \(characterIndex)."
-                ])
-            case .expectedLowSurrogateUTF8SequenceAfterHighSurrogate:
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "Unexpected end of file during string parse (expected low-surrogate code point but did not find one)."
-                ])
-            case .couldNotCreateUnicodeScalarFromUInt32:
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "Unable to convert hex escape sequence (no high character) to UTF8-encoded character."
-                ])
-            case .unexpectedEscapedCharacter(_, _, let index):
-                // we lower the failure index by one to match the darwin implementations counting
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "Invalid escape sequence around character \(index - 1)."
-                ])
-            case .singleFragmentFoundButNotAllowed:
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "JSON text did not start with array or object and option to allow fragments not set."
-                ])
-            case .tooManyNestedArraysOrDictionaries(characterIndex: let characterIndex):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : "Too many nested arrays or dictionaries around character \(characterIndex + 1)."
-                ])
-            case .invalidHexDigitSequence(let string, index: let index):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : #"Invalid hex encoded sequence in "\#(string)" at \#(index)."#
-                ])
-            case .unescapedControlCharacterInString(ascii: let ascii, in: _, index: let index) where ascii == UInt8(ascii: "\\"):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : #"Invalid escape sequence around character \#(index)."#
-                ])
-            case .unescapedControlCharacterInString(ascii: _, in: _, index: let index):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : #"Unescaped control character around character \#(index)."#
-                ])
-            case .numberWithLeadingZero(index: let index):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : #"Number with leading zero around character \#(index)."#
-                ])
-            case .numberIsNotRepresentableInSwift(parsed: let parsed):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : #"Number \#(parsed) is not representable in Swift."#
-                ])
-            case .invalidUTF8Sequence(let data, characterIndex: let index):
-                throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
-                    NSDebugDescriptionErrorKey : #"Invalid UTF-8 sequence \#(data) starting from character \#(index)."#
-                ])
-            }
+            throw error._nsError
         } catch {
             preconditionFailure("Only `JSONError` expected")
         }
@@ -276,15 +206,38 @@ open class JSONSerialization : NSObject {
     
 #if !os(WASI)
     /* Write JSON data into a stream. The stream should be opened and configured. The return value is the number of bytes written to the stream, or 0 on error. All other behavior of this method is the same as the dataWithJSONObject:options:error: method.
+       If the object cannot be serialized, nothing is written to the stream. If the stream stops accepting bytes part way through, what was written before then stays on the stream.
      */
     open class func writeJSONObject(_ obj: Any, toStream stream: OutputStream, options opt: WritingOptions) throws -> Int {
-        let jsonData = try _data(withJSONObject: obj, options: opt, stream: true)
-        return jsonData.withUnsafeBytes { (rawBuffer: UnsafeRawBufferPointer) -> Int in
-            let ptr = rawBuffer.baseAddress!.assumingMemoryBound(to: UInt8.self)
-            let res: Int = stream.write(ptr, maxLength: rawBuffer.count)
-            /// TODO: If the result here is negative the error should be obtained from the stream to propagate as a throw
-            return res
+        // The document is written out in blocks while it is being generated,
+        // so it never has to be held in memory as a whole. Documents that need
+        // more than one block are checked first, so that an invalid one does not
+        // leave part of itself on the stream; those that fail the check are
+        // held in memory until the writer has reported its error.
+        var written = 0
+        var failure: Int?
+        let output = JSONOutputBuffer(sink: { bytes in
+            var offset = 0
+            while offset < bytes.count {
+                let res = stream.write(bytes.baseAddress!.advanced(by: offset).assumingMemoryBound(to: UInt8.self), maxLength: bytes.count - offset)
+                guard res > 0 else {
+                    /// TODO: If the result here is negative the error should be obtained from the stream to propagate as a throw
+                    failure = res
+                    throw JSONOutputBuffer.SinkFull()
+                }
+                offset += res
+                written += res
+            }
+        }, canFlushEarly: { JSONSerialization.isValidJSONObject(obj) })
+        do {
+            try _serialize(obj, options: opt, to: output)
+        } catch is JSONOutputBuffer.SinkFull {
+            // The stream stopped accepting bytes; report what was written, or its error.
+            if let failure = failure, failure < 0 {
+                return failure
+            }
         }
+        return written
     }
     
     /* Create a JSON object from JSON data stream. The stream should be opened and configured. All other behavior of this method is the same as the JSONObjectWithData:options:error: method.
@@ -306,9 +259,291 @@ open class JSONSerialization : NSObject {
         } while stream.hasBytesAvailable
         return try jsonObject(with: data, options: opt)
     }
+
+    /* Read a sequence of JSON texts, such as newline-delimited JSON, from a stream and call the block with each top-level value as soon as it has been read. Set the block's stop argument to true to stop reading. The stream should be opened and configured, and must contain UTF-8. Only the value currently being read is held in memory, so arbitrarily long streams can be read; see `JSONSerialization.IncrementalParser`.
+     */
+    open class func enumerateJSONObjects(with stream: InputStream, options opt: ReadingOptions = [], using block: (Any, inout Bool) throws -> Void) throws {
+        guard stream.streamStatus == .open || stream.streamStatus == .reading else {
+            fatalError("Stream is not available for reading")
+        }
+        var parser = IncrementalParser(options: opt)
+        var stop = false
+
+        let bufferSize = 64 * 1024
+        let buffer = UnsafeMutableRawBufferPointer.allocate(byteCount: bufferSize, alignment: 1)
+        defer { buffer.deallocate() }
+
+        while !stop {
+            let bytesRead = stream.read(buffer.baseAddress!.assumingMemoryBound(to: UInt8.self), maxLength: bufferSize)
+            guard bytesRead >= 0 else {
+                throw stream.streamError!
+            }
+            let values = bytesRead == 0 ? try parser.finish() : try parser.parse(UnsafeRawBufferPointer(rebasing: buffer[..<bytesRead]))
+            for value in values {
+                try block(value, &stop)
+                if stop {
+                    break
+                }
+            }
+            if bytesRead == 0 {
+                break
+            }
+        }
+    }
 #endif
 }
 
+//MARK: - Incremental Parsing
+
+extension JSONSerialization {
+    /* A push parser for a sequence of JSON texts that arrives in pieces, such as newline-delimited JSON (NDJSON) or JSON texts that are simply concatenated with optional whitespace between them.
+       Pass the input to `parse(_:)` in chunks of any size as it arrives; each call returns the top-level values completed by that chunk, in order. Call `finish()` once the input has ended, to get a trailing top-level number or literal and to detect truncated input.
+       The parser only finds where each top-level value ends as the bytes go by, and parses a value once it is complete. Only the bytes of the value being read are kept between calls, so memory use is proportional to the largest single value rather than to the whole input.
+       The input must be UTF-8; a leading byte order mark is skipped, even if it is split across chunks. Top-level values that are not arrays or objects are only accepted with the `.fragmentsAllowed` option. Errors report character indexes relative to the start of the input. Once an error has been thrown the parser should not be used again.
+     */
+    public struct IncrementalParser {
+        private enum State {
+            case betweenValues
+            /// Inside an array or object, `depth` levels deep.
+            case container(depth: Int)
+            /// Inside a string, `depth` levels deep; zero for a top-level string.
+            case string(depth: Int, escaped: Bool)
+            /// Inside a top-level number, `true`, `false` or `null`, which only ends at whitespace or the end of the input.
+            case scalar
+        }
+
+        public let options: ReadingOptions
+
+        private var state = State.betweenValues
+        /// The start of the value being read, from the chunks before the current one.
+        private var pending: [UInt8] = []
+        /// The number of input bytes before the current chunk.
+        private var consumed = 0
+        /// The index in the input of the first byte of the value being read.
+        private var valueStart = 0
+        /// The first bytes of the input, held back until there are enough of them to
+        /// tell whether they are a byte order mark; `nil` once that is known.
+        private var leadingBytes: [UInt8]? = []
+
+        public init(options: ReadingOptions = []) {
+            self.options = options
+        }
+
+        public mutating func parse(_ data: Data) throws -> [Any] {
+            return try data.withUnsafeBytes { try self.parse($0) }
+        }
+
+        public mutating func parse(_ bytes: UnsafeRawBufferPointer) throws -> [Any] {
+            do {
+                guard var leading = leadingBytes else {
+                    return try _parse(bytes)
+                }
+                if leading.isEmpty && bytes.count >= 3 {
+                    leadingBytes = nil
+                    return try _parseSkippingByteOrderMark(bytes)
+                }
+                leading.append(contentsOf: bytes)
+                guard leading.count >= 3 else {
+                    leadingBytes = leading
+                    return []
+                }
+                leadingBytes = nil
+                return try leading.withUnsafeBytes { try self._parseSkippingByteOrderMark($0) }
+            } catch let error as JSONError {
+                throw error._nsError
+            }
+        }
+
+        public mutating func finish() throws -> [Any] {
+            do {
+                var values: [Any] = []
+                if let leading = leadingBytes {
+                    // Too short to be a byte order mark.
+                    leadingBytes = nil
+                    values = try leading.withUnsafeBytes { try self._parse($0) }
+                }
+                switch state {
+                case .betweenValues:
+                    return values
+                case .scalar:
+                    return values + [try completeValue(UnsafeRawBufferPointer(start: nil, count: 0)[...])]
+                case .container, .string:
+                    throw JSONError.unexpectedEndOfFile
+                }
+            } catch let error as JSONError {
+                throw error._nsError
+            }
+        }
+
+        private mutating func _parseSkippingByteOrderMark(_ bytes: UnsafeRawBufferPointer) throws -> [Any] {
+            // UTF-8 byte order mark
+            guard bytes.starts(with: [0xEF, 0xBB, 0xBF]) else {
+                return try _parse(bytes)
+            }
+            consumed = 3
+            return try _parse(UnsafeRawBufferPointer(rebasing: bytes[3...]))
+        }
+
+        private mutating func _parse(_ bytes: UnsafeRawBufferPointer) throws -> [Any] {
+            var values: [Any] = []
+            // A value that is still open started at the beginning of this chunk.
+            var start = 0
+            var index = 0
+
+            while index < bytes.count {
+                let byte = bytes[index]
+                switch state {
+                case .betweenValues:
+                    switch byte {
+                    case ._space, ._return, ._newline, ._tab:
+                        break
+                    case ._openbrace, ._openbracket:
+                        start = index
+                        valueStart = consumed + index
+                        state = .container(depth: 1)
+                    case ._quote:
+                        start = index
+                        valueStart = consumed + index
+                        state = .string(depth: 0, escaped: false)
+                    case UInt8(ascii: "-"), UInt8(ascii: "0") ... UInt8(ascii: "9"), UInt8(ascii: "t"), UInt8(ascii: "f"), UInt8(ascii: "n"):
+                        start = index
+                        valueStart = consumed + index
+                        state = .scalar
+                    default:
+                        throw JSONError.unexpectedCharacter(ascii: byte, characterIndex: consumed + index)
+                    }
+                case .container(let depth):
+                    switch byte {
+                    case ._quote:
+                        state = .string(depth: depth, escaped: false)
+                    case ._openbrace, ._openbracket:
+                        state = .container(depth: depth + 1)
+                    case ._closebrace, ._closebracket:
+                        if depth == 1 {
+                            values.append(try completeValue(bytes[start ... index]))
+                        } else {
+                            state = .container(depth: depth - 1)
+                        }
+                    default:
+                        break
+                    }
+                case .string(let depth, true):
+                    state = .string(depth: depth, escaped: false)
+                case .string(let depth, false):
+                    if byte == ._backslash {
+                        state = .string(depth: depth, escaped: true)
+                    } else if byte == ._quote {
+                        if depth == 0 {
+                            values.append(try completeValue(bytes[start ... index]))
+                        } else {
+                            state = .container(depth: depth)
+                        }
+                    }
+                case .scalar:
+                    switch byte {
+                    case ._space, ._return, ._newline, ._tab:
+                        values.append(try completeValue(bytes[start ..< index]))
+                    default:
+                        break
+                    }
+                }
+                index += 1
+            }
+
+            if case .betweenValues = state {
+            } else {
+                pending.append(contentsOf: bytes[start...])
+            }
+            consumed += bytes.count
+            return values
+        }
+
+        private mutating func completeValue(_ tail: Slice<UnsafeRawBufferPointer>) throws -> Any {
+            pending.append(contentsOf: tail)
+            defer {
+                // Keep the capacity, so that reading a stream of similar values
+                // does not reallocate for every one of them.
+                pending.removeAll(keepingCapacity: true)
+                state = .betweenValues
+            }
+
+            do {
+                return try pending.withUnsafeBytes { bytes in
+                    var parser = JSONParser(bytes: bytes, options: options)
+                    return try parser.parse()
+                }
+            } catch let error as JSONError {
+                throw error.offset(by: valueStart)
+            }
+        }
+    }
+}
+
+extension JSONError {
+    /// The error `JSONSerialization` reports for this parse failure.
+    var _nsError: NSError {
+        switch self {
+        case .cannotConvertInputDataToUTF8:
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "Cannot convert input string to valid utf8 input."
+            ])
+        case .unexpectedEndOfFile:
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "Unexpected end of file during JSON parse."
+            ])
+        case .unexpectedCharacter(_, let characterIndex):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "Invalid value around character \(characterIndex)."
+            ])
+        case .expectedLowSurrogateUTF8SequenceAfterHighSurrogate:
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "Unexpected end of file during string parse (expected low-surrogate code point but did not find one)."
+            ])
+        case .couldNotCreateUnicodeScalarFromUInt32:
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "Unable to convert hex escape sequence (no high character) to UTF8-encoded character."
+            ])
+        case .unexpectedEscapedCharacter(_, _, let index):
+            // we lower the failure index by one to match the darwin implementations counting
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "Invalid escape sequence around character \(index - 1)."
+            ])
+        case .singleFragmentFoundButNotAllowed:
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "JSON text did not start with array or object and option to allow fragments not set."
+            ])
+        case .tooManyNestedArraysOrDictionaries(characterIndex: let characterIndex):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : "Too many nested arrays or dictionaries around character \(characterIndex + 1)."
+            ])
+        case .invalidHexDigitSequence(let string, index: let index):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : #"Invalid hex encoded sequence in "\#(string)" at \#(index)."#
+            ])
+        case .unescapedControlCharacterInString(ascii: let ascii, in: _, index: let index) where ascii == UInt8(ascii: "\\"):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : #"Invalid escape sequence around character \#(index)."#
+            ])
+        case .unescapedControlCharacterInString(ascii: _, in: _, index: let index):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : #"Unescaped control character around character \#(index)."#
+            ])
+        case .numberWithLeadingZero(index: let index):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : #"Number with leading zero around character \#(index)."#
+            ])
+        case .numberIsNotRepresentableInSwift(parsed: let parsed):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : #"Number \#(parsed) is not representable in Swift."#
+            ])
+        case .invalidUTF8Sequence(let data, characterIndex: let index):
+            return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+                NSDebugDescriptionErrorKey : #"Invalid UTF-8 sequence \#(data) starting from character \#(index)."#
+            ])
+        }
+    }
+}
+
 //MARK: - Encoding Detection
 
 private extension JSONSerialization {
@@ -382,19 +617,82 @@ private extension JSONSerialization {
 }
 
 //MARK: - JSONSerializer
+
+/// The bytes `JSONWriter` produces. Without a sink the whole document collects
+/// in `bytes`. With one, `flushIfNeeded()` hands the bytes to the sink in blocks
+/// of about `blockSize`, and the buffer is reused, so memory use stays bounded
+/// by the block size and the longest single string.
+private final class JSONOutputBuffer {
+    /// Thrown by a sink that cannot take any more bytes, to stop serialization.
+    struct SinkFull : Error {}
+
+    static let blockSize = 64 * 1024
+
+    private(set) var bytes: [UInt8] = []
+    private let sink: ((UnsafeRawBufferPointer) throws -> Void)?
+    /// Asked once, before the first block is handed to the sink, whether blocks may
+    /// be handed over before the document is complete. If not, everything is held
+    /// until the final `flush`.
+    private var canFlushEarly: (() -> Bool)?
+    private var flushesEarly = true
+
+    init(sink: ((UnsafeRawBufferPointer) throws -> Void)? = nil, canFlushEarly: (() -> Bool)? = nil) {
+        self.sink = sink
+        self.canFlushEarly = canFlushEarly
+        if sink != nil {
+            bytes.reserveCapacity(JSONOutputBuffer.blockSize * 2)
+        }
+    }
+
+    func write(_ byte: UInt8) {
+        bytes.append(byte)
+    }
+
+    func write(_ string: String) {
+        if string.utf8.withContiguousStorageIfAvailable({ bytes.append(contentsOf: $0) }) == nil {
+            bytes.append(contentsOf: string.utf8)
+        }
+    }
+
+    func write(_ run: UnsafeBufferPointer<UInt8>) {
+        bytes.append(contentsOf: run)
+    }
+
+    func flushIfNeeded() throws {
+        guard sink != nil, bytes.count >= JSONOutputBuffer.blockSize else {
+            return
+        }
+        if let canFlushEarly = canFlushEarly {
+            flushesEarly = canFlushEarly()
+            self.canFlushEarly = nil
+        }
+        if flushesEarly {
+            try flush()
+        }
+    }
+
+    func flush() throws {
+        guard let sink = sink, !bytes.isEmpty else {
+            return
+        }
+        try bytes.withUnsafeBytes { try sink($0) }
+        bytes.removeAll(keepingCapacity: true)
+    }
+}
+
 private struct JSONWriter {
 
     var indent = 0
     let pretty: Bool
     let sortedKeys: Bool
     let withoutEscapingSlashes: Bool
-    let writer: (String?) -> Void
+    let output: JSONOutputBuffer
 
-    init(options: JSONSerialization.WritingOptions, writer: @escaping (String?) -> Void) {
+    init(options: JSONSerialization.WritingOptions, output: JSONOutputBuffer) {
         pretty = options.contains(.prettyPrinted)
         sortedKeys = options.contains(.sortedKeys)
         withoutEscapingSlashes = options.contains(.withoutEscapingSlashes)
-        self.writer = writer
+        self.output = output
     }
     
     mutating func serializeJSON(_ object: Any?) throws {
@@ -415,27 +713,27 @@ private struct JSONWriter {
         case let str as String:
             try serializeString(str)
         case let boolValue as Bool:
-            writer(boolValue.description)
+            output.write(boolValue.description)
         case let num as Int:
-            writer(num.description)
+            output.write(num.description)
         case let num as Int8:
-            writer(num.description)
+            output.write(num.description)
         case let num as Int16:
-            writer(num.description)
+            output.write(num.description)
         case let num as Int32:
-            writer(num.description)
+            output.write(num.description)
         case let num as Int64:
-            writer(num.description)
+            output.write(num.description)
         case let num as UInt:
-            writer(num.description)
+            output.write(num.description)
         case let num as UInt8:
-            writer(num.description)
+            output.write(num.description)
         case let num as UInt16:
-            writer(num.description)
+            output.write(num.description)
         case let num as UInt32:
-            writer(num.description)
+            output.write(num.description)
         case let num as UInt64:
-            writer(num.description)
+            output.write(num.description)
         case let array as Array<Any?>:
             try serializeArray(array)
         case let dict as Dictionary<AnyHashable, Any?>:
@@ -445,49 +743,89 @@ private struct JSONWriter {
         case let num as Double:
             try serializeFloat(num)
         case let num as Decimal:
-            writer(num.description)
+            output.write(num.description)
         case let num as NSDecimalNumber:
-            writer(num.description)
+            output.write(num.description)
         case is NSNull:
             try serializeNull()
         case _ where __SwiftValue.store(obj) is NSNumber:
             let num = __SwiftValue.store(obj) as! NSNumber
-            writer(num.description)
+            output.write(num.description)
         default:
             throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [NSDebugDescriptionErrorKey : "Invalid object cannot be serialized"])
         }
     }
 
     func serializeString(_ str: String) throws {
-        writer("\"")
-        for scalar in str.unicodeScalars {
-            switch scalar {
-                case "\"":
-                    writer("\\\"") // U+0022 quotation mark
-                case "\\":
-                    writer("\\\\") // U+005C reverse solidus
-                case "/":
-                    if !withoutEscapingSlashes { writer("\\") }
-                    writer("/") // U+002F solidus
-                case "\u{8}":
-                    writer("\\b") // U+0008 backspace
-                case "\u{c}":
-                    writer("\\f") // U+000C form feed
-                case "\n":
-                    writer("\\n") // U+000A line feed
-                case "\r":
-                    writer("\\r") // U+000D carriage return
-                case "\t":
-                    writer("\\t") // U+0009 tab
-                case "\u{0}"..."\u{f}":
-                    writer("\\u000\(String(scalar.value, radix: 16))") // U+0000 to U+000F
-                case "\u{10}"..."\u{1f}":
-                    writer("\\u00\(String(scalar.value, radix: 16))") // U+0010 to U+001F
-                default:
-                    writer(String(scalar))
+        output.write(._quote)
+        var str = str
+        try str.withUTF8 { try serializeEscaped($0) }
+        output.write(._quote)
+    }
+
+    /// Copies runs of characters that need no escaping in bulk, finding the
+    /// end of each run eight bytes at a time.
+    private func serializeEscaped(_ utf8: UnsafeBufferPointer<UInt8>) throws {
+        let raw = UnsafeRawBufferPointer(utf8)
+        var runStart = 0
+        var index = 0
+        while index < utf8.count {
+            while index + 8 <= utf8.count, !needsEscaping(raw.loadUnaligned(fromByteOffset: index, as: UInt64.self)) {
+                index += 8
+            }
+            guard index < utf8.count else {
+                break
             }
+
+            let byte = utf8[index]
+            let escape: String
+            switch byte {
+            case ._quote:
+                escape = "\\\"" // U+0022 quotation mark
+            case ._backslash:
+                escape = "\\\\" // U+005C reverse solidus
+            case UInt8(ascii: "/") where !withoutEscapingSlashes:
+                escape = "\\/" // U+002F solidus
+            case 0x08:
+                escape = "\\b" // U+0008 backspace
+            case 0x0C:
+                escape = "\\f" // U+000C form feed
+            case ._newline:
+                escape = "\\n" // U+000A line feed
+            case ._return:
+                escape = "\\r" // U+000D carriage return
+            case ._tab:
+                escape = "\\t" // U+0009 tab
+            case 0x00 ..< 0x20:
+                escape = (byte < 0x10 ? "\\u000" : "\\u00") + String(byte, radix: 16) // U+0000 to U+001F
+            default:
+                index += 1
+                continue
+            }
+
+            output.write(UnsafeBufferPointer(rebasing: utf8[runStart ..< index]))
+            output.write(escape)
+            index += 1
+            runStart = index
+        }
+        output.write(UnsafeBufferPointer(rebasing: utf8[runStart ..< utf8.count]))
+        try output.flushIfNeeded()
+    }
+
+    /// Whether any of the eight bytes in `word` is a quotation mark, a reverse
+    /// solidus, a control character or, unless they are left alone, a solidus.
+    /// Bytes of multi-byte UTF-8 sequences never match.
+    private func needsEscaping(_ word: UInt64) -> Bool {
+        let ones: UInt64 = 0x0101_0101_0101_0101
+        let highBits: UInt64 = 0x8080_8080_8080_8080
+        func hasZeroByte(_ x: UInt64) -> Bool {
+            return (x &- ones) & ~x & highBits != 0
+        }
+        let hasControlCharacter = (word &- ones &* 0x20) & ~word & highBits != 0
+        if hasControlCharacter || hasZeroByte(word ^ (ones &* 0x22)) || hasZeroByte(word ^ (ones &* 0x5C)) {
+            return true
         }
-        writer("\"")
+        return !withoutEscapingSlashes && hasZeroByte(word ^ (ones &* 0x2F))
     }
 
     private func serializeFloat<T: FloatingPoint & LosslessStringConvertible>(_ num: T) throws {
@@ -498,7 +836,7 @@ private struct JSONWriter {
         if str.hasSuffix(".0") {
             str.removeLast(2)
         }
-        writer(str)
+        output.write(str)
     }
 
     mutating func serializeNumber(_ num: NSNumber) throws {
@@ -507,17 +845,17 @@ private struct JSONWriter {
         } else {
             switch num._cfTypeID {
             case CFBooleanGetTypeID():
-                writer(num.boolValue.description)
+                output.write(num.boolValue.description)
             default:
-                writer(num.stringValue)
+                output.write(num.stringValue)
             }
         }
     }
 
     mutating func serializeArray(_ array: [Any?]) throws {
-        writer("[")
+        output.write("[")
         if pretty {
-            writer("\n")
+            output.write("\n")
             incIndent()
         }
         
@@ -526,26 +864,27 @@ private struct JSONWriter {
             if first {
                 first = false
             } else if pretty {
-                writer(",\n")
+                output.write(",\n")
             } else {
-                writer(",")
+                output.write(",")
             }
             if pretty {
                 writeIndent()
             }
             try serializeJSON(elem)
+            try output.flushIfNeeded()
         }
         if pretty {
-            writer("\n")
+            output.write("\n")
             decAndWriteIndent()
         }
-        writer("]")
+        output.write("]")
     }
 
     mutating func serializeDictionary(_ dict: Dictionary<AnyHashable, Any?>) throws {
-        writer("{")
+        output.write("{")
         if pretty {
-            writer("\n")
+            output.write("\n")
             incIndent()
             if dict.count > 0 {
                 writeIndent()
@@ -558,10 +897,10 @@ private struct JSONWriter {
             if first {
                 first = false
             } else if pretty {
-                writer(",\n")
+                output.write(",\n")
                 writeIndent()
             } else {
-                writer(",")
+                output.write(",")
             }
 
             if let key = key as? String {
@@ -569,8 +908,9 @@ private struct JSONWriter {
             } else {
                 throw NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [NSDebugDescriptionErrorKey : "NSDictionary key must be NSString"])
             }
-            pretty ? writer(" : ") : writer(":")
+            pretty ? output.write(" : ") : output.write(":")
             try serializeJSON(value)
+            try output.flushIfNeeded()
         }
 
         if sortedKeys {
@@ -595,14 +935,14 @@ private struct JSONWriter {
         }
 
         if pretty {
-            writer("\n")
+            output.write("\n")
             decAndWriteIndent()
         }
-        writer("}")
+        output.write("}")
     }
 
     func serializeNull() throws {
-        writer("null")
+        output.write("null")
     }
     
     let indentAmount = 2
@@ -623,124 +963,76 @@ private struct JSONWriter {
     
     func writeIndent() {
         for _ in 0..<indent {
-            writer(" ")
+            output.write(" ")
         }
     }
 
 }
 
-enum JSONValue: Equatable {
-    case string(String)
-    case number(String)
-    case bool(Bool)
-    case null
-
-    case array([JSONValue])
-    case object([String: JSONValue])
-}
-
-extension JSONValue {
-    var isValue: Bool {
-        switch self {
-        case .array, .object:
-            return false
-        case .null, .number, .string, .bool:
-            return true
-        }
-    }
-    
-    var isContainer: Bool {
-        switch self {
-        case .array, .object:
-            return true
-        case .null, .number, .string, .bool:
-            return false
-        }
-    }
-}
+extension NSNumber {
+    /// Converts a number that `JSONParser` has already validated straight from its bytes.
+    static func fromJSONNumber(_ bytes: Slice<UnsafeRawBufferPointer>) -> NSNumber? {
+        var isNegative = false
+        var isInteger = true
+        // The length of everything before the exponent, sign and decimal point included.
+        var digitCount = 0
+        var magnitude: UInt64 = 0
+        var overflow = false
+        var inExponent = false
+        var isNegativeExponent = false
+        var exp = 0
 
-extension JSONValue {
-    var debugDataTypeDescription: String {
-        switch self {
-        case .array:
-            return "an array"
-        case .bool:
-            return "bool"
-        case .number:
-            return "a number"
-        case .string:
-            return "a string"
-        case .object:
-            return "a dictionary"
-        case .null:
-            return "null"
+        for byte in bytes {
+            if inExponent {
+                switch byte {
+                case UInt8(ascii: "-"):
+                    isNegativeExponent = true
+                case UInt8(ascii: "+"):
+                    break
+                default:
+                    // Saturate rather than overflow; anything this large is out of range either way.
+                    exp = min(exp * 10 + Int(byte &- UInt8(ascii: "0")), 1 << 24)
+                }
+                continue
+            }
+            switch byte {
+            case UInt8(ascii: "-"):
+                isNegative = true
+            case UInt8(ascii: "."):
+                isInteger = false
+            case UInt8(ascii: "e"), UInt8(ascii: "E"):
+                isInteger = false
+                inExponent = true
+                continue
+            default:
+                if isInteger && !overflow {
+                    let (shifted, shiftOverflow) = magnitude.multipliedReportingOverflow(by: 10)
+                    let (sum, addOverflow) = shifted.addingReportingOverflow(UInt64(byte &- UInt8(ascii: "0")))
+                    magnitude = sum
+                    overflow = shiftOverflow || addOverflow
+                }
+            }
+            digitCount += 1
         }
-    }
-}
-
-private extension JSONValue {
-    func toObjcRepresentation(options: JSONSerialization.ReadingOptions) throws -> Any {
-        switch self {
-        case .array(let values):
-            let array = try values.map { try $0.toObjcRepresentation(options: options) }
-            if !options.contains(.mutableContainers) {
-                return array
-            }
-            return NSMutableArray(array: array, copyItems: false)
-        case .object(let object):
-            let dictionary = try object.mapValues { try $0.toObjcRepresentation(options: options) }
-            if !options.contains(.mutableContainers) {
-                return dictionary
-            }
-            return NSMutableDictionary(dictionary: dictionary, copyItems: false)
-        case .bool(let bool):
-            return NSNumber(value: bool)
-        case .number(let string):
-            guard let number = NSNumber.fromJSONNumber(string) else {
-                throw JSONError.numberIsNotRepresentableInSwift(parsed: string)
-            }
-            return number
-        case .null:
-            return NSNull()
-        case .string(let string):
-            if options.contains(.mutableLeaves) {
-                return NSMutableString(string: string)
-            }
-            return string
+        if isNegativeExponent {
+            exp = -exp
         }
-    }
-}
 
-extension NSNumber {
-    static func fromJSONNumber(_ string: String) -> NSNumber? {
-        let decIndex = string.firstIndex(of: ".")
-        let expIndex = string.firstIndex(of: "e")
-        let isInteger = decIndex == nil && expIndex == nil
-        let isNegative = string.utf8[string.utf8.startIndex] == UInt8(ascii: "-")
-        let digitCount = string[string.startIndex..<(expIndex ?? string.endIndex)].count
-        
-        // Try Int64() or UInt64() first
-        if isInteger {
+        // Try Int64 or UInt64 first
+        if isInteger && !overflow {
             if isNegative {
-                if digitCount <= 19, let intValue = Int64(string) {
-                    return NSNumber(value: intValue)
+                if digitCount <= 19 {
+                    return NSNumber(value: -Int64(magnitude))
                 }
             } else {
-                if digitCount <= 20, let uintValue = UInt64(string) {
-                    return NSNumber(value: uintValue)
+                if digitCount <= 20 {
+                    return NSNumber(value: magnitude)
                 }
             }
         }
 
-        var exp = 0
-        
-        if let expIndex = expIndex {
-            let expStartIndex = string.index(after: expIndex)
-            if let parsed = Int(string[expStartIndex...]) {
-                exp = parsed
-            }
-        }
-        
+        let string = String(decoding: bytes, as: Unicode.UTF8.self)
+
         // Decimal holds more digits of precision but a smaller exponent than Double
         // so try that if the exponent fits and there are more digits than Double can hold
         if digitCount > 17, exp >= -128, exp <= 127, let decimal = Decimal(string: string), decimal.isFinite {
@@ -966,26 +966,29 @@ open class NSMutableArray : NSArray {
     }
     
     open func sort(using sortDescriptors: [NSSortDescriptor]) {
-        var descriptors = sortDescriptors._nsObject
-        withUnsafeMutablePointer(to: &descriptors) { descriptors in
-            CFArraySortValues(_cfMutableObject, CFRangeMake(0, count), { (lhsPointer, rhsPointer, context) -> CFComparisonResult in
-                let descriptors = context!.assumingMemoryBound(to: NSArray.self).pointee._swiftObject
-                
-                for item in descriptors {
-                    let descriptor = item as! NSSortDescriptor
-                    let result =
-                    descriptor.compare(__SwiftValue.fetch(Unmanaged<AnyObject>.fromOpaque(lhsPointer!).takeUnretainedValue())!,
-                                       to: __SwiftValue.fetch(Unmanaged<AnyObject>.fromOpaque(rhsPointer!).takeUnretainedValue())!)
+        // Hand the comparator a buffer it can read without bridging or
+        // retaining anything on every comparison.
+        sortDescriptors.withUnsafeBufferPointer { buffer in
+            var descriptors = buffer
+            withUnsafeMutablePointer(to: &descriptors) { descriptors in
+                CFArraySortValues(_cfMutableObject, CFRangeMake(0, count), { (lhsPointer, rhsPointer, context) -> CFComparisonResult in
+                    let descriptors = context!.assumingMemoryBound(to: UnsafeBufferPointer<NSSortDescriptor>.self).pointee
+                    let lhs = __SwiftValue.fetch(Unmanaged<AnyObject>.fromOpaque(lhsPointer!).takeUnretainedValue())!
+                    let rhs = __SwiftValue.fetch(Unmanaged<AnyObject>.fromOpaque(rhsPointer!).takeUnretainedValue())!
                     
-                    if result == .orderedAscending {
-                        return kCFCompareLessThan
-                    } else if result == .orderedDescending {
-                        return kCFCompareGreaterThan
+                    for descriptor in descriptors {
+                        let result = descriptor.compare(lhs, to: rhs)
+                        
+                        if result == .orderedAscending {
+                            return kCFCompareLessThan
+                        } else if result == .orderedDescending {
+                            return kCFCompareGreaterThan
+                        }
                     }
-                }
-                
-                return kCFCompareEqualTo
-            }, descriptors)
+                    
+                    return kCFCompareEqualTo
+                }, descriptors)
+            }
         }
     }
 }
@@ -7,49 +7,125 @@
 // See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
 //
 
-private class NSCacheEntry<KeyType : AnyObject, ObjectType : AnyObject> {
-    var key: KeyType
+internal import Synchronization
+
+fileprivate struct NSCacheKey: Hashable {
+    
+    let value: AnyObject
+    
+    // Computed once, so that looking up a key does not need to hash it again
+    // for the shard and again for the shard's dictionary.
+    let hash: Int
+    
+    init(_ value: AnyObject) {
+        self.value = value
+        if let nsObject = value as? NSObject {
+            self.hash = nsObject.hashValue
+        } else {
+            // Keys that are not NSObjects are only ever equal to themselves.
+            self.hash = ObjectIdentifier(value).hashValue
+        }
+    }
+    
+    func hash(into hasher: inout Hasher) {
+        hasher.combine(hash)
+    }
+    
+    static func ==(lhs: NSCacheKey, rhs: NSCacheKey) -> Bool {
+        if lhs.value === rhs.value {
+            return true
+        } else {
+            guard let left = lhs.value as? NSObject,
+                let right = rhs.value as? NSObject else { return false }
+            
+            return left.isEqual(right)
+        }
+    }
+}
+
+private final class NSCacheEntry<ObjectType : AnyObject> {
+    let key: NSCacheKey
     var value: ObjectType
     var cost: Int
-    var prevByCost: NSCacheEntry?
-    var nextByCost: NSCacheEntry?
-    init(key: KeyType, value: ObjectType, cost: Int) {
+    var stamp: UInt64 = 0
+    var prevByUse: NSCacheEntry?
+    var nextByUse: NSCacheEntry?
+    init(key: NSCacheKey, value: ObjectType, cost: Int) {
         self.key = key
         self.value = value
         self.cost = cost
     }
 }
 
-fileprivate class NSCacheKey: NSObject {
+// One lock-protected slice of the cache. Entries are kept in a doubly linked
+// list from least to most recently used; every entry gets a stamp from the
+// cache-wide clock when it is inserted or used, and because stamps are taken
+// under the shard's lock the list is also in stamp order.
+private final class NSCacheShard<ObjectType : AnyObject> {
+    let lock = NSLock()
+    var entries = Dictionary<NSCacheKey, NSCacheEntry<ObjectType>>()
+    var head: NSCacheEntry<ObjectType>? // least recently used
+    var tail: NSCacheEntry<ObjectType>? // most recently used
     
-    var value: AnyObject
+    // The stamp of `head`, or UInt64.max when the shard is empty. Read without
+    // the lock when picking which shard to evict from.
+    let oldestStamp = Atomic<UInt64>(.max)
     
-    init(_ value: AnyObject) {
-        self.value = value
-        super.init()
+    deinit {
+        // Entries link to each other in both directions; break the cycles.
+        removeAll()
     }
     
-    override var hash: Int {
-        switch self.value {
-        case let nsObject as NSObject:
-            return nsObject.hashValue
-        case let hashable as AnyHashable:
-            return hashable.hashValue
-        default: return 0
+    // Call with lock held.
+    func remove(_ entry: NSCacheEntry<ObjectType>) {
+        let oldPrev = entry.prevByUse
+        let oldNext = entry.nextByUse
+        
+        oldPrev?.nextByUse = oldNext
+        oldNext?.prevByUse = oldPrev
+        
+        if entry === head {
+            head = oldNext
+            oldestStamp.store(oldNext?.stamp ?? .max, ordering: .relaxed)
         }
+        if entry === tail {
+            tail = oldPrev
+        }
+        
+        entry.prevByUse = nil
+        entry.nextByUse = nil
     }
     
-    override func isEqual(_ object: Any?) -> Bool {
-        guard let other = (object as? NSCacheKey) else { return false }
+    // Call with lock held.
+    func append(_ entry: NSCacheEntry<ObjectType>, stamp: UInt64) {
+        entry.stamp = stamp
+        entry.prevByUse = tail
+        entry.nextByUse = nil
         
-        if self.value === other.value {
-            return true
+        if let tail = tail {
+            tail.nextByUse = entry
         } else {
-            guard let left = self.value as? NSObject,
-                let right = other.value as? NSObject else { return false }
+            head = entry
+            oldestStamp.store(stamp, ordering: .relaxed)
+        }
+        tail = entry
+    }
+    
+    // Call with lock held.
+    func removeAll() {
+        entries.removeAll()
+        
+        while let currentElement = head {
+            let nextElement = currentElement.nextByUse
             
-            return left.isEqual(right)
+            currentElement.prevByUse = nil
+            currentElement.nextByUse = nil
+            
+            head = nextElement
         }
+        
+        tail = nil
+        oldestStamp.store(.max, ordering: .relaxed)
     }
 }
 
@@ -58,30 +134,54 @@ extension NSCache : @unchecked Sendable { }
 
 open class NSCache<KeyType : AnyObject, ObjectType : AnyObject> : NSObject {
     
-    private var _entries = Dictionary<NSCacheKey, NSCacheEntry<KeyType, ObjectType>>()
-    private let _lock = NSLock()
-    private var _totalCost = 0
-    private var _head: NSCacheEntry<KeyType, ObjectType>?
+    // Entries are spread over a fixed number of independently locked shards
+    // so that threads working on different keys do not contend. Eviction is
+    // least recently used across the whole cache: the victim is the head of
+    // whichever shard holds the oldest stamp.
+    private static var _shardCount: Int { 16 }
+    
+    private let _shards: [NSCacheShard<ObjectType>]
+    private let _clock = Atomic<UInt64>(0)
+    private let _totalCost = Atomic<Int>(0)
+    private let _count = Atomic<Int>(0)
     
     open var name: String = ""
     open var totalCostLimit: Int = 0 // limits are imprecise/not strict
     open var countLimit: Int = 0 // limits are imprecise/not strict
     open var evictsObjectsWithDiscardedContent: Bool = false
 
-    public override init() {}
+    public override init() {
+        _shards = (0..<NSCache._shardCount).map { _ in NSCacheShard<ObjectType>() }
+    }
     
     open weak var delegate: NSCacheDelegate?
     
+    private func _shard(for key: NSCacheKey) -> NSCacheShard<ObjectType> {
+        // Fibonacci hashing, so that keys whose hashes only differ in their
+        // high bits still spread over the shards.
+        let mixed = UInt64(truncatingIfNeeded: key.hash) &* 0x9E37_79B9_7F4A_7C15
+        return _shards[Int(truncatingIfNeeded: mixed >> 60) & (NSCache._shardCount - 1)]
+    }
+    
+    private func _nextStamp() -> UInt64 {
+        return _clock.wrappingAdd(1, ordering: .relaxed).newValue
+    }
+    
     open func object(forKey key: KeyType) -> ObjectType? {
         var object: ObjectType?
         
         let key = NSCacheKey(key)
+        let shard = _shard(for: key)
         
-        _lock.lock()
-        if let entry = _entries[key] {
+        shard.lock.lock()
+        if let entry = shard.entries[key] {
             object = entry.value
+            if entry !== shard.tail {
+                shard.remove(entry)
+                shard.append(entry, stamp: _nextStamp())
+            }
         }
-        _lock.unlock()
+        shard.lock.unlock()
         
         return object
     }
@@ -90,139 +190,99 @@ open class NSCache<KeyType : AnyObject, ObjectType : AnyObject> : NSObject {
         setObject(obj, forKey: key, cost: 0)
     }
     
-    private func remove(_ entry: NSCacheEntry<KeyType, ObjectType>) {
-        let oldPrev = entry.prevByCost
-        let oldNext = entry.nextByCost
-        
-        oldPrev?.nextByCost = oldNext
-        oldNext?.prevByCost = oldPrev
-        
-        if entry === _head {
-            _head = oldNext
-        }
-    }
-   
-    private func insert(_ entry: NSCacheEntry<KeyType, ObjectType>) {
-        guard var currentElement = _head else {
-            // The cache is empty
-            entry.prevByCost = nil
-            entry.nextByCost = nil
-            
-            _head = entry
-            return
-        }
-        
-        guard entry.cost > currentElement.cost else {
-            // Insert entry at the head
-            entry.prevByCost = nil
-            entry.nextByCost = currentElement
-            currentElement.prevByCost = entry
-            
-            _head = entry
-            return
-        }
-        
-        while let nextByCost = currentElement.nextByCost, nextByCost.cost < entry.cost {
-            currentElement = nextByCost
-        }
-        
-        // Insert entry between currentElement and nextElement
-        let nextElement = currentElement.nextByCost
-        
-        currentElement.nextByCost = entry
-        entry.prevByCost = currentElement
-        
-        entry.nextByCost = nextElement
-        nextElement?.prevByCost = entry
-    }
-    
     open func setObject(_ obj: ObjectType, forKey key: KeyType, cost g: Int) {
         let g = max(g, 0)
         let keyRef = NSCacheKey(key)
+        let shard = _shard(for: keyRef)
         
-        _lock.lock()
+        shard.lock.lock()
         
         let costDiff: Int
         
-        if let entry = _entries[keyRef] {
+        if let entry = shard.entries[keyRef] {
             costDiff = g - entry.cost
             entry.cost = g
             
             entry.value = obj
             
-            if costDiff != 0 {
-                remove(entry)
-                insert(entry)
-            }
+            shard.remove(entry)
+            shard.append(entry, stamp: _nextStamp())
         } else {
-            let entry = NSCacheEntry(key: key, value: obj, cost: g)
-            _entries[keyRef] = entry
-            insert(entry)
+            let entry = NSCacheEntry(key: keyRef, value: obj, cost: g)
+            shard.entries[keyRef] = entry
+            shard.append(entry, stamp: _nextStamp())
             
             costDiff = g
+            _count.wrappingAdd(1, ordering: .relaxed)
         }
         
-        _totalCost += costDiff
-        
-        var purgeAmount = (totalCostLimit > 0) ? (_totalCost - totalCostLimit) : 0
-        while purgeAmount > 0 {
-            if let entry = _head {
-                delegate?.cache(unsafeDowncast(self, to:NSCache<AnyObject, AnyObject>.self), willEvictObject: entry.value)
-                
-                _totalCost -= entry.cost
-                purgeAmount -= entry.cost
-                
-                remove(entry) // _head will be changed to next entry in remove(_:)
-                _entries[NSCacheKey(entry.key)] = nil
-            } else {
-                break
-            }
-        }
+        _totalCost.wrappingAdd(costDiff, ordering: .relaxed)
         
-        var purgeCount = (countLimit > 0) ? (_entries.count - countLimit) : 0
-        while purgeCount > 0 {
-            if let entry = _head {
-                delegate?.cache(unsafeDowncast(self, to:NSCache<AnyObject, AnyObject>.self), willEvictObject: entry.value)
-                
-                _totalCost -= entry.cost
-                purgeCount -= 1
-                
-                remove(entry) // _head will be changed to next entry in remove(_:)
-                _entries[NSCacheKey(entry.key)] = nil
-            } else {
-                break
+        shard.lock.unlock()
+        
+        _purgeIfNeeded()
+    }
+    
+    private func _purgeIfNeeded() {
+        while true {
+            let overCost = totalCostLimit > 0 && _totalCost.load(ordering: .relaxed) > totalCostLimit
+            let overCount = countLimit > 0 && _count.load(ordering: .relaxed) > countLimit
+            guard overCost || overCount else { return }
+            
+            var victim: NSCacheShard<ObjectType>?
+            var oldest = UInt64.max
+            for shard in _shards {
+                let stamp = shard.oldestStamp.load(ordering: .relaxed)
+                if stamp < oldest {
+                    oldest = stamp
+                    victim = shard
+                }
             }
+            guard let shard = victim else { return }
+            
+            shard.lock.lock()
+            // Another thread may have emptied the shard since we looked at it;
+            // if so, just pick again.
+            guard let entry = shard.head else {
+                shard.lock.unlock()
+                continue
+            }
+            shard.remove(entry) // head will be changed to next entry in remove(_:)
+            shard.entries[entry.key] = nil
+            _totalCost.wrappingSubtract(entry.cost, ordering: .relaxed)
+            _count.wrappingSubtract(1, ordering: .relaxed)
+            shard.lock.unlock()
+            
+            // Called without holding a shard lock, so the delegate may use the cache.
+            delegate?.cache(unsafeDowncast(self, to:NSCache<AnyObject, AnyObject>.self), willEvictObject: entry.value)
         }
-        
-        _lock.unlock()
     }
     
     open func removeObject(forKey key: KeyType) {
         let keyRef = NSCacheKey(key)
+        let shard = _shard(for: keyRef)
         
-        _lock.lock()
-        if let entry = _entries.removeValue(forKey: keyRef) {
-            _totalCost -= entry.cost
-            remove(entry)
+        shard.lock.lock()
+        if let entry = shard.entries.removeValue(forKey: keyRef) {
+            _totalCost.wrappingSubtract(entry.cost, ordering: .relaxed)
+            _count.wrappingSubtract(1, ordering: .relaxed)
+            shard.remove(entry)
         }
-        _lock.unlock()
+        shard.lock.unlock()
     }
     
     open func removeAllObjects() {
-        _lock.lock()
-        _entries.removeAll()
-        
-        while let currentElement = _head {
-            let nextElement = currentElement.nextByCost
-            
-            currentElement.prevByCost = nil
-            currentElement.nextByCost = nil
-            
-            _head = nextElement
+        for shard in _shards {
+            shard.lock.lock()
+            var cost = 0
+            for entry in shard.entries.values {
+                cost += entry.cost
+            }
+            _totalCost.wrappingSubtract(cost, ordering: .relaxed)
+            _count.wrappingSubtract(shard.entries.count, ordering: .relaxed)
+            shard.removeAll()
+            shard.lock.unlock()
         }
-        
-        _totalCost = 0
-        _lock.unlock()
     }    
 }
 
@@ -409,7 +409,7 @@ open class NSData : NSObject, NSCopying, NSMutableCopying, NSSecureCoding {
         guard let handle = FileHandle(path: path, flags: O_RDONLY, createMode: 0) else {
             throw NSError(domain: NSPOSIXErrorDomain, code: Int(errno), userInfo: nil)
         }
-        let result = try handle._readDataOfLength(Int.max, untilEOF: true)
+        let result = try handle._readDataOfLength(Int.max, untilEOF: true, options: options)
         return result
     }
 
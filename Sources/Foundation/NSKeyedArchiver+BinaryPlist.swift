@@ -0,0 +1,318 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+@_implementationOnly import CoreFoundation
+
+/// Writes a keyed archive as a binary property list while it is being encoded.
+///
+/// Each archived object is written as soon as the archiver has finished with it,
+/// so the archive never exists as a graph of property list objects. Until
+/// `finish` is called only the offset of every property list object written so
+/// far is kept, along with which of them each archived object became.
+internal final class _NSKeyedArchiveBinaryWriter {
+    private static let blockSize = 64 * 1024
+
+    /// The number of objects is not known until the end, so references between
+    /// objects always take four bytes. The trailer records this, so readers are
+    /// unaffected; small archives are a little larger than they need to be.
+    private static let objectRefSize = 4
+
+    private static let unsetReference = UInt32.max
+
+    private let output : AnyObject // NSMutableData or CFWriteStream
+    /// The length the output data had before anything was written to it.
+    private let outputStartLength : Int
+    private var buffer : [UInt8] = []
+    private var bytesFlushed = 0
+    private var offsets : [Int] = []
+    private var strings : [String : UInt32] = [:]
+    private var uids : [UInt32 : UInt32] = [:]
+    /// The property list object each archived object was written as, indexed by UID.
+    private var archivedObjects : [UInt32] = []
+    private var failed = false
+
+    init(output: AnyObject) {
+        self.output = output
+        self.outputStartLength = (output as? NSMutableData)?.length ?? 0
+        buffer.reserveCapacity(_NSKeyedArchiveBinaryWriter.blockSize)
+        buffer.append(contentsOf: "bplist00".utf8)
+    }
+
+    private var position : Int {
+        return bytesFlushed + buffer.count
+    }
+
+    /// Writes the encoded form of the archived object with the given UID.
+    func setObject(_ object: Any, forUID uid: Int) {
+        if archivedObjects.count <= uid {
+            archivedObjects.append(contentsOf: repeatElement(_NSKeyedArchiveBinaryWriter.unsetReference, count: uid + 1 - archivedObjects.count))
+        }
+        archivedObjects[uid] = write(object)
+        if buffer.count >= _NSKeyedArchiveBinaryWriter.blockSize {
+            flush()
+        }
+    }
+
+    /// Whether `abandon` can still take back everything written so far. Bytes
+    /// handed to a stream cannot be, so once a block has gone to a stream the
+    /// archive has to be finished as binary.
+    var canAbandon : Bool {
+        return output is NSMutableData || bytesFlushed == 0
+    }
+
+    /// Writes `$objects`, `$top` and the rest of the archive around them, followed
+    /// by the offset table and trailer. Returns false if anything could not be written.
+    func finish(archiver: String, version: Int, top: Dictionary<String, Any>) -> Bool {
+        writeTrailer(archiver: archiver, version: version, top: top)
+        flush()
+        return !failed
+    }
+
+    /// Takes back everything written so far and returns the archived objects,
+    /// indexed by UID, with `$null` in place of those that were never set.
+    /// Only valid while `canAbandon` is true. The writer cannot be used afterwards.
+    func abandon() -> [Any] {
+        writeTrailer(archiver: "", version: 0, top: [:])
+        var bytes = Data()
+        if let data = output as? NSMutableData {
+            bytes.append(contentsOf: UnsafeRawBufferPointer(start: data.bytes + outputStartLength, count: data.length - outputStartLength))
+            data.length = outputStartLength
+        }
+        bytes.append(contentsOf: buffer)
+        buffer.removeAll()
+
+        guard let plist = try? PropertyListSerialization.propertyList(from: bytes, format: nil) as? [String : Any],
+              let objects = plist["$objects"] as? [Any] else {
+            return []
+        }
+        return objects
+    }
+
+    private func writeTrailer(archiver: String, version: Int, top: Dictionary<String, Any>) {
+        let null = writeString(NSKeyedArchiveNullObjectReferenceName)
+        var objectRefs = archivedObjects.map { $0 == _NSKeyedArchiveBinaryWriter.unsetReference ? null : $0 }
+        if objectRefs.isEmpty {
+            objectRefs.append(null)
+        } else {
+            objectRefs[0] = null
+        }
+
+        let objects = beginObject()
+        writeMarker(UInt8(kCFBinaryPlistMarkerArray), count: objectRefs.count)
+        for ref in objectRefs {
+            writeRef(ref)
+        }
+
+        let keys = [writeString("$archiver"), writeString("$version"), writeString("$top"), writeString("$objects")]
+        let values = [writeString(archiver), writeInteger(version), write(top), objects]
+        let root = beginObject()
+        writeMarker(UInt8(kCFBinaryPlistMarkerDict), count: keys.count)
+        for ref in keys + values {
+            writeRef(ref)
+        }
+
+        let offsetTableOffset = position
+        let offsetIntSize = _NSKeyedArchiveBinaryWriter.byteCount(UInt64(offsetTableOffset))
+        for offset in offsets {
+            appendBigEndian(UInt64(offset), byteCount: offsetIntSize)
+        }
+
+        // Trailer: five unused bytes and the sort version, then the sizes and counts.
+        buffer.append(contentsOf: repeatElement(0, count: 6))
+        buffer.append(UInt8(offsetIntSize))
+        buffer.append(UInt8(_NSKeyedArchiveBinaryWriter.objectRefSize))
+        appendBigEndian(UInt64(offsets.count), byteCount: 8)
+        appendBigEndian(UInt64(root), byteCount: 8)
+        appendBigEndian(UInt64(offsetTableOffset), byteCount: 8)
+    }
+
+    private func flush() {
+        guard !buffer.isEmpty else { return }
+        buffer.withUnsafeBufferPointer { bytes in
+            if let data = output as? NSMutableData {
+                data.append(bytes.baseAddress!, length: bytes.count)
+            } else {
+                let stream = unsafeDowncast(output, to: CFWriteStream.self)
+                var written = 0
+                while written < bytes.count {
+                    let result = CFWriteStreamWrite(stream, bytes.baseAddress! + written, bytes.count - written)
+                    guard result > 0 else {
+                        failed = true
+                        return
+                    }
+                    written += result
+                }
+            }
+        }
+        bytesFlushed += buffer.count
+        buffer.removeAll(keepingCapacity: true)
+    }
+
+    // MARK: - Objects
+
+    /// Records the start of a new property list object and returns its reference.
+    private func beginObject() -> UInt32 {
+        offsets.append(position)
+        return UInt32(offsets.count - 1)
+    }
+
+    private func write(_ object: Any) -> UInt32 {
+        switch object {
+        case let uid as _NSKeyedArchiverUID:
+            return writeUID(uid.value)
+        case let string as String:
+            return writeString(string)
+        case let number as NSNumber:
+            return writeNumber(number)
+        case let data as Data:
+            return writeData(data)
+        case let date as Date:
+            return writeDate(date)
+        case let array as [Any]:
+            let refs = array.map(write)
+            let ref = beginObject()
+            writeMarker(UInt8(kCFBinaryPlistMarkerArray), count: refs.count)
+            refs.forEach(writeRef)
+            return ref
+        case let dictionary as [String : Any]:
+            var keyRefs : [UInt32] = []
+            var valueRefs : [UInt32] = []
+            keyRefs.reserveCapacity(dictionary.count)
+            valueRefs.reserveCapacity(dictionary.count)
+            for (key, value) in dictionary {
+                keyRefs.append(writeString(key))
+                valueRefs.append(write(value))
+            }
+            let ref = beginObject()
+            writeMarker(UInt8(kCFBinaryPlistMarkerDict), count: keyRefs.count)
+            keyRefs.forEach(writeRef)
+            valueRefs.forEach(writeRef)
+            return ref
+        default:
+            failed = true
+            return writeString(NSKeyedArchiveNullObjectReferenceName)
+        }
+    }
+
+    private func writeUID(_ value: UInt32) -> UInt32 {
+        if let ref = uids[value] {
+            return ref
+        }
+        let ref = beginObject()
+        let byteCount = _NSKeyedArchiveBinaryWriter.byteCount(UInt64(value))
+        buffer.append(UInt8(kCFBinaryPlistMarkerUID) | UInt8(byteCount - 1))
+        appendBigEndian(UInt64(value), byteCount: byteCount)
+        uids[value] = ref
+        return ref
+    }
+
+    private func writeString(_ string: String) -> UInt32 {
+        if let ref = strings[string] {
+            return ref
+        }
+        let ref = beginObject()
+        let utf8 = string.utf8
+        if utf8.allSatisfy({ $0 < 0x80 }) {
+            writeMarker(UInt8(kCFBinaryPlistMarkerASCIIString), count: utf8.count)
+            buffer.append(contentsOf: utf8)
+        } else {
+            let utf16 = string.utf16
+            writeMarker(UInt8(kCFBinaryPlistMarkerUnicode16String), count: utf16.count)
+            for unit in utf16 {
+                appendBigEndian(UInt64(unit), byteCount: 2)
+            }
+        }
+        strings[string] = ref
+        return ref
+    }
+
+    private func writeNumber(_ number: NSNumber) -> UInt32 {
+        let ref = beginObject()
+        let numberType = _CFNumberGetType2(number._cfObject)
+        if number._cfTypeID == CFBooleanGetTypeID() {
+            buffer.append(UInt8(number.boolValue ? kCFBinaryPlistMarkerTrue : kCFBinaryPlistMarkerFalse))
+        } else if numberType == kCFNumberFloat32Type {
+            buffer.append(UInt8(kCFBinaryPlistMarkerReal) | 2)
+            appendBigEndian(UInt64(number.floatValue.bitPattern), byteCount: 4)
+        } else if CFNumberIsFloatType(number._cfObject) {
+            buffer.append(UInt8(kCFBinaryPlistMarkerReal) | 3)
+            appendBigEndian(number.doubleValue.bitPattern, byteCount: 8)
+        } else if numberType == kCFNumberSInt128Type {
+            // Only unsigned values that do not fit in an Int64 are stored this way.
+            buffer.append(UInt8(kCFBinaryPlistMarkerInt) | 4)
+            appendBigEndian(0, byteCount: 8)
+            appendBigEndian(number.uint64Value, byteCount: 8)
+        } else {
+            appendInteger(number.int64Value)
+        }
+        return ref
+    }
+
+    private func writeInteger(_ value: Int) -> UInt32 {
+        let ref = beginObject()
+        appendInteger(Int64(value))
+        return ref
+    }
+
+    private func writeData(_ data: Data) -> UInt32 {
+        let ref = beginObject()
+        writeMarker(UInt8(kCFBinaryPlistMarkerData), count: data.count)
+        buffer.append(contentsOf: data)
+        return ref
+    }
+
+    private func writeDate(_ date: Date) -> UInt32 {
+        let ref = beginObject()
+        buffer.append(UInt8(kCFBinaryPlistMarkerDate))
+        appendBigEndian(date.timeIntervalSinceReferenceDate.bitPattern, byteCount: 8)
+        return ref
+    }
+
+    // MARK: - Encoding
+
+    /// The number of bytes, one, two, four or eight, needed to hold `value`.
+    private static func byteCount(_ value: UInt64) -> Int {
+        if value <= 0xFF {
+            return 1
+        } else if value <= 0xFFFF {
+            return 2
+        } else if value <= 0xFFFF_FFFF {
+            return 4
+        } else {
+            return 8
+        }
+    }
+
+    private func appendBigEndian(_ value: UInt64, byteCount: Int) {
+        for shift in stride(from: (byteCount - 1) * 8, through: 0, by: -8) {
+            buffer.append(UInt8(truncatingIfNeeded: value >> UInt64(shift)))
+        }
+    }
+
+    /// Appends an integer object; negative values always take eight bytes.
+    private func appendInteger(_ value: Int64) {
+        let byteCount = value < 0 ? 8 : _NSKeyedArchiveBinaryWriter.byteCount(UInt64(value))
+        buffer.append(UInt8(kCFBinaryPlistMarkerInt) | UInt8(byteCount.trailingZeroBitCount))
+        appendBigEndian(UInt64(bitPattern: value), byteCount: byteCount)
+    }
+
+    /// Appends a marker for a variable-length object; counts of 15 or more follow it as an integer.
+    private func writeMarker(_ marker: UInt8, count: Int) {
+        if count < 15 {
+            buffer.append(marker | UInt8(count))
+        } else {
+            buffer.append(marker | 0x0F)
+            appendInteger(Int64(count))
+        }
+    }
+
+    private func writeRef(_ ref: UInt32) {
+        appendBigEndian(UInt64(ref), byteCount: _NSKeyedArchiveBinaryWriter.objectRefSize)
+    }
+}
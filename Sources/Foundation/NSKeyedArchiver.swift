@@ -93,6 +93,10 @@ open class NSKeyedArchiver : NSCoder {
     private var _classNameMap : Dictionary<String, String> = [:]
     private var _classes : Dictionary<String, _NSKeyedArchiverUID> = [:]
     private var _cache : Array<_NSKeyedArchiverUID> = []
+    private var _binaryWriter : _NSKeyedArchiveBinaryWriter? = nil
+    /// Whether objects are still being written out as they are encoded. Once any
+    /// have been kept in `_objects` because the output format was XML, all are.
+    private var _isWritingIncrementally = true
 
     /// The archiver’s delegate.
     open weak var delegate: NSKeyedArchiverDelegate?
@@ -113,6 +117,21 @@ open class NSKeyedArchiver : NSCoder {
                 fatalError("Unsupported format: \(newValue)")
             }
         }
+        didSet {
+            guard outputFormat != .binary, let writer = _binaryWriter else { return }
+            // Stream output is written as encoding proceeds, so its format is
+            // fixed once the first block has been written.
+            guard writer.canAbandon else {
+                fatalError("The output format of an archive being written to a stream cannot be changed once encoding has begun")
+            }
+            // Take back the objects written so far and keep the whole graph
+            // from here on, as the XML path always has.
+            _binaryWriter = nil
+            _isWritingIncrementally = false
+            for (index, object) in writer.abandon().enumerated() where index > 0 && index < _objects.count {
+                _objects[index] = object
+            }
+        }
     }
     
     open class func archivedData(withRootObject object: Any, requiringSecureCoding: Bool) throws -> Data {
@@ -233,8 +252,25 @@ open class NSKeyedArchiver : NSCoder {
         return success
     }
     
-    private func _writeBinaryData(_ plist : NSDictionary) -> Bool {
-        return __CFBinaryPlistWriteToStream(plist, self._stream) > 0
+    private func _writeBinaryData() -> Bool {
+        if !_isWritingIncrementally {
+            return __CFBinaryPlistWriteToStream(_plist()._bridgeToObjectiveC(), self._stream) > 0
+        }
+        let writer = self._binaryWriter ?? _NSKeyedArchiveBinaryWriter(output: self._stream)
+        return writer.finish(archiver: NSStringFromClass(type(of: self)),
+                             version: NSKeyedArchivePlistVersion,
+                             top: self._containers[0].dict)
+    }
+
+    private func _plist() -> Dictionary<String, Any> {
+        var plist = Dictionary<String, Any>()
+
+        plist["$archiver"] = NSStringFromClass(type(of: self))
+        plist["$version"] = NSKeyedArchivePlistVersion
+        plist["$objects"] = self._objects
+        plist["$top"] = self._containers[0].dict
+
+        return plist
     }
     
     /// Returns the encoded data for the archiver.
@@ -260,26 +296,16 @@ open class NSKeyedArchiver : NSCoder {
             return
         }
 
-        var plist = Dictionary<String, Any>()
         var success : Bool
 
-        plist["$archiver"] = NSStringFromClass(type(of: self))
-        plist["$version"] = NSKeyedArchivePlistVersion
-        plist["$objects"] = self._objects
-        plist["$top"] = self._containers[0].dict
-
-        
-        
         if let unwrappedDelegate = self.delegate {
             unwrappedDelegate.archiverWillFinish(self)
         }
 
-        let nsPlist = plist._bridgeToObjectiveC()
-        
         if self.outputFormat == .xml {
-            success = _writeXMLData(nsPlist)
+            success = _writeXMLData(_plist()._bridgeToObjectiveC())
         } else {
-            success = _writeBinaryData(nsPlist)
+            success = _writeBinaryData()
         }
 
         if let unwrappedDelegate = self.delegate {
@@ -494,7 +520,17 @@ open class NSKeyedArchiver : NSCoder {
      */ 
     private func _setObject(_ objv: Any, forReference reference : _NSKeyedArchiverUID) {
         let index = Int(reference.value)
-        self._objects[index] = objv
+        if self.outputFormat == .binary && _isWritingIncrementally {
+            // Binary archives are written out object by object as encoding proceeds,
+            // leaving only placeholders in _objects.
+            if self._binaryWriter == nil {
+                self._binaryWriter = _NSKeyedArchiveBinaryWriter(output: self._stream)
+            }
+            self._binaryWriter!.setObject(objv, forUID: index)
+        } else {
+            self._objects[index] = objv
+            _isWritingIncrementally = false
+        }
     }
     
     /**
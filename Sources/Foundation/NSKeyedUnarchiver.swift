@@ -48,6 +48,30 @@ open class NSKeyedUnarchiver : NSCoder {
         }
     }
     
+    /**
+        Locates the elements of `$objects` in an archive that is a binary property list,
+        so that each one can be created when it is first dereferenced.
+     */
+    private struct _BinaryObjectTable {
+        let data : Data
+        let trailer : CFBinaryPlistTrailer
+        let objectsOffset : UInt64
+        
+        func object(at uid: Int) -> Any? {
+            var trailer = self.trailer
+            return data.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) -> Any? in
+                let bytes = buffer.baseAddress!.assumingMemoryBound(to: UInt8.self)
+                let length = UInt64(buffer.count)
+                var offset : UInt64 = 0
+                
+                guard __CFBinaryPlistGetOffsetForValueFromArray2(bytes, length, objectsOffset, &trailer, uid, &offset, nil) else {
+                    return nil
+                }
+                return _createBinaryPlistObject(bytes, length, offset, &trailer)
+            }
+        }
+    }
+    
     private static let _globalClassNameMap = Mutex<Dictionary<String, AnyClass>>([:])
     
     open weak var delegate: NSKeyedUnarchiverDelegate?
@@ -63,6 +87,7 @@ open class NSKeyedUnarchiver : NSCoder {
     private var _flags = UnarchiverFlags(rawValue: 0)
     private var _containers : Array<DecodingContext>? = nil
     private var _objects : Array<Any> = []
+    private var _binaryObjects : _BinaryObjectTable? = nil
     private var _objRefMap : Dictionary<UInt32, Any> = [:]
     private var _replacementMap : Dictionary<AnyHashable, Any> = [:]
     private var _classNameMap : Dictionary<String, AnyClass> = [:]
@@ -143,12 +168,13 @@ open class NSKeyedUnarchiver : NSCoder {
         var plist : Any? = nil
         var format = PropertyListSerialization.PropertyListFormat.binary
         
-        // FIXME this implementation reads the entire property list into memory
-        // which will not scale for large archives. We should support incremental
-        // unarchiving, but that will be a considerable amount of work.
+        // Archives read from a stream are still read into memory in their entirety.
         
         switch self._stream {
         case .data(let data):
+            if try _readBinaryArchive(data) {
+                return
+            }
             try plist = PropertyListSerialization.propertyList(from: data, options: [], format: &format)
 #if !os(WASI)
         case .stream(let readStream):
@@ -161,28 +187,94 @@ open class NSKeyedUnarchiver : NSCoder {
                                  withDescription: "Unable to read archive. The data may be corrupt.")
         }
         
-        let archiver = unwrappedPlist["$archiver"] as? String
-        if archiver != NSStringFromClass(NSKeyedArchiver.self) {
+        try _validateArchiveHeader(archiver: unwrappedPlist["$archiver"], version: unwrappedPlist["$version"])
+        
+        let top = unwrappedPlist["$top"] as? Dictionary<String, Any>
+        let objects = unwrappedPlist["$objects"] as? Array<Any>
+        
+        if top == nil || objects == nil {
+            throw _decodingError(.propertyListReadCorrupt,
+                                 withDescription: "Unable to read archive contents. The data may be corrupt.")
+        }
+        
+        self._objects = objects!
+        self._containers = [DecodingContext(top!)]
+    }
+    
+    private func _validateArchiveHeader(archiver: Any?, version: Any?) throws {
+        if archiver as? String != NSStringFromClass(NSKeyedArchiver.self) {
             throw _decodingError(.propertyListReadCorrupt,
                                  withDescription: "Unknown archiver. The data may be corrupt.")
         }
         
-        let version = unwrappedPlist["$version"] as? NSNumber
-        if version?.int32Value != Int32(NSKeyedArchivePlistVersion) {
+        if (version as? NSNumber)?.int32Value != Int32(NSKeyedArchivePlistVersion) {
             throw _decodingError(.propertyListReadCorrupt,
                                  withDescription: "Unknown archive version. The data may be corrupt.")
         }
+    }
+    
+    /**
+        Reads the header of an archive stored as a binary property list, leaving
+        `$objects` where it is in the data; its elements are created one at a time
+        as they are dereferenced. Returns false if the data is not a binary property list.
+     */
+    private func _readBinaryArchive(_ data: Data) throws -> Bool {
+        guard data.starts(with: "bplist0".utf8) else {
+            return false
+        }
         
-        let top = unwrappedPlist["$top"] as? Dictionary<String, Any>
-        let objects = unwrappedPlist["$objects"] as? Array<Any>
+        var trailer = CFBinaryPlistTrailer()
+        var topOffset : UInt64 = 0
+        var objectsOffset : UInt64? = nil
         
-        if top == nil || objects == nil {
+        let header = data.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) -> (archiver: Any?, version: Any?, top: Any?)? in
+            let bytes = buffer.baseAddress!.assumingMemoryBound(to: UInt8.self)
+            let length = UInt64(buffer.count)
+            var marker : UInt8 = 0
+            
+            guard __CFBinaryPlistGetTopLevelInfo(bytes, length, &marker, &topOffset, &trailer),
+                  marker & 0xF0 == UInt8(kCFBinaryPlistMarkerDict) else {
+                return nil
+            }
+            
+            func valueOffset(forKey key: String) -> UInt64? {
+                var offset : UInt64 = 0
+                guard __CFBinaryPlistGetOffsetForValueFromDictionary3(bytes, length, topOffset, &trailer, key._cfObject, nil, &offset, false, nil) else {
+                    return nil
+                }
+                return offset
+            }
+            
+            func value(forKey key: String) -> Any? {
+                guard let offset = valueOffset(forKey: key) else {
+                    return nil
+                }
+                return _createBinaryPlistObject(bytes, length, offset, &trailer)
+            }
+            
+            if let offset = valueOffset(forKey: "$objects"),
+               bytes[Int(offset)] & 0xF0 == UInt8(kCFBinaryPlistMarkerArray) {
+                objectsOffset = offset
+            }
+            
+            return (value(forKey: "$archiver"), value(forKey: "$version"), value(forKey: "$top"))
+        }
+        
+        guard let header = header else {
+            throw _decodingError(.propertyListReadCorrupt,
+                                 withDescription: "Unable to read archive. The data may be corrupt.")
+        }
+        
+        try _validateArchiveHeader(archiver: header.archiver, version: header.version)
+        
+        guard let top = header.top as? Dictionary<String, Any>, let objectsOffset = objectsOffset else {
             throw _decodingError(.propertyListReadCorrupt,
                                  withDescription: "Unable to read archive contents. The data may be corrupt.")
         }
         
-        self._objects = objects!
-        self._containers = [DecodingContext(top!)]
+        self._binaryObjects = _BinaryObjectTable(data: data, trailer: trailer, objectsOffset: objectsOffset)
+        self._containers = [DecodingContext(top)]
+        return true
     }
     
     private func _pushDecodingContext(_ decodingContext: DecodingContext) {
@@ -224,6 +316,10 @@ open class NSKeyedUnarchiver : NSCoder {
     private func _dereferenceObjectReference(_ unwrappedObjectRef: _NSKeyedArchiverUID) -> Any? {
         let uid = Int(unwrappedObjectRef.value)
         
+        if let binaryObjects = self._binaryObjects {
+            return binaryObjects.object(at: uid)
+        }
+        
         guard uid < self._objects.count else {
             return nil
         }
@@ -476,6 +572,13 @@ open class NSKeyedUnarchiver : NSCoder {
                                  withDescription: "Object \(objectRef) is not a reference. The data may be corrupt.")
         }
         
+        // Decoded containers, and values read from a binary archive, are cached.
+        // Returning them before dereferencing avoids creating the object again
+        // when reading a binary archive lazily.
+        if let cachedObject = _cachedObjectForReference(objectRef) {
+            return _replacementObject(cachedObject)
+        }
+        
         guard let dereferencedObject = _dereferenceObjectReference(objectRef) else {
             throw _decodingError(.coderReadCorrupt,
                                  withDescription: "Invalid object reference \(objectRef). The data may be corrupt.")
@@ -528,6 +631,11 @@ open class NSKeyedUnarchiver : NSCoder {
             }
         } else {
             object = __SwiftValue.store(dereferencedObject)
+            // Values such as strings are shared by every reference to them, and
+            // the binary table creates them anew on each lookup.
+            if self._binaryObjects != nil {
+                _cacheObject(object!, forReference: objectRef)
+            }
         }
 
         return _replacementObject(object)
@@ -968,3 +1076,12 @@ extension NSKeyedUnarchiverDelegate {
     func unarchiverWillFinish(_ unarchiver: NSKeyedUnarchiver) { }
     func unarchiverDidFinish(_ unarchiver: NSKeyedUnarchiver) { }
 }
+
+private func _createBinaryPlistObject(_ bytes: UnsafePointer<UInt8>, _ length: UInt64, _ offset: UInt64, _ trailer: UnsafePointer<CFBinaryPlistTrailer>) -> Any? {
+    var plist : Unmanaged<AnyObject>? = nil
+    guard __CFBinaryPlistCreateObject(bytes, length, offset, trailer, kCFAllocatorSystemDefault, 0, nil, &plist),
+          let object = plist?.takeRetainedValue() else {
+        return nil
+    }
+    return __SwiftValue.fetch(nonOptional: object)
+}
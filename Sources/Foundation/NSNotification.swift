@@ -7,6 +7,8 @@
 // See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
 //
 
+internal import Synchronization
+
 @available(*, unavailable)
 extension NSNotification : @unchecked Sendable { }
 
@@ -96,38 +98,84 @@ private class NSNotificationReceiver : NSObject {
 
 private let _defaultCenter: NotificationCenter = NotificationCenter()
 
+// Receivers keyed by the sender they observe (nil for any sender), then by their own identity.
+private typealias _NotificationObservers = [ObjectIdentifier? /* object */ : [ObjectIdentifier /* notification receiver */ : NSNotificationReceiver]]
+
+// Observers of a set of notification names. Posting only holds the lock long enough to take a
+// reference to the observers for one name; adding or removing an observer while a post is still
+// delivering copies that entry rather than changing it under the post.
+private final class _NotificationObserverShard {
+    private var _observers = [NSNotification.Name : _NotificationObservers]()
+    private let _lock = NSLock()
+
+    func observers(for name: NSNotification.Name) -> _NotificationObservers? {
+        _lock.lock()
+        defer { _lock.unlock() }
+        return _observers[name]
+    }
+
+    func add(_ receiver: NSNotificationReceiver, name: NSNotification.Name, sender: ObjectIdentifier?) {
+        _lock.synchronized {
+            _observers[name, default: [:]][sender, default: [:]][ObjectIdentifier(receiver)] = receiver
+        }
+    }
+
+    func remove(_ receiver: NSNotificationReceiver, name: NSNotification.Name, sender: ObjectIdentifier?) {
+        _lock.synchronized {
+            _observers[name]?[sender]?.removeValue(forKey: ObjectIdentifier(receiver))
+            if _observers[name]?[sender]?.isEmpty == true {
+                _observers[name]?.removeValue(forKey: sender)
+                if _observers[name]?.isEmpty == true {
+                    _observers.removeValue(forKey: name)
+                }
+            }
+        }
+    }
+}
+
 open class NotificationCenter: NSObject, @unchecked Sendable {
-    private lazy var _nilIdentifier: ObjectIdentifier = ObjectIdentifier(_observersLock)
-    private lazy var _nilHashable: AnyHashable = AnyHashable(_nilIdentifier)
-    
-    private var _observers: [AnyHashable /* Notification.Name */ : [ObjectIdentifier /* object */ : [ObjectIdentifier /* notification receiver */ : NSNotificationReceiver]]]
-    private let _observersLock = NSLock()
+    // Observers are spread over shards by notification name so that posts of different names never
+    // contend. Observers registered for any name live in a table of their own, which is only
+    // consulted while something is registered there.
+    private static let _shardCount = 16
+    private let _shards: [_NotificationObserverShard]
+    private var _anyNameObservers = _NotificationObservers()
+    private let _anyNameObserversLock = NSLock()
+    // Read without the lock, so posts do not all meet on it when nothing observes every name.
+    private let _anyNameObserverCount = Atomic<Int>(0)
     
     public required override init() {
-        _observers = [AnyHashable: [ObjectIdentifier: [ObjectIdentifier: NSNotificationReceiver]]]()
+        _shards = (0..<NotificationCenter._shardCount).map { _ in _NotificationObserverShard() }
     }
     
     open class var `default`: NotificationCenter {
         return _defaultCenter
     }
+
+    private func _shard(for name: NSNotification.Name) -> _NotificationObserverShard {
+        return _shards[name.hashValue & (NotificationCenter._shardCount - 1)]
+    }
+
+    private func _anyNameObserversSnapshot() -> _NotificationObservers? {
+        guard _anyNameObserverCount.load(ordering: .acquiring) > 0 else {
+            return nil
+        }
+        _anyNameObserversLock.lock()
+        defer { _anyNameObserversLock.unlock() }
+        return _anyNameObservers
+    }
     
     open func post(_ notification: Notification) {
-        let notificationNameIdentifier: AnyHashable = AnyHashable(notification.name)
+        let anyNameObservers = _anyNameObserversSnapshot()
+        let namedObservers = _shard(for: notification.name).observers(for: notification.name)
+        guard anyNameObservers != nil || namedObservers != nil else {
+            return
+        }
+
         let senderIdentifier: ObjectIdentifier? = notification.object.map({ ObjectIdentifier(__SwiftValue.store($0)) })
-        
 
-        let sendTo: [Dictionary<ObjectIdentifier, NSNotificationReceiver>.Values] = _observersLock.synchronized({
-            var retVal = [Dictionary<ObjectIdentifier, NSNotificationReceiver>.Values]()
-            (_observers[_nilHashable]?[_nilIdentifier]?.values).map({ retVal.append($0) })
-            senderIdentifier.flatMap({ _observers[_nilHashable]?[$0]?.values }).map({ retVal.append($0) })
-            (_observers[notificationNameIdentifier]?[_nilIdentifier]?.values).map({ retVal.append($0) })
-            senderIdentifier.flatMap({ _observers[notificationNameIdentifier]?[$0]?.values}).map({ retVal.append($0) })
-            
-            return retVal
-        })
-
-        sendTo.forEach { observers in
-            observers.forEach { observer in
+        func deliver(to observers: [ObjectIdentifier : NSNotificationReceiver]?) {
+            observers?.values.forEach { observer in
                 guard let block = observer.block else {
                     return
                 }
@@ -142,6 +190,15 @@ open class NotificationCenter: NSObject, @unchecked Sendable {
                 }
             }
         }
+
+        if let anyNameObservers {
+            deliver(to: anyNameObservers[nil])
+            senderIdentifier.map { deliver(to: anyNameObservers[$0]) }
+        }
+        if let namedObservers {
+            deliver(to: namedObservers[nil])
+            senderIdentifier.map { deliver(to: namedObservers[$0]) }
+        }
     }
 
     open func post(name aName: NSNotification.Name, object anObject: Any?, userInfo aUserInfo: [AnyHashable : Any]? = nil) {
@@ -162,16 +219,19 @@ open class NotificationCenter: NSObject, @unchecked Sendable {
             return
         }
 
-        let notificationNameIdentifier: AnyHashable = observer.name.map { AnyHashable($0) } ?? _nilHashable
-        let senderIdentifier: ObjectIdentifier = observer.sender.map { ObjectIdentifier($0) } ?? _nilIdentifier
-        let receiverIdentifier: ObjectIdentifier = ObjectIdentifier(observer)
-        
-        _observersLock.synchronized({
-            _observers[notificationNameIdentifier]?[senderIdentifier]?.removeValue(forKey: receiverIdentifier)
-            if _observers[notificationNameIdentifier]?[senderIdentifier]?.count == 0 {
-                _observers[notificationNameIdentifier]?.removeValue(forKey: senderIdentifier)
-            }
-        })
+        let senderIdentifier: ObjectIdentifier? = observer.sender.map { ObjectIdentifier($0) }
+        if let name = observer.name {
+            _shard(for: name).remove(observer, name: name, sender: senderIdentifier)
+        } else {
+            _anyNameObserversLock.synchronized({
+                if _anyNameObservers[senderIdentifier]?.removeValue(forKey: ObjectIdentifier(observer)) != nil {
+                    _anyNameObserverCount.subtract(1, ordering: .releasing)
+                }
+                if _anyNameObservers[senderIdentifier]?.isEmpty == true {
+                    _anyNameObservers.removeValue(forKey: senderIdentifier)
+                }
+            })
+        }
     }
 
     @available(*, unavailable, renamed: "addObserver(forName:object:queue:using:)")
@@ -186,13 +246,15 @@ open class NotificationCenter: NSObject, @unchecked Sendable {
         newObserver.sender = __SwiftValue.store(obj)
         newObserver.queue = queue
         
-        let notificationNameIdentifier: AnyHashable = name.map({ AnyHashable($0) }) ?? _nilHashable
-        let senderIdentifier: ObjectIdentifier = newObserver.sender.map({ ObjectIdentifier($0) }) ?? _nilIdentifier
-        let receiverIdentifier: ObjectIdentifier = ObjectIdentifier(newObserver)
-
-        _observersLock.synchronized({
-            _observers[notificationNameIdentifier, default: [:]][senderIdentifier, default: [:]][receiverIdentifier] = newObserver
-        })
+        let senderIdentifier: ObjectIdentifier? = newObserver.sender.map({ ObjectIdentifier($0) })
+        if let name = name {
+            _shard(for: name).add(newObserver, name: name, sender: senderIdentifier)
+        } else {
+            _anyNameObserversLock.synchronized({
+                _anyNameObservers[senderIdentifier, default: [:]][ObjectIdentifier(newObserver)] = newObserver
+                _anyNameObserverCount.add(1, ordering: .releasing)
+            })
+        }
         
         return newObserver
     }
@@ -34,12 +34,10 @@ extension NotificationQueue : @unchecked Sendable { }
 open class NotificationQueue: NSObject {
 
     internal typealias NotificationQueueList = NSMutableArray
-    internal typealias NSNotificationListEntry = (Notification, [RunLoop.Mode]) // Notification ans list of modes the notification may be posted in.
-    internal typealias NSNotificationList = [NSNotificationListEntry] // The list of notifications to post
 
     internal let notificationCenter: NotificationCenter
-    internal var asapList = NSNotificationList()
-    internal var idleList = NSNotificationList()
+    internal var asapList = _NotificationQueuePendingList()
+    internal var idleList = _NotificationQueuePendingList()
     internal final lazy var idleRunloopObserver: CFRunLoopObserver = {
         return CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, CFOptionFlags(kCFRunLoopBeforeTimers), true, 0) {[weak self] observer, activity in
             self!.notifyQueues(.whenIdle)
@@ -50,6 +48,9 @@ open class NotificationQueue: NSObject {
             self!.notifyQueues(.asap)
         }
     }()
+    // The run loops the observers were last added to; they repeat, so they only need adding once.
+    private final var idleRunloopObserverRunLoop: CFRunLoop?
+    private final var asapRunloopObserverRunLoop: CFRunLoop?
 
     // The NSNotificationQueue instance is associated with current thread.
     // The _notificationQueueList represents a list of notification queues related to the current thread.
@@ -101,42 +102,29 @@ open class NotificationQueue: NSObject {
                 self.notificationCenter.post(notification)
             }
         case .asap: // post at the end of the current notification callout or timer
-            addRunloopObserver(self.asapRunloopObserver)
-            self.asapList.append((notification, runloopModes))
+            addRunloopObserver(self.asapRunloopObserver, addedTo: &asapRunloopObserverRunLoop)
+            self.asapList.append(notification, modes: runloopModes)
         case .whenIdle: // wait until the runloop is idle, then post the notification
-            addRunloopObserver(self.idleRunloopObserver)
-            self.idleList.append((notification, runloopModes))
+            addRunloopObserver(self.idleRunloopObserver, addedTo: &idleRunloopObserverRunLoop)
+            self.idleList.append(notification, modes: runloopModes)
         }
     }
     
     open func dequeueNotifications(matching notification: Notification, coalesceMask: NotificationCoalescing) {
-        var predicate: (NSNotificationListEntry) -> Bool
-        switch coalesceMask {
-        case [.onName, .onSender]:
-            predicate = { entry in
-                return __SwiftValue.store(notification.object) !== __SwiftValue.store(entry.0.object) || notification.name != entry.0.name
-            }
-        case [.onName]:
-            predicate = { entry in
-                return notification.name != entry.0.name
-            }
-        case [.onSender]:
-            predicate = { entry in
-                return __SwiftValue.store(notification.object) !== __SwiftValue.store(entry.0.object)
-            }
-        default:
-            return
-        }
-
-        self.asapList = self.asapList.filter(predicate)
-        self.idleList = self.idleList.filter(predicate)
+        self.asapList.removeNotifications(matching: notification, coalesceMask: coalesceMask)
+        self.idleList.removeNotifications(matching: notification, coalesceMask: coalesceMask)
     }
 
     // MARK: Private
 
-    private final func addRunloopObserver(_ observer: CFRunLoopObserver) {
-        CFRunLoopAddObserver(RunLoop.current._cfRunLoop, observer, kCFRunLoopDefaultMode)
-        CFRunLoopAddObserver(RunLoop.current._cfRunLoop, observer, kCFRunLoopCommonModes)
+    private final func addRunloopObserver(_ observer: CFRunLoopObserver, addedTo runLoop: inout CFRunLoop?) {
+        let currentRunLoop = RunLoop.current._cfRunLoop!
+        guard runLoop !== currentRunLoop else {
+            return
+        }
+        runLoop = currentRunLoop
+        CFRunLoopAddObserver(currentRunLoop, observer, kCFRunLoopDefaultMode)
+        CFRunLoopAddObserver(currentRunLoop, observer, kCFRunLoopCommonModes)
     }
 
     private final func removeRunloopObserver(_ observer: CFRunLoopObserver) {
@@ -144,12 +132,14 @@ open class NotificationQueue: NSObject {
         CFRunLoopRemoveObserver(RunLoop.current._cfRunLoop, observer, kCFRunLoopCommonModes)
     }
 
-    private func notify(_ currentMode: RunLoop.Mode?, notificationList: inout NSNotificationList) {
-        for (idx, (notification, modes)) in notificationList.enumerated().reversed() {
-            if currentMode == nil || modes.contains(currentMode!) {
-                self.notificationCenter.post(notification)
-                notificationList.remove(at: idx)
-            }
+    // Everything that can be posted in the current mode is taken off the list before the first of
+    // them is posted, so the whole batch goes out in this one callout, in the order it was enqueued.
+    private func notify(_ currentMode: RunLoop.Mode?, notificationList: inout _NotificationQueuePendingList) {
+        guard !notificationList.isEmpty else {
+            return
+        }
+        for notification in notificationList.removeNotifications(postableIn: currentMode) {
+            self.notificationCenter.post(notification)
         }
     }
 
@@ -181,4 +171,108 @@ open class NotificationQueue: NSObject {
 
 }
 
+/// Notifications waiting to be posted, in the order they were enqueued.
+///
+/// Every notification is indexed by its name, its sender, and both, so coalescing finds the
+/// notifications it replaces without looking at the rest. Removing a notification leaves its
+/// identifier behind in the indexes it was not looked up through; those are skipped when found
+/// and dropped when the list is compacted, which happens once they outnumber live entries.
+internal struct _NotificationQueuePendingList {
+    private struct Entry {
+        let notification: Notification
+        // Boxed once when enqueued, so the sender's identity is the same each time it is compared.
+        let sender: AnyObject?
+        let modes: [RunLoop.Mode]
+    }
+
+    private struct NameAndSender : Hashable {
+        let name: Notification.Name
+        let sender: ObjectIdentifier?
+    }
+
+    // An entry's identifier is its position here; removed entries are nil.
+    private var entries: [Entry?] = []
+    private var liveCount = 0
+
+    private var byName: [Notification.Name : [Int]] = [:]
+    private var bySender: [ObjectIdentifier? : [Int]] = [:]
+    private var byNameAndSender: [NameAndSender : [Int]] = [:]
+    private var indexedCount = 0
+
+    var isEmpty: Bool {
+        return liveCount == 0
+    }
+
+    mutating func append(_ notification: Notification, modes: [RunLoop.Mode]) {
+        append(Entry(notification: notification, sender: __SwiftValue.store(notification.object), modes: modes))
+    }
+
+    private mutating func append(_ entry: Entry) {
+        let identifier = entries.count
+        let sender = entry.sender.map { ObjectIdentifier($0) }
+        entries.append(entry)
+        liveCount += 1
+        byName[entry.notification.name, default: []].append(identifier)
+        bySender[sender, default: []].append(identifier)
+        byNameAndSender[NameAndSender(name: entry.notification.name, sender: sender), default: []].append(identifier)
+        indexedCount += 3
+    }
+
+    mutating func removeNotifications(matching notification: Notification, coalesceMask: NotificationQueue.NotificationCoalescing) {
+        guard liveCount > 0 else {
+            return
+        }
+        let sender = __SwiftValue.store(notification.object).map { ObjectIdentifier($0) }
+        let identifiers: [Int]?
+        switch coalesceMask {
+        case [.onName, .onSender]:
+            identifiers = byNameAndSender.removeValue(forKey: NameAndSender(name: notification.name, sender: sender))
+        case [.onName]:
+            identifiers = byName.removeValue(forKey: notification.name)
+        case [.onSender]:
+            identifiers = bySender.removeValue(forKey: sender)
+        default:
+            return
+        }
+        guard let identifiers = identifiers else {
+            return
+        }
+
+        indexedCount -= identifiers.count
+        for identifier in identifiers where entries[identifier] != nil {
+            entries[identifier] = nil
+            liveCount -= 1
+        }
+
+        if liveCount == 0 {
+            self = _NotificationQueuePendingList()
+        } else if indexedCount > liveCount * 6 + 96 {
+            rebuild(keeping: entries.compactMap { $0 })
+        }
+    }
+
+    /// Removes and returns, in order, the notifications that may be posted in `mode`.
+    mutating func removeNotifications(postableIn mode: RunLoop.Mode?) -> [Notification] {
+        var postable: [Notification] = []
+        var kept: [Entry] = []
+        postable.reserveCapacity(liveCount)
+        for case let entry? in entries {
+            if mode == nil || entry.modes.contains(mode!) {
+                postable.append(entry.notification)
+            } else {
+                kept.append(entry)
+            }
+        }
+        rebuild(keeping: kept)
+        return postable
+    }
+
+    private mutating func rebuild(keeping kept: [Entry]) {
+        self = _NotificationQueuePendingList()
+        for entry in kept {
+            append(entry)
+        }
+    }
+}
+
 #endif
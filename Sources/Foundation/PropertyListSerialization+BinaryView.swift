@@ -0,0 +1,370 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+@_implementationOnly import CoreFoundation
+
+extension PropertyListSerialization {
+    /// A read-only view of a binary property list.
+    ///
+    /// Opening a view checks the header and trailer and nothing else. Objects
+    /// are read from the underlying bytes only when they are accessed. Array
+    /// elements and dictionary values are found through the offset table. The
+    /// contents of strings and data are borrowed rather than copied. A view
+    /// created with `init(contentsOf:)` maps the file, so reading a few values
+    /// out of a large property list touches only the pages that hold them.
+    public struct BinaryView : Sendable {
+        /// The top-level object of the property list.
+        public let root: Object
+
+        /// Creates a view of `data`, which must be a binary property list.
+        public init(data: Data) throws {
+            let storage = try _BinaryViewStorage(data: data)
+            guard let root = storage.object(forReference: storage.topObject) else {
+                throw _BinaryViewStorage.corruptError("Unable to read the top-level object.")
+            }
+            self.root = root
+        }
+
+        /// Creates a view of the binary property list in the file at `url`, mapping the file rather than reading it.
+        public init(contentsOf url: URL) throws {
+            try self.init(data: Data(contentsOf: url, options: .alwaysMapped))
+        }
+    }
+}
+
+extension PropertyListSerialization.BinaryView {
+    public struct Object : Sendable {
+        public enum Kind : Sendable, Equatable {
+            case null
+            case boolean
+            case integer
+            case real
+            case date
+            case data
+            case string
+            case uid
+            case array
+            case set
+            case dictionary
+        }
+
+        public let kind: Kind
+
+        /// The number of elements in an array or set, of key-value pairs in a dictionary,
+        /// of bytes in data and of UTF-16 code units in a string. Zero for anything else.
+        public let count: Int
+
+        fileprivate let storage: _BinaryViewStorage
+        fileprivate let offset: Int
+        fileprivate let marker: UInt8
+        /// Where the object's contents start, after its marker and any count.
+        fileprivate let contents: Int
+
+        public var boolValue: Bool? {
+            guard kind == .boolean else { return nil }
+            return marker == UInt8(kCFBinaryPlistMarkerTrue)
+        }
+
+        /// The value of an integer, or nil if it is not an integer or does not fit in an `Int64`.
+        public var integerValue: Int64? {
+            guard kind == .integer else { return nil }
+            let size = 1 << Int(marker & 0x0F)
+            if size < 8 {
+                return storage.withBytes { Int64(_BinaryViewStorage.readInteger($0, at: contents, size: size)) }
+            } else if size == 8 {
+                return storage.withBytes { Int64(bitPattern: _BinaryViewStorage.readInteger($0, at: contents, size: 8)) }
+            } else {
+                guard let value = unsignedIntegerValue else { return nil }
+                return Int64(exactly: value)
+            }
+        }
+
+        /// The value of a non-negative integer, or nil if it is not one.
+        public var unsignedIntegerValue: UInt64? {
+            guard kind == .integer else { return nil }
+            let size = 1 << Int(marker & 0x0F)
+            return storage.withBytes { bytes -> UInt64? in
+                if size == 16 {
+                    // Sixteen-byte integers only hold unsigned values too large for eight bytes.
+                    guard _BinaryViewStorage.readInteger(bytes, at: contents, size: 8) == 0 else { return nil }
+                    return _BinaryViewStorage.readInteger(bytes, at: contents + 8, size: 8)
+                }
+                let value = _BinaryViewStorage.readInteger(bytes, at: contents, size: size)
+                return size == 8 && Int64(bitPattern: value) < 0 ? nil : value
+            }
+        }
+
+        public var doubleValue: Double? {
+            guard kind == .real else { return nil }
+            return storage.withBytes { bytes in
+                if marker & 0x0F == 2 {
+                    return Double(Float(bitPattern: UInt32(_BinaryViewStorage.readInteger(bytes, at: contents, size: 4))))
+                } else {
+                    return Double(bitPattern: _BinaryViewStorage.readInteger(bytes, at: contents, size: 8))
+                }
+            }
+        }
+
+        public var dateValue: Date? {
+            guard kind == .date else { return nil }
+            return storage.withBytes {
+                Date(timeIntervalSinceReferenceDate: Double(bitPattern: _BinaryViewStorage.readInteger($0, at: contents, size: 8)))
+            }
+        }
+
+        public var uidValue: UInt64? {
+            guard kind == .uid else { return nil }
+            return storage.withBytes { _BinaryViewStorage.readInteger($0, at: contents, size: Int(marker & 0x0F) + 1) }
+        }
+
+        /// A copy of the contents of a string.
+        public var stringValue: String? {
+            guard kind == .string else { return nil }
+            return withUnsafeBytes { bytes -> String in
+                if marker & 0xF0 == UInt8(kCFBinaryPlistMarkerASCIIString) {
+                    return String(decoding: bytes, as: UTF8.self)
+                }
+                let units = (0..<count).map { UInt16(bytes[2 * $0]) << 8 | UInt16(bytes[2 * $0 + 1]) }
+                return String(decoding: units, as: UTF16.self)
+            }
+        }
+
+        /// The contents of data. The result shares storage with the data the view was created with.
+        public var dataValue: Data? {
+            guard kind == .data else { return nil }
+            let start = storage.data.startIndex + contents
+            return storage.data[start ..< start + count]
+        }
+
+        /// Calls `body` with the contents of data or of a string, without copying them.
+        /// The contents of a string are its ASCII characters, or its UTF-16 code units
+        /// in big-endian order if it is not ASCII. Returns nil for anything else.
+        public func withUnsafeBytes<R>(_ body: (UnsafeRawBufferPointer) throws -> R) rethrows -> R? {
+            let length: Int
+            switch kind {
+            case .data:
+                length = count
+            case .string:
+                length = marker & 0xF0 == UInt8(kCFBinaryPlistMarkerASCIIString) ? count : 2 * count
+            default:
+                return nil
+            }
+            return try storage.withBytes { bytes in
+                try body(UnsafeRawBufferPointer(rebasing: bytes[contents ..< contents + length]))
+            }
+        }
+
+        /// The element at `index` of an array or set.
+        public subscript(index: Int) -> Object? {
+            guard kind == .array || kind == .set, index >= 0, index < count else { return nil }
+            return storage.object(at: contents, index: index)
+        }
+
+        /// The value for `key` in a dictionary.
+        public subscript(key: String) -> Object? {
+            guard kind == .dictionary else { return nil }
+            // Keys stored as UTF-16 are compared with the key's UTF-16 form, made at most once.
+            var utf16: [UInt16]? = nil
+            var utf8Key = key
+            return utf8Key.withUTF8 { utf8 in
+                for index in 0..<count {
+                    if let candidate = storage.object(at: contents, index: index),
+                       candidate._equals(utf8, utf16: {
+                           if utf16 == nil { utf16 = Array(key.utf16) }
+                           return utf16!
+                       }) {
+                        return storage.object(at: contents, index: count + index)
+                    }
+                }
+                return nil
+            }
+        }
+
+        /// The key of the key-value pair at `index` in a dictionary.
+        public func key(at index: Int) -> Object? {
+            guard kind == .dictionary, index >= 0, index < count else { return nil }
+            return storage.object(at: contents, index: index)
+        }
+
+        /// The value of the key-value pair at `index` in a dictionary.
+        public func value(at index: Int) -> Object? {
+            guard kind == .dictionary, index >= 0, index < count else { return nil }
+            return storage.object(at: contents, index: count + index)
+        }
+
+        /// Creates this object, and everything it contains, as an ordinary property list.
+        public var propertyList: Any? {
+            return storage.createPropertyList(at: offset)
+        }
+
+        /// Compares a string with a key without creating a `String`. ASCII strings are
+        /// compared with the key's UTF-8 bytes, others with its UTF-16 code units.
+        private func _equals(_ utf8: UnsafeBufferPointer<UInt8>, utf16: () -> [UInt16]) -> Bool {
+            guard kind == .string else { return false }
+            if marker & 0xF0 == UInt8(kCFBinaryPlistMarkerASCIIString) {
+                return withUnsafeBytes { $0.elementsEqual(utf8) } ?? false
+            }
+            // A key has at least as many UTF-8 bytes as UTF-16 code units.
+            guard count <= utf8.count else { return false }
+            let units = utf16()
+            guard count == units.count else { return false }
+            return withUnsafeBytes { bytes -> Bool in
+                for index in 0..<count where units[index] != UInt16(bytes[2 * index]) << 8 | UInt16(bytes[2 * index + 1]) {
+                    return false
+                }
+                return true
+            } ?? false
+        }
+    }
+}
+
+/// The bytes of a binary property list and the values from its trailer.
+private final class _BinaryViewStorage : @unchecked Sendable {
+    let data: Data
+    let trailer: CFBinaryPlistTrailer
+    let offsetIntSize: Int
+    let objectRefSize: Int
+    let numObjects: UInt64
+    let topObject: UInt64
+    let offsetTableOffset: Int
+
+    static func corruptError(_ description: String) -> Error {
+        return NSError(domain: NSCocoaErrorDomain, code: CocoaError.propertyListReadCorrupt.rawValue, userInfo: [
+            NSDebugDescriptionErrorKey : description
+        ])
+    }
+
+    init(data: Data) throws {
+        var trailer = CFBinaryPlistTrailer()
+        let valid = data.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) -> Bool in
+            guard let bytes = buffer.baseAddress?.assumingMemoryBound(to: UInt8.self) else { return false }
+            var marker: UInt8 = 0
+            var offset: UInt64 = 0
+            return __CFBinaryPlistGetTopLevelInfo(bytes, UInt64(buffer.count), &marker, &offset, &trailer)
+        }
+        guard valid else {
+            throw _BinaryViewStorage.corruptError("The data is not a binary property list.")
+        }
+        self.data = data
+        self.trailer = trailer
+        self.offsetIntSize = Int(trailer._offsetIntSize)
+        self.objectRefSize = Int(trailer._objectRefSize)
+        self.numObjects = trailer._numObjects
+        self.topObject = trailer._topObject
+        self.offsetTableOffset = Int(trailer._offsetTableOffset)
+    }
+
+    func withBytes<R>(_ body: (UnsafeRawBufferPointer) throws -> R) rethrows -> R {
+        return try data.withUnsafeBytes(body)
+    }
+
+    /// Reads a big-endian unsigned integer of `size` bytes, which has already been bounds-checked.
+    static func readInteger(_ bytes: UnsafeRawBufferPointer, at offset: Int, size: Int) -> UInt64 {
+        var value: UInt64 = 0
+        for index in offset ..< offset + size {
+            value = value << 8 | UInt64(bytes[index])
+        }
+        return value
+    }
+
+    /// Resolves the object referred to by the `index`th reference starting at `referencesOffset`.
+    func object(at referencesOffset: Int, index: Int) -> PropertyListSerialization.BinaryView.Object? {
+        let reference = withBytes { _BinaryViewStorage.readInteger($0, at: referencesOffset + index * objectRefSize, size: objectRefSize) }
+        return object(forReference: reference)
+    }
+
+    func object(forReference reference: UInt64) -> PropertyListSerialization.BinaryView.Object? {
+        guard reference < numObjects else { return nil }
+        return withBytes { bytes -> PropertyListSerialization.BinaryView.Object? in
+            let offset = Int(_BinaryViewStorage.readInteger(bytes, at: offsetTableOffset + Int(reference) * offsetIntSize, size: offsetIntSize))
+            guard offset >= 8 && offset < offsetTableOffset else { return nil }
+            return object(bytes, at: offset)
+        }
+    }
+
+    private func object(_ bytes: UnsafeRawBufferPointer, at offset: Int) -> PropertyListSerialization.BinaryView.Object? {
+        typealias Object = PropertyListSerialization.BinaryView.Object
+        let marker = bytes[offset]
+        let low = Int(marker & 0x0F)
+
+        func make(_ kind: Object.Kind, count: Int, contents: Int, length: Int) -> Object? {
+            guard length >= 0, contents <= offsetTableOffset - length else { return nil }
+            return Object(kind: kind, count: count, storage: self, offset: offset, marker: marker, contents: contents)
+        }
+
+        // Reads the count of a variable-length object, which follows the marker as an
+        // integer when it does not fit in the marker's low nibble.
+        func readCount() -> (count: Int, contents: Int)? {
+            guard low == 0x0F else { return (low, offset + 1) }
+            guard offset + 1 < offsetTableOffset, bytes[offset + 1] & 0xF0 == UInt8(kCFBinaryPlistMarkerInt) else { return nil }
+            let size = 1 << Int(bytes[offset + 1] & 0x0F)
+            guard size <= 8, offset + 2 + size <= offsetTableOffset else { return nil }
+            let value = _BinaryViewStorage.readInteger(bytes, at: offset + 2, size: size)
+            guard value <= UInt64(offsetTableOffset) else { return nil }
+            return (Int(value), offset + 2 + size)
+        }
+
+        switch Int(marker & 0xF0) {
+        case kCFBinaryPlistMarkerNull:
+            switch Int(marker) {
+            case kCFBinaryPlistMarkerNull:
+                return make(.null, count: 0, contents: offset + 1, length: 0)
+            case kCFBinaryPlistMarkerFalse, kCFBinaryPlistMarkerTrue:
+                return make(.boolean, count: 0, contents: offset + 1, length: 0)
+            default:
+                return nil
+            }
+        case kCFBinaryPlistMarkerInt:
+            guard low <= 4 else { return nil }
+            return make(.integer, count: 0, contents: offset + 1, length: 1 << low)
+        case kCFBinaryPlistMarkerReal:
+            guard low == 2 || low == 3 else { return nil }
+            return make(.real, count: 0, contents: offset + 1, length: 1 << low)
+        case kCFBinaryPlistMarkerDate & 0xF0:
+            guard Int(marker) == kCFBinaryPlistMarkerDate else { return nil }
+            return make(.date, count: 0, contents: offset + 1, length: 8)
+        case kCFBinaryPlistMarkerUID:
+            guard low < 8 else { return nil }
+            return make(.uid, count: 0, contents: offset + 1, length: low + 1)
+        case kCFBinaryPlistMarkerData:
+            guard let header = readCount() else { return nil }
+            return make(.data, count: header.count, contents: header.contents, length: header.count)
+        case kCFBinaryPlistMarkerASCIIString:
+            guard let header = readCount() else { return nil }
+            return make(.string, count: header.count, contents: header.contents, length: header.count)
+        case kCFBinaryPlistMarkerUnicode16String:
+            guard let header = readCount() else { return nil }
+            return make(.string, count: header.count, contents: header.contents, length: 2 * header.count)
+        case kCFBinaryPlistMarkerArray:
+            guard let header = readCount() else { return nil }
+            return make(.array, count: header.count, contents: header.contents, length: header.count * objectRefSize)
+        case kCFBinaryPlistMarkerSet:
+            guard let header = readCount() else { return nil }
+            return make(.set, count: header.count, contents: header.contents, length: header.count * objectRefSize)
+        case kCFBinaryPlistMarkerDict:
+            guard let header = readCount() else { return nil }
+            return make(.dictionary, count: header.count, contents: header.contents, length: 2 * header.count * objectRefSize)
+        default:
+            return nil
+        }
+    }
+
+    func createPropertyList(at offset: Int) -> Any? {
+        var trailer = self.trailer
+        return withBytes { buffer -> Any? in
+            let bytes = buffer.baseAddress!.assumingMemoryBound(to: UInt8.self)
+            var plist: Unmanaged<AnyObject>? = nil
+            guard __CFBinaryPlistCreateObject(bytes, UInt64(buffer.count), UInt64(offset), &trailer, kCFAllocatorSystemDefault, 0, nil, &plist),
+                  let object = plist?.takeRetainedValue() else {
+                return nil
+            }
+            return __SwiftValue.fetch(nonOptional: object)
+        }
+    }
+}
@@ -265,6 +265,82 @@ extension RunLoop {
     }
 }
 
+extension RunLoop {
+    /// Counters a run loop keeps for each of its modes.
+    ///
+    /// They start from zero when a mode is first run, or when
+    /// `resetStatistics(forMode:)` is called, and are cheap enough to be kept
+    /// all the time.
+    public struct Statistics : Sendable {
+        /// How long the callouts of one kind took.
+        public struct CalloutStatistics : Sendable {
+            public var count: Int
+            public var totalDuration: TimeInterval
+            public var maxDuration: TimeInterval
+            /// The address of the function that took `maxDuration`, for symbolication.
+            public var slowestCallout: UInt?
+            /// Element 0 counts callouts that took less than a microsecond;
+            /// element n counts those that took at least 2^(n-1) and less than
+            /// 2^n microseconds, except the last, which counts everything longer.
+            public var histogram: [Int]
+
+            public var averageDuration: TimeInterval {
+                return count == 0 ? 0 : totalDuration / TimeInterval(count)
+            }
+
+            fileprivate init(_ stats: _CFRunLoopCalloutStatistics) {
+                count = Int(stats.count)
+                totalDuration = Statistics.seconds(stats.totalNanoseconds)
+                maxDuration = Statistics.seconds(stats.maxNanoseconds)
+                slowestCallout = stats.slowestCallout.map { UInt(bitPattern: $0) }
+                histogram = withUnsafeBytes(of: stats.histogram) { Array($0.bindMemory(to: UInt64.self)).map { Int($0) } }
+            }
+        }
+
+        public var wakeUps: Int
+        public var timeAsleep: TimeInterval
+        /// How long after their fire dates timers were actually fired, in total.
+        public var totalTimerLateness: TimeInterval
+        public var maxTimerLateness: TimeInterval
+
+        public var sources0: CalloutStatistics
+        public var sources1: CalloutStatistics
+        public var timers: CalloutStatistics
+        public var observers: CalloutStatistics
+
+        fileprivate init(_ stats: _CFRunLoopStatistics) {
+            wakeUps = Int(stats.wakeUps)
+            timeAsleep = Statistics.seconds(stats.nanosecondsAsleep)
+            totalTimerLateness = Statistics.seconds(stats.totalTimerLatenessNanoseconds)
+            maxTimerLateness = Statistics.seconds(stats.maxTimerLatenessNanoseconds)
+            // Imported as a tuple, in _CFRunLoopCalloutKind order.
+            let (source0, source1, timer, observer) = stats.callouts
+            sources0 = CalloutStatistics(source0)
+            sources1 = CalloutStatistics(source1)
+            timers = CalloutStatistics(timer)
+            observers = CalloutStatistics(observer)
+        }
+
+        private static func seconds(_ nanoseconds: UInt64) -> TimeInterval {
+            return TimeInterval(nanoseconds) / 1_000_000_000
+        }
+    }
+
+    /// Returns the statistics for `mode`, or the sum over all modes if `mode`
+    /// is `nil`. Returns `nil` if the run loop has never had `mode`.
+    public func statistics(forMode mode: RunLoop.Mode? = nil) -> Statistics? {
+        var stats = _CFRunLoopStatistics()
+        guard _CFRunLoopGetStatistics(_cfRunLoop, mode?._cfStringUniquingKnown, &stats) else {
+            return nil
+        }
+        return Statistics(stats)
+    }
+
+    public func resetStatistics(forMode mode: RunLoop.Mode? = nil) {
+        _CFRunLoopResetStatistics(_cfRunLoop, mode?._cfStringUniquingKnown)
+    }
+}
+
 // These exist as SPI for XCTest for now. Do not rely on their contracts or continued existence.
 
 extension RunLoop {
@@ -0,0 +1,135 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+
+/// A single measurement. `prepare` runs once, untimed, and returns the body
+/// that is timed; the body performs `operations` operations per call, so that
+/// results can be reported per operation.
+struct Benchmark {
+    var name: String
+    var operations: Int
+    var prepare: () throws -> () -> Void
+
+    init(_ name: String, operations: Int = 1, prepare: @escaping () throws -> () -> Void) {
+        self.name = name
+        self.operations = operations
+        self.prepare = prepare
+    }
+}
+
+struct BenchmarkConfiguration {
+    /// Each benchmark is sampled until at least this much time has been spent in its body...
+    var minimumTime: Double = 0.5
+    /// ...and at least this many samples have been taken...
+    var minimumSamples = 5
+    /// ...but never more than this many.
+    var maximumSamples = 10_000
+}
+
+struct BenchmarkResult {
+    var name: String
+    var operations: Int
+    /// Nanoseconds per operation for every sample, in the order they were taken.
+    var samples: [Double]
+
+    private var sorted: [Double] { samples.sorted() }
+
+    var median: Double {
+        let sorted = self.sorted
+        let middle = sorted.count / 2
+        return sorted.count % 2 == 0 ? (sorted[middle - 1] + sorted[middle]) / 2 : sorted[middle]
+    }
+
+    var minimum: Double { samples.min() ?? 0 }
+    var maximum: Double { samples.max() ?? 0 }
+    var mean: Double { samples.reduce(0, +) / Double(samples.count) }
+
+    var standardDeviation: Double {
+        guard samples.count > 1 else { return 0 }
+        let mean = self.mean
+        let variance = samples.reduce(0) { $0 + ($1 - mean) * ($1 - mean) } / Double(samples.count - 1)
+        return variance.squareRoot()
+    }
+
+    var jsonObject: [String: Any] {
+        return [
+            "name": name,
+            "operations": operations,
+            "samples": samples.count,
+            "nanosecondsPerOperation": [
+                "median": median,
+                "mean": mean,
+                "min": minimum,
+                "max": maximum,
+                "stddev": standardDeviation,
+            ],
+        ]
+    }
+}
+
+/// Keeps the optimizer from discarding work whose result is otherwise unused.
+@inline(never)
+func blackHole<T>(_ value: T) {
+    withExtendedLifetime(value) {}
+}
+
+private func nanoseconds(_ duration: Duration) -> Double {
+    let (seconds, attoseconds) = duration.components
+    return Double(seconds) * 1e9 + Double(attoseconds) / 1e9
+}
+
+func run(_ benchmark: Benchmark, configuration: BenchmarkConfiguration) throws -> BenchmarkResult {
+    let body = try benchmark.prepare()
+    let clock = ContinuousClock()
+
+    // One untimed call to fault in code and data.
+    body()
+
+    var samples: [Double] = []
+    var elapsed = 0.0
+    while samples.count < configuration.maximumSamples && (samples.count < configuration.minimumSamples || elapsed < configuration.minimumTime) {
+        let duration = clock.measure(body)
+        let ns = nanoseconds(duration)
+        elapsed += ns / 1e9
+        samples.append(ns / Double(benchmark.operations))
+    }
+    return BenchmarkResult(name: benchmark.name, operations: benchmark.operations, samples: samples)
+}
+
+/// Every benchmark in the suite, in the order they are run.
+func allBenchmarks() -> [Benchmark] {
+    return coreFoundationBenchmarks()
+        + serializationBenchmarks()
+        + valueBenchmarks()
+        + cacheBenchmarks()
+        + runLoopBenchmarks()
+        + networkingBenchmarks()
+}
+
+private func networkingBenchmarks() -> [Benchmark] {
+#if FOUNDATION_BENCHMARKS_NETWORKING
+    return httpCookieStorageBenchmarks()
+        + urlSessionBenchmarks()
+#else
+    return []
+#endif
+}
@@ -0,0 +1,48 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+
+func cacheBenchmarks() -> [Benchmark] {
+    let threadCount = 16
+    let entriesPerThread = 65_536
+
+    return [
+        Benchmark("NSCache.concurrentAccess", operations: threadCount * entriesPerThread * 3) {
+            // Each thread inserts its own keys, reads each one back and looks
+            // up an older one, while the count limit keeps evicting.
+            let keys = (0..<(threadCount * entriesPerThread)).map { NSNumber(value: $0) }
+            return {
+                nonisolated(unsafe) let cache = NSCache<NSNumber, NSNumber>()
+                cache.countLimit = 100_000
+                DispatchQueue.concurrentPerform(iterations: threadCount) { thread in
+                    let first = thread * entriesPerThread
+                    for i in 0..<entriesPerThread {
+                        let key = keys[first + i]
+                        cache.setObject(key, forKey: key, cost: 1)
+                        blackHole(cache.object(forKey: key))
+                        blackHole(cache.object(forKey: keys[first + i / 2]))
+                    }
+                }
+            }
+        },
+    ]
+}
@@ -0,0 +1,150 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+import CoreFoundation
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+
+private func makeCFString(_ string: String) -> CFString {
+    return string.utf8CString.withUnsafeBufferPointer {
+        CFStringCreateWithCString(kCFAllocatorDefault, $0.baseAddress, CFStringBuiltInEncodings.UTF8.rawValue)
+    }
+}
+
+/// Sorts 10M indexes by a pseudo-random key on at most `concurrency` threads,
+/// so that runs with increasing values show how the concurrent sort scales.
+private func sortIndexesBenchmark(concurrency: Int) -> Benchmark {
+    let count = 10_000_000
+    return Benchmark("CFSortIndexes.10M.threads\(concurrency)", operations: count) {
+        var state: UInt64 = 0x9E37_79B9_7F4A_7C15
+        let keys = (0..<count).map { _ -> UInt64 in
+            state ^= state << 13
+            state ^= state >> 7
+            state ^= state << 17
+            return state
+        }
+        let options = concurrency > 1 ? CFOptionFlags(NSSortOptions.concurrent.rawValue) : 0
+        // The sort fills in every index itself, so one buffer serves every run.
+        var indexes = [CFIndex](repeating: 0, count: count)
+        let sort = {
+            keys.withUnsafeBufferPointer { keys in
+                indexes.withUnsafeMutableBufferPointer { indexes in
+                    _CFSortIndexesWithMaximumConcurrency(indexes.baseAddress!, count, options, concurrency) { a, b in
+                        return keys[a] < keys[b] ? kCFCompareLessThan : (keys[a] == keys[b] ? kCFCompareEqualTo : kCFCompareGreaterThan)
+                    }
+                }
+            }
+        }
+        // Check the result once, outside the timed body.
+        sort()
+        precondition(zip(indexes, indexes.dropFirst()).allSatisfy { keys[$0] <= keys[$1] })
+        return sort
+    }
+}
+
+func coreFoundationBenchmarks() -> [Benchmark] {
+    let count = 10_000
+
+    // Same contents as the keys, but distinct objects, so lookups have to hash and compare.
+    let keyStrings = (0..<count).map { "com.example.preference.key-\($0)" }
+
+    return [
+        Benchmark("CFString.createWithBytes.ascii", operations: count) {
+            let bytes = keyStrings.map { Array($0.utf8) }
+            return {
+                for string in bytes {
+                    blackHole(string.withUnsafeBufferPointer {
+                        CFStringCreateWithBytes(kCFAllocatorDefault, $0.baseAddress, $0.count, CFStringBuiltInEncodings.UTF8.rawValue, false)
+                    })
+                }
+            }
+        },
+        Benchmark("CFString.createWithBytes.nonASCII", operations: count) {
+            let bytes = (0..<count).map { Array("Ünïcödé-ストリング-\($0)".utf8) }
+            return {
+                for string in bytes {
+                    blackHole(string.withUnsafeBufferPointer {
+                        CFStringCreateWithBytes(kCFAllocatorDefault, $0.baseAddress, $0.count, CFStringBuiltInEncodings.UTF8.rawValue, false)
+                    })
+                }
+            }
+        },
+        Benchmark("CFString.hash", operations: count) {
+            let strings = keyStrings.map(makeCFString)
+            return {
+                var combined: CFHashCode = 0
+                for string in strings {
+                    combined &+= CFHash(string)
+                }
+                blackHole(combined)
+            }
+        },
+        Benchmark("CFDictionary.insert", operations: count) {
+            let keys = keyStrings.map(makeCFString)
+            return {
+                var keyCallBacks = kCFTypeDictionaryKeyCallBacks
+                var valueCallBacks = kCFTypeDictionaryValueCallBacks
+                let dictionary = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &keyCallBacks, &valueCallBacks)
+                for key in keys {
+                    let pointer = unsafeBitCast(key, to: UnsafeRawPointer.self)
+                    CFDictionarySetValue(dictionary, pointer, pointer)
+                }
+                blackHole(dictionary)
+            }
+        },
+        Benchmark("CFDictionary.lookup", operations: count) {
+            var keyCallBacks = kCFTypeDictionaryKeyCallBacks
+            var valueCallBacks = kCFTypeDictionaryValueCallBacks
+            let dictionary = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &keyCallBacks, &valueCallBacks)
+            let keys = keyStrings.map(makeCFString)
+            for key in keys {
+                let pointer = unsafeBitCast(key, to: UnsafeRawPointer.self)
+                CFDictionarySetValue(dictionary, pointer, pointer)
+            }
+            let probes = keyStrings.map(makeCFString)
+            return {
+                var found = 0
+                for probe in probes where CFDictionaryGetValue(dictionary, unsafeBitCast(probe, to: UnsafeRawPointer.self)) != nil {
+                    found += 1
+                }
+                precondition(found == count)
+            }
+        },
+        Benchmark("CFArray.sortValues", operations: 100_000) {
+            var generator = SystemRandomNumberGenerator()
+            let numbers = (0..<100_000).map { _ in NSNumber(value: Int.random(in: 0..<1_000_000, using: &generator)) }
+            return {
+                let array = NSMutableArray(array: numbers)
+                array.sort(using: [NSSortDescriptor(keyPath: \NSNumber.intValue, ascending: true)])
+                blackHole(array)
+            }
+        },
+    ] + sortConcurrencies().map(sortIndexesBenchmark(concurrency:))
+}
+
+/// 1, 2, 4, ... up to the number of active processors, and at most 16, which
+/// is as many threads as a concurrent sort uses.
+private func sortConcurrencies() -> [Int] {
+    var concurrencies = [1]
+    while concurrencies.last! * 2 <= min(ProcessInfo.processInfo.activeProcessorCount, 16) {
+        concurrencies.append(concurrencies.last! * 2)
+    }
+    return concurrencies
+}
@@ -0,0 +1,71 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+#if FOUNDATION_BENCHMARKS_NETWORKING
+
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+#if canImport(SwiftFoundationNetworking)
+import SwiftFoundationNetworking
+#else
+import FoundationNetworking
+#endif
+
+func httpCookieStorageBenchmarks() -> [Benchmark] {
+    let count = 20_000
+    let expires = Date(timeIntervalSinceNow: 3_600)
+
+    func makeCookies(value: String) -> [HTTPCookie] {
+        return (0..<count).map { index in
+            HTTPCookie(properties: [
+                .name: "BenchmarkCookie\(index)",
+                .value: value,
+                .path: "/",
+                .domain: "host\(index % 100).example.com",
+                .expires: expires,
+            ])!
+        }
+    }
+
+    return [
+        // Each call inserts, replaces or removes one cookie in a jar that holds
+        // up to `count` of them, so this shows how a single change scales.
+        Benchmark("HTTPCookieStorage.setCookie.oneAtATime", operations: 3 * count) {
+            let originals = makeCookies(value: "Original")
+            let replacements = makeCookies(value: "Replaced")
+            return {
+                // An ephemeral storage, so that nothing is written to disk.
+                let storage = URLSessionConfiguration.ephemeral.httpCookieStorage!
+                for cookie in originals {
+                    storage.setCookie(cookie)
+                }
+                for cookie in replacements {
+                    storage.setCookie(cookie)
+                }
+                for cookie in replacements {
+                    storage.deleteCookie(cookie)
+                }
+                precondition(storage.cookies!.isEmpty)
+            }
+        },
+    ]
+}
+
+#endif
@@ -0,0 +1,140 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+import CoreFoundation
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+
+/// Counts callouts. Only ever touched from the thread running the run loop.
+private final class CalloutCounter : @unchecked Sendable {
+    var value = 0
+}
+
+private func runUntil(_ counter: CalloutCounter, reaches target: Int) {
+    let runLoop = RunLoop.current
+    while counter.value < target {
+        _ = runLoop.run(mode: .default, before: Date(timeIntervalSinceNow: 0.01))
+    }
+}
+
+func runLoopBenchmarks() -> [Benchmark] {
+    let count = 1_000
+
+    return [
+        Benchmark("RunLoop.timer.fire", operations: count) {
+            let counter = CalloutCounter()
+            return {
+                counter.value = 0
+                let runLoop = RunLoop.current
+                let now = Date()
+                for index in 0..<count {
+                    let timer = Timer(fire: now.addingTimeInterval(Double(index) * 1e-7), interval: 0, repeats: false) { _ in
+                        counter.value += 1
+                    }
+                    runLoop.add(timer, forMode: .default)
+                }
+                runUntil(counter, reaches: count)
+            }
+        },
+        Benchmark("RunLoop.timer.addAndInvalidate", operations: count) {
+            return {
+                let runLoop = RunLoop.current
+                let fireDate = Date(timeIntervalSinceNow: 3_600)
+                var timers: [Timer] = []
+                timers.reserveCapacity(count)
+                for _ in 0..<count {
+                    let timer = Timer(fire: fireDate, interval: 0, repeats: false) { _ in }
+                    runLoop.add(timer, forMode: .default)
+                    timers.append(timer)
+                }
+                for timer in timers {
+                    timer.invalidate()
+                }
+            }
+        },
+        Benchmark("RunLoop.timer.addCancelFire.100k", operations: 100_000) {
+            // Many timers at once, added out of fire date order, with every
+            // other one invalidated before the rest fire.
+            let manyCount = 100_000
+            var offsets = Array(0..<manyCount)
+            offsets.shuffle()
+            let counter = CalloutCounter()
+            return {
+                counter.value = 0
+                let runLoop = RunLoop.current
+                let now = Date()
+                var timers: [Timer] = []
+                timers.reserveCapacity(manyCount)
+                for offset in offsets {
+                    let timer = Timer(fire: now.addingTimeInterval(Double(offset) * 1e-7), interval: 0, repeats: false) { _ in
+                        counter.value += 1
+                    }
+                    runLoop.add(timer, forMode: .default)
+                    timers.append(timer)
+                }
+                for index in stride(from: 0, to: manyCount, by: 2) {
+                    timers[index].invalidate()
+                }
+                runUntil(counter, reaches: manyCount / 2)
+            }
+        },
+        Benchmark("RunLoop.perform", operations: count) {
+            let counter = CalloutCounter()
+            return {
+                counter.value = 0
+                let runLoop = RunLoop.current
+                for _ in 0..<count {
+                    runLoop.perform {
+                        counter.value += 1
+                    }
+                }
+                runUntil(counter, reaches: count)
+            }
+        },
+        Benchmark("CFRunLoopSource.signal", operations: count) {
+            let counter = CalloutCounter()
+            var context = CFRunLoopSourceContext(version: 0,
+                                                 info: Unmanaged.passUnretained(counter).toOpaque(),
+                                                 retain: nil,
+                                                 release: nil,
+                                                 copyDescription: nil,
+                                                 equal: nil,
+                                                 hash: nil,
+                                                 schedule: nil,
+                                                 cancel: nil,
+                                                 perform: { info in
+                                                     Unmanaged<CalloutCounter>.fromOpaque(info!).takeUnretainedValue().value += 1
+                                                 })
+            let source = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &context)
+            CFRunLoopAddSource(CFRunLoopGetCurrent(), source, kCFRunLoopDefaultMode)
+            return {
+                // Keep the counter alive for as long as the source may call out to it.
+                withExtendedLifetime(counter) {
+                    counter.value = 0
+                    for _ in 0..<count {
+                        CFRunLoopSourceSignal(source)
+                        _ = CFRunLoopRunInMode(kCFRunLoopDefaultMode, 0, true)
+                    }
+                    precondition(counter.value == count)
+                }
+            }
+        },
+    ]
+}
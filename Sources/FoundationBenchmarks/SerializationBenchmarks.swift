@@ -0,0 +1,144 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+
+/// A property list shaped like a typical API response or configuration file:
+/// an array of records with short strings, numbers, booleans and a nested
+/// array and dictionary each.
+private func sampleRecords(count: Int, includeDates: Bool) -> [Any] {
+    return (0..<count).map { index -> Any in
+        var record: [String: Any] = [
+            "id": index,
+            "name": "Record number \(index)",
+            "email": "user\(index)@example.com",
+            "score": Double(index) * 1.25,
+            "active": index % 3 != 0,
+            "tags": ["alpha", "beta", "gamma-\(index % 7)"],
+            "address": [
+                "street": "\(index) Infinite Loop",
+                "city": "Cupertino",
+                "zip": "95014",
+            ],
+        ]
+        if includeDates {
+            record["created"] = Date(timeIntervalSinceReferenceDate: Double(index) * 3_600)
+        }
+        return record
+    }
+}
+
+final class ArchivedRecord : NSObject, NSSecureCoding {
+    static var supportsSecureCoding: Bool { return true }
+
+    let identifier: Int
+    let name: String
+    let tags: [String]
+    let created: Date
+
+    init(identifier: Int) {
+        self.identifier = identifier
+        self.name = "Record number \(identifier)"
+        self.tags = ["alpha", "beta", "gamma-\(identifier % 7)"]
+        self.created = Date(timeIntervalSinceReferenceDate: Double(identifier) * 3_600)
+    }
+
+    init?(coder: NSCoder) {
+        guard let name = coder.decodeObject(of: NSString.self, forKey: "name"),
+              let tags = coder.decodeObject(of: [NSArray.self, NSString.self], forKey: "tags") as? [String],
+              let created = coder.decodeObject(of: NSDate.self, forKey: "created") else {
+            return nil
+        }
+        self.identifier = coder.decodeInteger(forKey: "identifier")
+        self.name = name as String
+        self.tags = tags
+        self.created = created as Date
+    }
+
+    func encode(with coder: NSCoder) {
+        coder.encode(identifier, forKey: "identifier")
+        coder.encode(name, forKey: "name")
+        coder.encode(tags, forKey: "tags")
+        coder.encode(created, forKey: "created")
+    }
+}
+
+func serializationBenchmarks() -> [Benchmark] {
+    let recordCount = 1_000
+
+    return [
+        Benchmark("JSONSerialization.parse", operations: recordCount) {
+            let data = try JSONSerialization.data(withJSONObject: sampleRecords(count: recordCount, includeDates: false))
+            return {
+                blackHole(try! JSONSerialization.jsonObject(with: data))
+            }
+        },
+        Benchmark("JSONSerialization.write", operations: recordCount) {
+            let records = sampleRecords(count: recordCount, includeDates: false)
+            return {
+                blackHole(try! JSONSerialization.data(withJSONObject: records))
+            }
+        },
+        Benchmark("JSONSerialization.write.sortedKeys", operations: recordCount) {
+            let records = sampleRecords(count: recordCount, includeDates: false)
+            return {
+                blackHole(try! JSONSerialization.data(withJSONObject: records, options: [.sortedKeys]))
+            }
+        },
+        Benchmark("PropertyListSerialization.parse.xml", operations: recordCount) {
+            let data = try PropertyListSerialization.data(fromPropertyList: sampleRecords(count: recordCount, includeDates: true), format: .xml, options: 0)
+            return {
+                blackHole(try! PropertyListSerialization.propertyList(from: data, format: nil))
+            }
+        },
+        Benchmark("PropertyListSerialization.parse.binary", operations: recordCount) {
+            let data = try PropertyListSerialization.data(fromPropertyList: sampleRecords(count: recordCount, includeDates: true), format: .binary, options: 0)
+            return {
+                blackHole(try! PropertyListSerialization.propertyList(from: data, format: nil))
+            }
+        },
+        Benchmark("PropertyListSerialization.write.xml", operations: recordCount) {
+            let records = sampleRecords(count: recordCount, includeDates: true)
+            return {
+                blackHole(try! PropertyListSerialization.data(fromPropertyList: records, format: .xml, options: 0))
+            }
+        },
+        Benchmark("PropertyListSerialization.write.binary", operations: recordCount) {
+            let records = sampleRecords(count: recordCount, includeDates: true)
+            return {
+                blackHole(try! PropertyListSerialization.data(fromPropertyList: records, format: .binary, options: 0))
+            }
+        },
+        Benchmark("NSKeyedArchiver.archive", operations: recordCount) {
+            let records = (0..<recordCount).map(ArchivedRecord.init(identifier:))
+            return {
+                blackHole(try! NSKeyedArchiver.archivedData(withRootObject: records, requiringSecureCoding: true))
+            }
+        },
+        Benchmark("NSKeyedUnarchiver.unarchive", operations: recordCount) {
+            let records = (0..<recordCount).map(ArchivedRecord.init(identifier:))
+            let data = try NSKeyedArchiver.archivedData(withRootObject: records, requiringSecureCoding: true)
+            return {
+                blackHole(try! NSKeyedUnarchiver.unarchivedObject(ofClasses: [NSArray.self, ArchivedRecord.self], from: data))
+            }
+        },
+    ]
+}
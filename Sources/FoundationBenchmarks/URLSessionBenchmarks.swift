@@ -0,0 +1,246 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+#if FOUNDATION_BENCHMARKS_NETWORKING
+
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+#if canImport(SwiftFoundationNetworking)
+import SwiftFoundationNetworking
+#else
+import FoundationNetworking
+#endif
+
+/// Counts completed requests. Touched from the sessions' delegate queues.
+private final class RequestCounter : @unchecked Sendable {
+    private let lock = NSLock()
+    private var value = 0
+
+    func increment() {
+        lock.lock()
+        value += 1
+        lock.unlock()
+    }
+
+    func reset() -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+        let old = value
+        value = 0
+        return old
+    }
+}
+
+#if !os(Windows)
+/// A minimal HTTP/1.1 server on the loopback interface, so that the
+/// benchmarks measure URLSession and libcurl rather than the network or
+/// another process. Every request gets the same small body back, and
+/// connections are kept alive. Requests must not have a body.
+private final class LoopbackHTTPServer : @unchecked Sendable {
+#if os(Linux) || os(Android)
+    private let sendFlags = CInt(MSG_NOSIGNAL)
+#else
+    private let sendFlags = CInt(0)
+#endif
+
+    private let listener: CInt
+    private let response: [UInt8]
+    let port: UInt16
+
+    init?(body: String) {
+#if os(Linux) && !os(Android)
+        let streamType = Int32(SOCK_STREAM.rawValue)
+#else
+        let streamType = SOCK_STREAM
+#endif
+        let listener = socket(AF_INET, streamType, Int32(IPPROTO_TCP))
+        guard listener >= 0 else { return nil }
+        var on: CInt = 1
+        _ = setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, socklen_t(MemoryLayout<CInt>.size))
+
+        var address = sockaddr_in()
+#if canImport(Darwin)
+        address.sin_len = UInt8(MemoryLayout<sockaddr_in>.size)
+#endif
+        address.sin_family = sa_family_t(AF_INET)
+        address.sin_addr.s_addr = UInt32(INADDR_LOOPBACK).bigEndian
+        var length = socklen_t(MemoryLayout<sockaddr_in>.size)
+        let isListening = withUnsafeMutablePointer(to: &address) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                bind(listener, $0, length) == 0 && listen(listener, 128) == 0 && getsockname(listener, $0, &length) == 0
+            }
+        }
+        guard isListening else {
+            close(listener)
+            return nil
+        }
+
+        self.listener = listener
+        self.port = UInt16(bigEndian: address.sin_port)
+        self.response = Array("HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: \(body.utf8.count)\r\n\r\n\(body)".utf8)
+        Thread { [self] in acceptConnections() }.start()
+    }
+
+    /// Stops accepting connections. Open ones are closed once the client closes them.
+    func stop() {
+        shutdown(listener, CInt(SHUT_RDWR))
+        close(listener)
+    }
+
+    private func acceptConnections() {
+        while true {
+            let connection = accept(listener, nil, nil)
+            guard connection >= 0 else {
+                if errno == EINTR { continue }
+                return
+            }
+#if canImport(Darwin)
+            // Don't raise SIGPIPE when writing to a connection the client closed.
+            var on: CInt = 1
+            _ = setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &on, socklen_t(MemoryLayout<CInt>.size))
+#endif
+            Thread { [self] in serve(connection) }.start()
+        }
+    }
+
+    private func serve(_ connection: CInt) {
+        defer { close(connection) }
+        var received: [UInt8] = []
+        var buffer = [UInt8](repeating: 0, count: 4096)
+        while true {
+            let count = buffer.withUnsafeMutableBytes { recv(connection, $0.baseAddress, $0.count, 0) }
+            guard count > 0 else { return }
+            received.append(contentsOf: buffer[..<count])
+            // Without a body, a request ends with the blank line after its header.
+            while let end = LoopbackHTTPServer.headerEnd(in: received) {
+                received.removeFirst(end)
+                guard sendResponse(to: connection) else { return }
+            }
+        }
+    }
+
+    private func sendResponse(to connection: CInt) -> Bool {
+        return response.withUnsafeBytes { bytes in
+            var sent = 0
+            while sent < bytes.count {
+                let result = send(connection, bytes.baseAddress! + sent, bytes.count - sent, sendFlags)
+                guard result > 0 else { return false }
+                sent += result
+            }
+            return true
+        }
+    }
+
+    private static func headerEnd(in bytes: [UInt8]) -> Int? {
+        guard bytes.count >= 4 else { return nil }
+        for index in 3..<bytes.count where bytes[index - 3] == 13 && bytes[index - 2] == 10 && bytes[index - 1] == 13 && bytes[index] == 10 {
+            return index + 1
+        }
+        return nil
+    }
+}
+#endif
+
+/// The sessions a benchmark issues its requests from, and the server it
+/// sends them to. Both are shut down once the benchmark is done with them,
+/// i.e. when its body is released.
+private final class URLSessionFixture : @unchecked Sendable {
+    let url: URL
+    let sessions: [URLSession]
+    let succeeded = RequestCounter()
+#if !os(Windows)
+    private let server: LoopbackHTTPServer?
+#endif
+
+    init(sessionCount: Int) {
+        if let string = ProcessInfo.processInfo.environment["FOUNDATION_BENCHMARKS_HTTP_URL"], let url = URL(string: string) {
+            self.url = url
+#if !os(Windows)
+            self.server = nil
+#endif
+        } else {
+#if os(Windows)
+            preconditionFailure("Set FOUNDATION_BENCHMARKS_HTTP_URL to run the URLSession benchmarks on Windows")
+#else
+            guard let server = LoopbackHTTPServer(body: "Hello, benchmark!") else {
+                preconditionFailure("Could not start a server on the loopback interface")
+            }
+            self.server = server
+            self.url = URL(string: "http://127.0.0.1:\(server.port)/")!
+#endif
+        }
+        self.sessions = (0..<sessionCount).map { _ in URLSession(configuration: .default) }
+    }
+
+    deinit {
+        for session in sessions {
+            session.finishTasksAndInvalidate()
+        }
+#if !os(Windows)
+        server?.stop()
+#endif
+    }
+
+    /// Issues `count` GET requests at once, spread over the sessions, and
+    /// waits for all of them.
+    func fetchConcurrently(count: Int) {
+        let group = DispatchGroup()
+        for index in 0..<count {
+            group.enter()
+            sessions[index % sessions.count].dataTask(with: url) { [succeeded] data, response, error in
+                if error == nil, (response as? HTTPURLResponse)?.statusCode == 200, data != nil {
+                    succeeded.increment()
+                }
+                group.leave()
+            }.resume()
+        }
+        group.wait()
+        precondition(succeeded.reset() == count, "some requests to \(url) failed")
+    }
+}
+
+/// These talk to a server started on the loopback interface. Set
+/// `FOUNDATION_BENCHMARKS_HTTP_URL` to a URL that serves a small body to
+/// measure against another server instead; on Windows that is required.
+func urlSessionBenchmarks() -> [Benchmark] {
+#if os(Windows)
+    guard ProcessInfo.processInfo.environment["FOUNDATION_BENCHMARKS_HTTP_URL"] != nil else {
+        return []
+    }
+#endif
+    let count = 2_000
+
+    func concurrentRequests(sessionCount: Int) -> () throws -> () -> Void {
+        return {
+            let fixture = URLSessionFixture(sessionCount: sessionCount)
+            return {
+                fixture.fetchConcurrently(count: count)
+            }
+        }
+    }
+
+    return [
+        Benchmark("URLSession.dataTask.concurrent.oneSession", operations: count, prepare: concurrentRequests(sessionCount: 1)),
+        Benchmark("URLSession.dataTask.concurrent.perProcessorSessions", operations: count,
+                  prepare: concurrentRequests(sessionCount: ProcessInfo.processInfo.activeProcessorCount)),
+    ]
+}
+
+#endif
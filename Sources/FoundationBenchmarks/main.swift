@@ -0,0 +1,231 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+#if canImport(Darwin)
+import Darwin
+import SwiftFoundation
+#elseif canImport(Glibc)
+import Foundation
+import Glibc
+#elseif canImport(Musl)
+import Foundation
+import Musl
+#elseif canImport(CRT)
+import Foundation
+import CRT
+#endif
+
+func help() -> Int32 {
+    print("FoundationBenchmarks: [options]\n" +
+    "Runs the Foundation benchmark suite and writes the results as JSON.\n" +
+    "Options are:\n" +
+    " -help                         show this message and exit\n" +
+    " -list                         list the benchmarks and exit\n" +
+    " -filter substring             only run benchmarks whose name contains substring;\n" +
+    "                               may be given more than once\n" +
+    " -time seconds                 minimum time to spend sampling each benchmark (default 0.5)\n" +
+    " -samples count                minimum number of samples per benchmark (default 5)\n" +
+    " -o path                       write the JSON results to path instead of stdout\n" +
+    " -baseline path                compare against the JSON results in path, and exit with\n" +
+    "                               a failure status if any benchmark regressed\n" +
+    " -threshold percent            how much slower than the baseline a benchmark's median\n" +
+    "                               may be before it counts as a regression (default 10)\n")
+    return EXIT_SUCCESS
+}
+
+enum ExecutionMode {
+    case help
+    case list
+    case run
+}
+
+struct Options {
+    var mode: ExecutionMode = .run
+    var filters: [String] = []
+    var configuration = BenchmarkConfiguration()
+    var output: String?
+    var baseline: String?
+    var threshold: Double = 10
+}
+
+enum OptionParseError : Swift.Error {
+    case unrecognizedArgument(String)
+    case missingArgument(String)
+    case invalidValue(String)
+}
+
+func parseArguments(_ args: [String]) throws -> Options {
+    var opts = Options()
+    var iterator = args.makeIterator()
+
+    func value(for option: String) throws -> String {
+        guard let value = iterator.next() else {
+            throw OptionParseError.missingArgument("\(option) requires an argument")
+        }
+        return value
+    }
+
+    func number(for option: String) throws -> Double {
+        let string = try value(for: option)
+        guard let number = Double(string), number >= 0 else {
+            throw OptionParseError.invalidValue("\(option) requires a non-negative number, not '\(string)'")
+        }
+        return number
+    }
+
+    while let arg = iterator.next() {
+        switch arg {
+            case "-help":
+                opts.mode = .help
+            case "-list":
+                opts.mode = .list
+            case "-filter":
+                opts.filters.append(try value(for: arg))
+            case "-time":
+                opts.configuration.minimumTime = try number(for: arg)
+            case "-samples":
+                opts.configuration.minimumSamples = max(1, Int(try number(for: arg)))
+            case "-o":
+                opts.output = try value(for: arg)
+            case "-baseline":
+                opts.baseline = try value(for: arg)
+            case "-threshold":
+                opts.threshold = try number(for: arg)
+            default:
+                throw OptionParseError.unrecognizedArgument(arg)
+        }
+    }
+
+    return opts
+}
+
+func writeError(_ message: String) {
+    FileHandle.standardError.write(Data((message + "\n").utf8))
+}
+
+/// Reads the median of every benchmark in a file written by a previous run.
+func loadBaseline(_ path: String) throws -> [String: Double] {
+    let data = try Data(contentsOf: URL(fileURLWithPath: path))
+    guard let document = try JSONSerialization.jsonObject(with: data) as? [String: Any],
+          let results = document["results"] as? [[String: Any]] else {
+        throw OptionParseError.invalidValue("\(path) does not contain benchmark results")
+    }
+    var medians: [String: Double] = [:]
+    for result in results {
+        if let name = result["name"] as? String,
+           let timing = result["nanosecondsPerOperation"] as? [String: Any],
+           let median = (timing["median"] as? NSNumber)?.doubleValue {
+            medians[name] = median
+        }
+    }
+    return medians
+}
+
+func runBenchmarks(_ options: Options) -> Int32 {
+    var benchmarks = allBenchmarks()
+    if !options.filters.isEmpty {
+        benchmarks = benchmarks.filter { benchmark in options.filters.contains { benchmark.name.contains($0) } }
+    }
+
+    let baseline: [String: Double]?
+    do {
+        baseline = try options.baseline.map(loadBaseline)
+    } catch {
+        writeError("could not read baseline: \(error)")
+        return EXIT_FAILURE
+    }
+
+    var results: [BenchmarkResult] = []
+    var regressions: [String] = []
+    for benchmark in benchmarks {
+        let result: BenchmarkResult
+        do {
+            result = try run(benchmark, configuration: options.configuration)
+        } catch {
+            writeError("\(benchmark.name): failed: \(error)")
+            return EXIT_FAILURE
+        }
+        results.append(result)
+
+        var line = "\(benchmark.name): \(String(format: "%.1f", result.median)) ns/op (±\(String(format: "%.1f", result.standardDeviation)), \(result.samples.count) samples)"
+        if let previous = baseline?[benchmark.name], previous > 0 {
+            let change = (result.median - previous) / previous * 100
+            line += String(format: " %+.1f%%", change)
+            if change > options.threshold {
+                regressions.append(benchmark.name)
+                line += " REGRESSION"
+            }
+        }
+        writeError(line)
+    }
+
+    let document: [String: Any] = [
+        "schemaVersion": 1,
+        "date": ISO8601DateFormatter().string(from: Date()),
+        "host": [
+            "operatingSystem": ProcessInfo.processInfo.operatingSystemVersionString,
+            "activeProcessorCount": ProcessInfo.processInfo.activeProcessorCount,
+            "physicalMemory": ProcessInfo.processInfo.physicalMemory,
+        ],
+        "configuration": [
+            "minimumTime": options.configuration.minimumTime,
+            "minimumSamples": options.configuration.minimumSamples,
+        ],
+        "results": results.map { $0.jsonObject },
+    ]
+
+    do {
+        let data = try JSONSerialization.data(withJSONObject: document, options: [.prettyPrinted, .sortedKeys])
+        if let output = options.output {
+            try data.write(to: URL(fileURLWithPath: output))
+        } else {
+            FileHandle.standardOutput.write(data)
+            FileHandle.standardOutput.write(Data("\n".utf8))
+        }
+    } catch {
+        writeError("could not write results: \(error)")
+        return EXIT_FAILURE
+    }
+
+    if !regressions.isEmpty {
+        writeError("\(regressions.count) benchmark(s) regressed by more than \(options.threshold)%: \(regressions.joined(separator: ", "))")
+        return EXIT_FAILURE
+    }
+    return EXIT_SUCCESS
+}
+
+func main() -> Int32 {
+    var args = ProcessInfo.processInfo.arguments
+    // Throw away process path
+    args.removeFirst()
+    do {
+        let opts = try parseArguments(args)
+        switch opts.mode {
+            case .help:
+                return help()
+            case .list:
+                for benchmark in allBenchmarks() {
+                    print(benchmark.name)
+                }
+                return EXIT_SUCCESS
+            case .run:
+                return runBenchmarks(opts)
+        }
+    } catch {
+        switch error as! OptionParseError {
+            case .unrecognizedArgument(let arg):
+                print("unrecognized option: \(arg)")
+                let _ = help()
+            case .missingArgument(let errorStr), .invalidValue(let errorStr):
+                print(errorStr)
+        }
+        return EXIT_FAILURE
+    }
+}
+
+exit(main())
@@ -63,9 +63,38 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
             }
             self._allCookies = newValue
         }
+        // Lets the locked helpers update a single entry without copying the whole dictionary.
+        _modify {
+            if #available(macOS 10.12, iOS 10.0, tvOS 10.0, watchOS 3.0, *) {
+                dispatchPrecondition(condition: DispatchPredicate.onQueue(self.syncQ))
+            }
+            yield &self._allCookies
+        }
     }
     private let syncQ = DispatchQueue(label: "org.swift.HTTPCookieStorage.syncQ")
 
+    /* synchronized on syncQ, along with allCookies */
+    // The keys of allCookies, bucketed by the cookie's domain without its leading dot,
+    // so that cookies(for:) only looks at the buckets of the host and its parent domains.
+    private var cookieKeysByDomain: [String: Set<String>] = [:]
+    // When the cookies that have an expiry date expire, soonest first.
+    private var expirations = CookieExpirationQueue()
+
+    /* persistence state, synchronized on syncQ */
+    // The persistent store is a property list snapshot at cookieFilePath plus a journal
+    // of the changes made since, so that a change does not rewrite the whole jar.
+    // Each snapshot has a generation, and the journal starts with the generation of the
+    // snapshot it applies to, so a journal left behind by a compaction that did not
+    // finish is never replayed on top of the snapshot that replaced it.
+    private var persistedCookieKeys: Set<String> = []
+    private var pendingJournalRecords = Data()
+    private var journalRecordCount = 0
+    private var journalHandle: FileHandle?
+    private var hasPersistentSnapshot = false
+    private var persistentGeneration = 0
+    private var journalNeedsHeader = true
+    private var isLoadingPersistentStore = false
+
     private let isEphemeral: Bool
 
     private init(cookieStorageName: String, isEphemeral: Bool = false) {
@@ -85,16 +114,74 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
         }
     }
 
+    private var cookieJournalPath: String? {
+        return cookieFilePath.map { $0 + ".journal" }
+    }
+
+    // The snapshot entry holding its generation. Cookie keys start with the cookie's
+    // domain, so they can't clash with it, and readers that predate it skip it as a
+    // cookie without a name.
+    private static let snapshotGenerationKey = "$journal"
+
     private func loadPersistedCookies() {
         guard let cookieFilePath = self.cookieFilePath, let cookiesData = try? Data(contentsOf: URL(fileURLWithPath: cookieFilePath)) else { return }
         guard let cookies = try? PropertyListSerialization.propertyList(from: cookiesData, format: nil) else { return }
-        let cookies0 = cookies as? [String: [String: Any]] ?? [:]
+        var cookies0 = cookies as? [String: [String: Any]] ?? [:]
+        let generation = cookies0.removeValue(forKey: HTTPCookieStorage.snapshotGenerationKey)?["generation"] as? Int ?? 0
+        let journal = cookieJournalPath.flatMap { try? Data(contentsOf: URL(fileURLWithPath: $0)) }
         self.syncQ.sync {
+            hasPersistentSnapshot = true
+            persistentGeneration = generation
+            isLoadingPersistentStore = true
             for (key, value) in cookies0 {
                 if let cookie = createCookie(value) {
-                    allCookies[key] = cookie
+                    lockedInsertCookie(cookie, forKey: key)
                 }
             }
+            if let journal = journal {
+                replayJournal(journal)
+            }
+            isLoadingPersistentStore = false
+
+            // Cookies that expired while we were not running are dropped from the store when it is next compacted.
+            lockedRemoveExpiredCookies()
+        }
+    }
+
+    /*!
+        @method replayJournal:
+        @abstract Applies the changes recorded in the journal since the snapshot was written.
+        @discussion Each record is a binary property list, preceded by its length as a little
+        endian UInt32. The first record has the generation of the snapshot the journal applies
+        to under "g"; a journal for any other generation is ignored. Every other record has
+        the cookie's key under "k" and, unless the record is a deletion, the cookie's
+        persistable dictionary under "c". A record cut short by a crash is ignored.
+    */
+    private func replayJournal(_ journal: Data) {
+        var offset = journal.startIndex
+        var isFirstRecord = true
+        while journal.endIndex - offset >= 4 {
+            let length = journal[offset ..< offset + 4].reversed().reduce(0) { $0 << 8 | Int($1) }
+            offset += 4
+            guard journal.endIndex - offset >= length else { break }
+            let record = journal[offset ..< offset + length]
+            offset += length
+            let plist = try? PropertyListSerialization.propertyList(from: record, format: nil) as? [String: Any]
+
+            if isFirstRecord {
+                guard plist?["g"] as? Int == persistentGeneration else { return }
+                isFirstRecord = false
+                journalNeedsHeader = false
+                continue
+            }
+            journalRecordCount += 1
+
+            guard let plist = plist, let key = plist["k"] as? String else { continue }
+            if let properties = plist["c"] as? [String: Any], let cookie = createCookie(properties) {
+                lockedInsertCookie(cookie, forKey: key)
+            } else {
+                lockedRemoveCookie(forKey: key)
+            }
         }
     }
 
@@ -174,17 +261,10 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
 
             //add or override
             let key = cookie.domain + cookie.path + cookie.name
-            if let _ = allCookies.index(forKey: key) {
-                allCookies.updateValue(cookie, forKey: key)
-            } else {
-                allCookies[key] = cookie
-            }
+            lockedInsertCookie(cookie, forKey: key)
 
             //remove stale cookies, these may include the one we just added
-            let expired = allCookies.filter { (_, value) in value.expiresDate != nil && value.expiresDate!.timeIntervalSinceNow < 0 }
-            for (key,_) in expired {
-                self.allCookies.removeValue(forKey: key)
-            }
+            lockedRemoveExpiredCookies()
 
             updatePersistentStore()
         }
@@ -207,30 +287,152 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
         return HTTPCookie(properties: cookieProperties)
     }
 
+    /*!
+        @method lockedInsertCookie:forKey:
+        @abstract Adds or replaces a cookie and records the change for the persistent store,
+        for internal callers already on syncQ.
+    */
+    private func lockedInsertCookie(_ cookie: HTTPCookie, forKey key: String) {
+        if allCookies.updateValue(cookie, forKey: key) == nil {
+            cookieKeysByDomain[HTTPCookieStorage.domainIndexKey(for: cookie), default: []].insert(key)
+        }
+        if let expiresDate = cookie.expiresDate {
+            expirations.insert(expiresDate, forKey: key)
+        }
+
+        if cookie.isPersistable {
+            persistedCookieKeys.insert(key)
+            appendJournalRecord(["k": key, "c": cookie.persistableDictionary()])
+        } else if persistedCookieKeys.remove(key) != nil {
+            appendJournalRecord(["k": key])
+        }
+    }
+
+    /*!
+        @method lockedRemoveCookie:
+        @abstract Removes a cookie and records the change for the persistent store, for
+        internal callers already on syncQ.
+    */
+    private func lockedRemoveCookie(forKey key: String) {
+        guard let cookie = allCookies.removeValue(forKey: key) else { return }
+        let domainKey = HTTPCookieStorage.domainIndexKey(for: cookie)
+        cookieKeysByDomain[domainKey]?.remove(key)
+        if cookieKeysByDomain[domainKey]?.isEmpty == true {
+            cookieKeysByDomain.removeValue(forKey: domainKey)
+        }
+
+        if persistedCookieKeys.remove(key) != nil {
+            appendJournalRecord(["k": key])
+        }
+    }
+
+    private func lockedRemoveExpiredCookies() {
+        let now = Date()
+        while let expired = expirations.popFirst(before: now) {
+            // The queue is not updated when a cookie is replaced, so check that this is still its date.
+            if allCookies[expired.key]?.expiresDate == expired.date {
+                lockedRemoveCookie(forKey: expired.key)
+            }
+        }
+        if expirations.count > 2 * allCookies.count + 64 {
+            expirations = CookieExpirationQueue(allCookies.compactMap { (key, cookie) in cookie.expiresDate.map { ($0, key) } })
+        }
+    }
+
+    private static func domainIndexKey(for cookie: HTTPCookie) -> String {
+        let domain = cookie.domain
+        return domain.hasPrefix(".") ? String(domain.dropFirst()) : domain
+    }
+
+    private func appendJournalRecord(_ record: [String: Any]) {
+        // No persistence if this is an ephemeral storage, and nothing to record while reading the store back
+        if self.isEphemeral || self.cookieFilePath == nil || isLoadingPersistentStore { return }
+
+        guard let data = HTTPCookieStorage.journalRecord(record) else { return }
+        pendingJournalRecords.append(data)
+        journalRecordCount += 1
+    }
+
+    // A journal record, framed by its length.
+    private static func journalRecord(_ record: [String: Any]) -> Data? {
+        guard let data = try? PropertyListSerialization.data(fromPropertyList: record, format: .binary, options: 0) else { return nil }
+        var framed = Data()
+        withUnsafeBytes(of: UInt32(data.count).littleEndian) { framed.append(contentsOf: $0) }
+        framed.append(data)
+        return framed
+    }
+
+    /*!
+        @method updatePersistentStore
+        @abstract Writes out the changes recorded since the last call, for internal callers
+        already on syncQ.
+        @discussion Changes are appended to the journal, so the cost of a write does not
+        grow with the number of cookies. Once the journal holds more records than there are
+        persisted cookies, the snapshot is rewritten with the next generation, which retires the
+        old journal in the same atomic write, and a new journal is started.
+    */
     private func updatePersistentStore() {
         // No persistence if this is an ephemeral storage
         if self.isEphemeral { return }
 
-        guard let cookieFilePath = self.cookieFilePath else { return }
+        guard let cookieFilePath = self.cookieFilePath, let cookieJournalPath = self.cookieJournalPath else { return }
 
         if #available(macOS 10.12, iOS 10.0, tvOS 10.0, watchOS 3.0, *) {
             dispatchPrecondition(condition: DispatchPredicate.onQueue(self.syncQ))
         }
 
-        //persist cookies
-        var persistDictionary: [String : [String : Any]] = [:]
-        let persistable = self.allCookies.filter { (_, value) in
-            value.expiresDate != nil &&
-            value.isSessionOnly == false &&
-            value.expiresDate!.timeIntervalSinceNow > 0
+        if !hasPersistentSnapshot || journalRecordCount > max(256, persistedCookieKeys.count) {
+            //persist cookies
+            var persistDictionary: [String : [String : Any]] = [:]
+            for key in persistedCookieKeys {
+                if let cookie = allCookies[key], cookie.isPersistable {
+                    persistDictionary[key] = cookie.persistableDictionary()
+                } else {
+                    persistedCookieKeys.remove(key)
+                }
+            }
+
+            let generation = persistentGeneration + 1
+            persistDictionary[HTTPCookieStorage.snapshotGenerationKey] = ["generation": generation]
+
+            let nsdict = persistDictionary as NSDictionary
+            guard nsdict.write(toFile: cookieFilePath, atomically: true) else { return }
+            hasPersistentSnapshot = true
+            persistentGeneration = generation
+
+            // The old journal is for the previous generation now, so it would be ignored
+            // even if this did not happen.
+            try? journalHandle?.close()
+            journalHandle = nil
+            journalNeedsHeader = true
+            try? FileManager.default.removeItem(atPath: cookieJournalPath)
+            pendingJournalRecords = Data()
+            journalRecordCount = 0
+            return
         }
 
-        for (key,cookie) in persistable {
-            persistDictionary[key] = cookie.persistableDictionary()
+        guard !pendingJournalRecords.isEmpty else { return }
+
+        if journalHandle == nil {
+            if journalNeedsHeader {
+                // Replaces whatever journal is there, which is for another generation.
+                guard let header = HTTPCookieStorage.journalRecord(["g": persistentGeneration]),
+                      FileManager.default.createFile(atPath: cookieJournalPath, contents: header) else { return }
+                journalNeedsHeader = false
+            }
+            journalHandle = FileHandle(forWritingAtPath: cookieJournalPath)
         }
 
-        let nsdict = persistDictionary as NSDictionary
-        _ = nsdict.write(toFile: cookieFilePath, atomically: true)
+        do {
+            guard let journalHandle = journalHandle else { return }
+            try journalHandle.seekToEnd()
+            try journalHandle.write(contentsOf: pendingJournalRecords)
+            pendingJournalRecords = Data()
+        } catch {
+            // Leave the records pending and try again next time.
+            try? journalHandle?.close()
+            journalHandle = nil
+        }
     }
 
     /*!
@@ -239,8 +441,7 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
     */
     private func lockedDeleteCookie(_ cookie: HTTPCookie) {
         let key = cookie.domain + cookie.path + cookie.name
-        self.allCookies.removeValue(forKey: key)
-        updatePersistentStore()
+        lockedRemoveCookie(forKey: key)
     }
 
     /*!
@@ -250,6 +451,7 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
     open func deleteCookie(_ cookie: HTTPCookie) {
         self.syncQ.sync {
             self.lockedDeleteCookie(cookie)
+            updatePersistentStore()
         }
     }
     
@@ -281,7 +483,22 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
     */
     open func cookies(for url: URL) -> [HTTPCookie]? {
         guard let host = url.host?.lowercased() else { return nil }
-        return Array(self.syncQ.sync(execute: {allCookies}).values.filter{ $0.validFor(host: host) })
+        return self.syncQ.sync {
+            // A cookie can only be valid for the host if its domain is the host or one of
+            // the host's parent domains, so only those buckets need to be looked at.
+            var cookies: [HTTPCookie] = []
+            var domain = Substring(host)
+            while true {
+                for key in cookieKeysByDomain[String(domain)] ?? [] {
+                    if let cookie = allCookies[key], cookie.validFor(host: host) {
+                        cookies.append(cookie)
+                    }
+                }
+                guard let dot = domain.firstIndex(of: ".") else { break }
+                domain = domain[domain.index(after: dot)...]
+            }
+            return cookies
+        }
     }
     
     /*!
@@ -317,8 +534,28 @@ open class HTTPCookieStorage: NSObject, @unchecked Sendable {
 
         //save only those cookies whose domain matches with the url.host
         let validCookies = cookies.filter { $0.validFor(host: urlHost) }
-        for cookie in validCookies {
-            setCookie(cookie)
+
+        // Subclasses may override setCookie(_:), so only skip it for this class.
+        guard type(of: self) == HTTPCookieStorage.self else {
+            for cookie in validCookies {
+                setCookie(cookie)
+            }
+            return
+        }
+
+        self.syncQ.sync {
+            guard cookieAcceptPolicy != .never else { return }
+
+            //add or override, and write the changes out together
+            for cookie in validCookies {
+                let key = cookie.domain + cookie.path + cookie.name
+                lockedInsertCookie(cookie, forKey: key)
+            }
+
+            //remove stale cookies, these may include the ones we just added
+            lockedRemoveExpiredCookies()
+
+            updatePersistentStore()
         }
     }
     
@@ -374,6 +611,12 @@ extension HTTPCookie {
         return host == domain.dropFirst() || host.hasSuffix(domain)
     }
 
+    // Whether the cookie belongs in the persistent store.
+    internal var isPersistable: Bool {
+        guard let expiresDate = expiresDate else { return false }
+        return !isSessionOnly && expiresDate.timeIntervalSinceNow > 0
+    }
+
     internal func persistableDictionary() -> [String: Any] {
         var properties: [String: Any] = [:]
         properties[HTTPCookiePropertyKey.name.rawValue] = name
@@ -393,3 +636,59 @@ extension HTTPCookie {
         return properties
     }
 }
+
+/// A min-heap of cookie expiry dates. A cookie that is replaced or deleted keeps its
+/// entry, so whoever pops an entry checks it against the cookie that is stored now.
+private struct CookieExpirationQueue {
+    private var heap: [(date: Date, key: String)] = []
+
+    init() {}
+
+    init(_ entries: [(Date, String)]) {
+        heap = entries.map { (date: $0.0, key: $0.1) }
+        for index in stride(from: heap.count / 2 - 1, through: 0, by: -1) {
+            siftDown(from: index)
+        }
+    }
+
+    var count: Int {
+        return heap.count
+    }
+
+    mutating func insert(_ date: Date, forKey key: String) {
+        heap.append((date: date, key: key))
+        var child = heap.count - 1
+        while child > 0 {
+            let parent = (child - 1) / 2
+            guard heap[child].date < heap[parent].date else { break }
+            heap.swapAt(child, parent)
+            child = parent
+        }
+    }
+
+    // Removes and returns the soonest entry if it is before the given date.
+    mutating func popFirst(before date: Date) -> (date: Date, key: String)? {
+        guard let first = heap.first, first.date < date else { return nil }
+        heap.swapAt(0, heap.count - 1)
+        heap.removeLast()
+        siftDown(from: 0)
+        return first
+    }
+
+    private mutating func siftDown(from index: Int) {
+        var parent = index
+        while true {
+            var smallest = parent
+            let left = 2 * parent + 1, right = left + 1
+            if left < heap.count && heap[left].date < heap[smallest].date {
+                smallest = left
+            }
+            if right < heap.count && heap[right].date < heap[smallest].date {
+                smallest = right
+            }
+            guard smallest != parent else { return }
+            heap.swapAt(parent, smallest)
+            parent = smallest
+        }
+    }
+}
@@ -49,38 +49,6 @@ extension URLCache {
     }
 }
 
-class StoredCachedURLResponse: NSObject, NSSecureCoding {
-    class var supportsSecureCoding: Bool { return true }
-    
-    func encode(with aCoder: NSCoder) {
-        aCoder.encode(cachedURLResponse.response, forKey: "response")
-        aCoder.encode(cachedURLResponse.data._bridgeToObjectiveC(), forKey: "data")
-        aCoder.encode(Int(bitPattern: cachedURLResponse.storagePolicy.rawValue), forKey: "storagePolicy")
-        aCoder.encode(cachedURLResponse.userInfo as NSDictionary?, forKey: "userInfo")
-        aCoder.encode(cachedURLResponse.date as NSDate, forKey: "date")
-    }
-    
-    required init?(coder aDecoder: NSCoder) {
-        guard let response = aDecoder.decodeObject(of: URLResponse.self, forKey: "response"),
-              let data = aDecoder.decodeObject(of: NSData.self, forKey: "data"),
-            let storagePolicy = URLCache.StoragePolicy(rawValue: UInt(bitPattern: aDecoder.decodeInteger(forKey: "storagePolicy"))),
-              let date = aDecoder.decodeObject(of: NSDate.self, forKey: "date") else {
-                return nil
-        }
-        
-        let userInfo = aDecoder.decodeObject(of: NSDictionary.self, forKey: "userInfo") as? [AnyHashable: Any]
-        
-        cachedURLResponse = CachedURLResponse(response: response, data: Data(data), userInfo: userInfo, storagePolicy: storagePolicy)
-        cachedURLResponse.date = date as Date
-    }
-    
-    let cachedURLResponse: CachedURLResponse
-    
-    init(cachedURLResponse: CachedURLResponse) {
-        self.cachedURLResponse = cachedURLResponse
-    }
-}
-
 /*!
     @class CachedURLResponse
     CachedURLResponse is a class whose objects functions as a wrapper for
@@ -235,13 +203,17 @@ open class URLCache : NSObject, @unchecked Sendable {
         }
     }
     
-    private let cacheDirectory: URL?
+    private let diskStore: URLCacheDiskStore?
     
-    private struct CacheEntry: Hashable {
-        var identifier: String
-        var cachedURLResponse: CachedURLResponse
-        var date: Date
-        var cost: Int
+    private final class CacheEntry {
+        let identifier: String
+        let cachedURLResponse: CachedURLResponse
+        let date: Date
+        let cost: Int
+        
+        // Neighbours in inMemoryCacheContents' recency order.
+        var moreRecentlyUsed: CacheEntry?
+        var lessRecentlyUsed: CacheEntry?
         
         init(identifier: String, cachedURLResponse: CachedURLResponse, serializedVersion: Data? = nil) {
             self.identifier = identifier
@@ -250,54 +222,89 @@ open class URLCache : NSObject, @unchecked Sendable {
             // Estimate cost if we haven't already had to serialize this.
             self.cost = serializedVersion?.count ?? (cachedURLResponse.data.count + 500 * (cachedURLResponse.userInfo?.count ?? 0))
         }
-        
-        func hash(into hasher: inout Hasher) {
-            hasher.combine(identifier)
-        }
-        
-        static func ==(_ lhs: CacheEntry, _ rhs: CacheEntry) -> Bool {
-            return lhs.identifier == rhs.identifier
-        }
     }
     
+    /// Counters for the in-memory tier, since the cache was created.
+    public struct MemoryCacheStatistics: Equatable, Sendable {
+        /// Lookups answered from memory.
+        public var hits = 0
+        /// Lookups that had to go to disk, whether or not the disk had the response.
+        public var misses = 0
+        /// Entries dropped to stay within `memoryCapacity`.
+        public var evictions = 0
+    }
+    
+    // The entries form a doubly linked list from least to most recently used, so
+    // that storing, promoting and evicting one is O(1); the running total of their
+    // costs spares summing them up on every store.
     private let inMemoryCacheLock = NSLock()
-    private var inMemoryCacheOrder: [String] = []
     private var inMemoryCacheContents: [String: CacheEntry] = [:]
+    private var inMemoryCacheLeastRecentlyUsed: CacheEntry?
+    private var inMemoryCacheMostRecentlyUsed: CacheEntry?
+    private var inMemoryCacheTotalCost = 0
+    private var inMemoryCacheStatistics = MemoryCacheStatistics()
     
-    func evictFromMemoryCacheAssumingLockHeld(maximumSize: Int) {
-        var totalSize = inMemoryCacheContents.values.reduce(0) { $0 + $1.cost }
-        
-        var countEvicted = 0
-        for identifier in inMemoryCacheOrder {
-            if totalSize > maximumSize {
-                countEvicted += 1
-                let entry = inMemoryCacheContents.removeValue(forKey: identifier)!
-                totalSize -= entry.cost
-            } else {
-                break
-            }
+    /// How well the in-memory tier has served lookups so far.
+    public var memoryCacheStatistics: MemoryCacheStatistics {
+        return inMemoryCacheLock.performLocked { inMemoryCacheStatistics }
+    }
+    
+    private func insertIntoMemoryCacheAssumingLockHeld(_ entry: CacheEntry) {
+        inMemoryCacheContents[entry.identifier] = entry
+        inMemoryCacheTotalCost += entry.cost
+        linkAsMostRecentlyUsedAssumingLockHeld(entry)
+    }
+    
+    private func removeFromMemoryCacheAssumingLockHeld(_ entry: CacheEntry) {
+        unlinkAssumingLockHeld(entry)
+        inMemoryCacheContents.removeValue(forKey: entry.identifier)
+        inMemoryCacheTotalCost -= entry.cost
+    }
+    
+    private func linkAsMostRecentlyUsedAssumingLockHeld(_ entry: CacheEntry) {
+        entry.lessRecentlyUsed = inMemoryCacheMostRecentlyUsed
+        entry.moreRecentlyUsed = nil
+        inMemoryCacheMostRecentlyUsed?.moreRecentlyUsed = entry
+        inMemoryCacheMostRecentlyUsed = entry
+        if inMemoryCacheLeastRecentlyUsed == nil {
+            inMemoryCacheLeastRecentlyUsed = entry
         }
-        
-        inMemoryCacheOrder.removeSubrange(0 ..< countEvicted)
     }
     
-    func evictFromDiskCache(maximumSize: Int) {
-        let entries = diskEntries(includingPropertiesForKeys: [.fileSizeKey]).sorted {
-            $0.date < $1.date
+    private func unlinkAssumingLockHeld(_ entry: CacheEntry) {
+        entry.lessRecentlyUsed?.moreRecentlyUsed = entry.moreRecentlyUsed
+        entry.moreRecentlyUsed?.lessRecentlyUsed = entry.lessRecentlyUsed
+        if entry === inMemoryCacheLeastRecentlyUsed {
+            inMemoryCacheLeastRecentlyUsed = entry.moreRecentlyUsed
         }
-        
-        let sizes = entries.map { (entry) in
-            (try? entry.url.resourceValues(forKeys: [.fileSizeKey]).fileSize) ?? 0
+        if entry === inMemoryCacheMostRecentlyUsed {
+            inMemoryCacheMostRecentlyUsed = entry.lessRecentlyUsed
         }
-
-        var totalSize = sizes.reduce(0, +)
-        
-        for (index, entry) in entries.enumerated() {
-            if totalSize > maximumSize {
-                try? FileManager.default.removeItem(at: entry.url)
-                totalSize -= sizes[index]
-            }
+        entry.lessRecentlyUsed = nil
+        entry.moreRecentlyUsed = nil
+    }
+    
+    private func removeAllFromMemoryCacheAssumingLockHeld() {
+        // Break the links between entries so that they can be freed.
+        while let entry = inMemoryCacheLeastRecentlyUsed {
+            inMemoryCacheLeastRecentlyUsed = entry.moreRecentlyUsed
+            entry.lessRecentlyUsed = nil
+            entry.moreRecentlyUsed = nil
         }
+        inMemoryCacheMostRecentlyUsed = nil
+        inMemoryCacheContents = [:]
+        inMemoryCacheTotalCost = 0
+    }
+    
+    func evictFromMemoryCacheAssumingLockHeld(maximumSize: Int) {
+        while inMemoryCacheTotalCost > maximumSize, let entry = inMemoryCacheLeastRecentlyUsed {
+            removeFromMemoryCacheAssumingLockHeld(entry)
+            inMemoryCacheStatistics.evictions += 1
+        }
+    }
+    
+    func evictFromDiskCache(maximumSize: Int) {
+        diskStore?.evict(maximumSize: maximumSize)
     }
     
     /*! 
@@ -342,12 +349,18 @@ open class URLCache : NSObject, @unchecked Sendable {
         if let url = url {
             do {
                 try FileManager.default.createDirectory(at: url, withIntermediateDirectories: true)
-                cacheDirectory = url
+                diskStore = URLCacheDiskStore(directory: url)
             } catch {
-                cacheDirectory = nil
+                diskStore = nil
             }
         } else {
-            cacheDirectory = nil
+            diskStore = nil
+        }
+    }
+    
+    deinit {
+        inMemoryCacheLock.performLocked {
+            removeAllFromMemoryCacheAssumingLockHeld()
         }
     }
     
@@ -370,84 +383,6 @@ open class URLCache : NSObject, @unchecked Sendable {
         }
     }
     
-    private struct DiskEntry {
-        static let pathExtension = "storedcachedurlresponse"
-        
-        var url: URL
-        var date: Date
-        var identifier: String
-        
-        init?(_ url: URL) {
-            if url.pathExtension.caseInsensitiveCompare(DiskEntry.pathExtension) != .orderedSame {
-                return nil
-            }
-            
-            let parts = url.deletingPathExtension().lastPathComponent.components(separatedBy: ".")
-            guard parts.count == 2 else { return nil }
-            let (timeString, identifier) = (parts[0], parts[1])
-            
-            guard let time = Int64(timeString) else { return nil }
-            
-            self.date = Date(timeIntervalSinceReferenceDate: TimeInterval(time))
-            self.identifier = identifier
-            self.url = url
-        }
-    }
-    
-    private func enumerateDiskEntries(includingPropertiesForKeys keys: [URLResourceKey] = [], using block: (DiskEntry, inout Bool) -> Void) {
-        guard let directory = cacheDirectory else { return }
-        for url in (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: keys)) ?? [] {
-            if let entry = DiskEntry(url) {
-                var stop = false
-                block(entry, &stop)
-                if stop {
-                    return
-                }
-            }
-        }
-    }
-    
-    private func diskEntries(includingPropertiesForKeys keys: [URLResourceKey] = []) -> [DiskEntry] {
-        var entries: [DiskEntry] = []
-        enumerateDiskEntries(includingPropertiesForKeys: keys) { (entry, stop) in
-            entries.append(entry)
-        }
-        return entries
-    }
-    
-    private func diskContentLocators(for request: URLRequest, forCreationAt date: Date? = nil) -> (identifier: String, url: URL)? {
-        guard let directory = cacheDirectory else { return nil }
-        guard let identifier = self.identifier(for: request) else { return nil }
-        
-        if let date = date {
-            // Create a new URL, which may or may not exist on disk.
-            let interval = Int64(date.timeIntervalSinceReferenceDate)
-            return (identifier, directory.appendingPathComponent("\(interval).\(identifier).\(DiskEntry.pathExtension)"))
-        } else {
-            var foundURL: URL?
-            
-            enumerateDiskEntries { (entry, stop) in
-                if entry.identifier == identifier {
-                    foundURL = entry.url
-                    stop = true
-                }
-            }
-            
-            if let foundURL = foundURL {
-                return (identifier, foundURL)
-            }
-        }
-        
-        return nil
-    }
-    
-    private func diskContents(for request: URLRequest) throws -> StoredCachedURLResponse? {
-        guard let url = diskContentLocators(for: request)?.url else { return nil }
-        
-        let data = try Data(contentsOf: url)
-        return try NSKeyedUnarchiver.unarchivedObject(ofClasses: [StoredCachedURLResponse.self], from: data) as? StoredCachedURLResponse
-    }
-    
     /*! 
         @method cachedResponseForRequest:
         @abstract Returns the NSCachedURLResponse stored in the cache with
@@ -460,11 +395,18 @@ open class URLCache : NSObject, @unchecked Sendable {
         given request.
     */
     open func cachedResponse(for request: URLRequest) -> CachedURLResponse? {
+        guard let identifier = identifier(for: request) else { return nil }
+        
         let result = inMemoryCacheLock.performLocked { () -> CachedURLResponse? in
-            if let identifier = identifier(for: request),
-                let entry = inMemoryCacheContents[identifier] {
+            if let entry = inMemoryCacheContents[identifier] {
+                inMemoryCacheStatistics.hits += 1
+                if entry !== inMemoryCacheMostRecentlyUsed {
+                    unlinkAssumingLockHeld(entry)
+                    linkAsMostRecentlyUsedAssumingLockHeld(entry)
+                }
                 return entry.cachedURLResponse
             } else {
+                inMemoryCacheStatistics.misses += 1
                 return nil
             }
         }
@@ -473,8 +415,7 @@ open class URLCache : NSObject, @unchecked Sendable {
             return result
         }
         
-        guard let contents = try? diskContents(for: request) else { return nil }
-        return contents.cachedURLResponse
+        return diskStore?.cachedResponse(for: identifier)
     }
     
     /*! 
@@ -492,46 +433,23 @@ open class URLCache : NSObject, @unchecked Sendable {
         guard let identifier = identifier(for: request) else { return }
         
         // Only create a serialized version if we are writing to disk:
-        let object = StoredCachedURLResponse(cachedURLResponse: cachedResponse)
-        let serialized = (onDisk && diskCapacity > 0) ? try? NSKeyedArchiver.archivedData(withRootObject: object, requiringSecureCoding: true) : nil
+        let serialized = (onDisk && diskCapacity > 0 && diskStore != nil) ? URLCacheDiskFormat.serialize(cachedResponse, identifier: identifier) : nil
         
         let entry = CacheEntry(identifier: identifier, cachedURLResponse: cachedResponse, serializedVersion: serialized)
 
         if inMemory && entry.cost < memoryCapacity {
             inMemoryCacheLock.performLocked {
+                // A response stored again replaces the old one rather than adding to it.
+                if let existing = inMemoryCacheContents[identifier] {
+                    removeFromMemoryCacheAssumingLockHeld(existing)
+                }
                 evictFromMemoryCacheAssumingLockHeld(maximumSize: memoryCapacity - entry.cost)
-                inMemoryCacheOrder.append(identifier)
-                inMemoryCacheContents[identifier] = entry
+                insertIntoMemoryCacheAssumingLockHeld(entry)
             }
         }
         
         if onDisk, let serialized = serialized, entry.cost < diskCapacity {
-            do {
-                evictFromDiskCache(maximumSize: diskCapacity - entry.cost)
-                
-                let locators = diskContentLocators(for: request, forCreationAt: Date())
-                if let newURL = locators?.url {
-                    try serialized.write(to: newURL, options: .atomic)
-                }
-                
-                if let identifier = locators?.identifier {
-                    // Multiple threads and/or processes may be writing the same key at the same time. If writing the contents race for the exact same timestamp, we can't do much about that. (One of the two will exist, due to the .atomic; the other will error out.) But if the timestamps differ, we may end up with duplicate keys on disk.
-                    // If so, best-effort clear all entries except the one with the highest date.
-                    
-                    // Refetch a snapshot of the directory contents from disk; do not trust prior state:
-                    let entriesToRemove = diskEntries().filter {
-                        $0.identifier == identifier
-                    }.sorted {
-                        $1.date < $0.date
-                    }.dropFirst() // Keep the one with the latest date.
-                    
-                    for entry in entriesToRemove {
-                        // Do not interrupt cleanup if one fails.
-                        try? FileManager.default.removeItem(at: entry.url)
-                    }
-                }
-                
-            } catch { /* Best effort -- do not store on error. */ }
+            diskStore?.store(serialized, identifier: identifier, maximumSize: diskCapacity - entry.cost)
         }
     }
     
@@ -547,15 +465,12 @@ open class URLCache : NSObject, @unchecked Sendable {
         guard let identifier = identifier(for: request) else { return }
         
         inMemoryCacheLock.performLocked {
-            if inMemoryCacheContents[identifier] != nil {
-                inMemoryCacheOrder.removeAll(where: { $0 == identifier })
-                inMemoryCacheContents.removeValue(forKey: identifier)
+            if let entry = inMemoryCacheContents[identifier] {
+                removeFromMemoryCacheAssumingLockHeld(entry)
             }
         }
         
-        if let oldURL = diskContentLocators(for: request)?.url {
-            try? FileManager.default.removeItem(at: oldURL)
-        }
+        diskStore?.removeEntry(for: identifier)
     }
     
     /*! 
@@ -565,8 +480,7 @@ open class URLCache : NSObject, @unchecked Sendable {
     */
     open func removeAllCachedResponses() {
         inMemoryCacheLock.performLocked {
-            inMemoryCacheContents = [:]
-            inMemoryCacheOrder = []
+            removeAllFromMemoryCacheAssumingLockHeld()
         }
         
         evictFromDiskCache(maximumSize: 0)
@@ -578,28 +492,12 @@ open class URLCache : NSObject, @unchecked Sendable {
      */
     open func removeCachedResponses(since date: Date) {
         inMemoryCacheLock.performLocked { // Memory cache:
-            var identifiersToRemove: Set<String> = []
-            for entry in inMemoryCacheContents {
-                if entry.value.date > date {
-                    identifiersToRemove.insert(entry.key)
-                }
-            }
-            
-            for toRemove in identifiersToRemove {
-                inMemoryCacheContents.removeValue(forKey: toRemove)
+            for entry in inMemoryCacheContents.values.filter({ $0.date > date }) {
+                removeFromMemoryCacheAssumingLockHeld(entry)
             }
-            inMemoryCacheOrder.removeAll { identifiersToRemove.contains($0) }
         }
         
-        do { // Disk cache:
-            let entriesToRemove = diskEntries().filter {
-                $0.date > date
-            }
-            
-            for entry in entriesToRemove {
-                try? FileManager.default.removeItem(at: entry.url)
-            }
-        }
+        diskStore?.removeEntries(since: date) // Disk cache
     }
     
     /*! 
@@ -636,9 +534,7 @@ open class URLCache : NSObject, @unchecked Sendable {
     */
     open var currentMemoryUsage: Int {
         return inMemoryCacheLock.performLocked {
-            return inMemoryCacheContents.values.reduce(0) { (result, entry) in
-                return result + entry.cost
-            }
+            return inMemoryCacheTotalCost
         }
     }
     
@@ -651,14 +547,7 @@ open class URLCache : NSObject, @unchecked Sendable {
         @result the current usage of the on-disk cache of the receiver.
     */
     open var currentDiskUsage: Int {
-        var total = 0
-        enumerateDiskEntries(includingPropertiesForKeys: [.fileSizeKey]) { (entry, stop) in
-            if let size = (try? entry.url.resourceValues(forKeys: [.fileSizeKey]))?.fileSize {
-                total += size
-            }
-        }
-        
-        return total
+        return diskStore?.currentSize ?? 0
     }
 
     open func storeCachedResponse(_ cachedResponse: CachedURLResponse, for dataTask: URLSessionDataTask) {
@@ -681,3 +570,684 @@ open class URLCache : NSObject, @unchecked Sendable {
         removeCachedResponse(for: request)
     }
 }
+
+// MARK: - Disk storage
+
+/* Cached responses are stored one per file, named after a 64-bit hash of the
+   cache identifier. A file is self-describing, so the index can be rebuilt
+   from the directory if it is lost:
+
+       "UCR1" identifier date storagePolicy response userInfo data
+
+   An HTTPURLResponse, by far the common case, is stored field by field; any
+   other response, and the userInfo dictionary if there is one, is stored as a
+   keyed archive. Integers are little endian, strings are prefixed by their
+   UInt32 byte count and blobs by their UInt64 byte count.
+*/
+private enum URLCacheDiskFormat {
+    static let entryMagic: [UInt8] = Array("UCR1".utf8)
+    static let journalMagic: [UInt8] = Array("UCJ1".utf8)
+    
+    enum ResponseKind: UInt8 {
+        case archived = 0
+        case http = 1
+    }
+    
+    enum JournalOperation: UInt8 {
+        case store = 1
+        case remove = 2
+    }
+    
+    struct Writer {
+        private(set) var data = Data()
+        
+        mutating func write(_ value: UInt8) {
+            data.append(value)
+        }
+        
+        mutating func write(_ value: UInt32) {
+            withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+        }
+        
+        mutating func write(_ value: UInt64) {
+            withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+        }
+        
+        mutating func write(_ value: Date) {
+            write(value.timeIntervalSinceReferenceDate.bitPattern)
+        }
+        
+        mutating func write(_ value: String) {
+            let utf8 = Data(value.utf8)
+            write(UInt32(utf8.count))
+            data.append(utf8)
+        }
+        
+        mutating func writeBlob(_ value: Data) {
+            write(UInt64(value.count))
+            data.append(value)
+        }
+        
+        mutating func writeBytes<Bytes: Sequence>(_ value: Bytes) where Bytes.Element == UInt8 {
+            data.append(contentsOf: value)
+        }
+    }
+    
+    struct Reader {
+        let data: Data
+        private(set) var offset: Int
+        
+        init(_ data: Data) {
+            self.data = data
+            self.offset = data.startIndex
+        }
+        
+        var isAtEnd: Bool {
+            return offset >= data.endIndex
+        }
+        
+        mutating func readBytes(_ count: Int) -> Data? {
+            guard count >= 0, data.endIndex - offset >= count else { return nil }
+            defer { offset += count }
+            return data[offset ..< offset + count]
+        }
+        
+        mutating func readUInt8() -> UInt8? {
+            guard offset < data.endIndex else { return nil }
+            defer { offset += 1 }
+            return data[offset]
+        }
+        
+        mutating func readUInt32() -> UInt32? {
+            return readBytes(4)?.reversed().reduce(0) { $0 << 8 | UInt32($1) }
+        }
+        
+        mutating func readUInt64() -> UInt64? {
+            return readBytes(8)?.reversed().reduce(0) { $0 << 8 | UInt64($1) }
+        }
+        
+        mutating func readDate() -> Date? {
+            guard let bits = readUInt64() else { return nil }
+            return Date(timeIntervalSinceReferenceDate: TimeInterval(bitPattern: bits))
+        }
+        
+        mutating func readString() -> String? {
+            guard let count = readUInt32(), let bytes = readBytes(Int(count)) else { return nil }
+            return String(data: bytes, encoding: .utf8)
+        }
+        
+        mutating func readBlob() -> Data? {
+            guard let count = readUInt64(), count <= UInt64(Int.max) else { return nil }
+            return readBytes(Int(count))
+        }
+    }
+    
+    static func fnv1a64<S: Sequence>(_ bytes: S) -> UInt64 where S.Element == UInt8 {
+        var hash: UInt64 = 0xcbf29ce484222325
+        for byte in bytes {
+            hash = (hash ^ UInt64(byte)) &* 0x100000001b3
+        }
+        return hash
+    }
+    
+    static func checksum(_ bytes: Data) -> UInt32 {
+        let hash = fnv1a64(bytes)
+        return UInt32(truncatingIfNeeded: hash ^ (hash >> 32))
+    }
+    
+    static func serialize(_ cachedResponse: CachedURLResponse, identifier: String) -> Data? {
+        var writer = Writer()
+        writer.writeBytes(entryMagic)
+        writer.write(identifier)
+        writer.write(cachedResponse.date)
+        writer.write(UInt8(cachedResponse.storagePolicy.rawValue))
+        
+        let response = cachedResponse.response
+        if type(of: response) == HTTPURLResponse.self,
+           let httpResponse = response as? HTTPURLResponse,
+           let url = httpResponse.url,
+           let headerFields = httpResponse.allHeaderFields as? [String: String] {
+            writer.write(ResponseKind.http.rawValue)
+            writer.write(url.absoluteString)
+            writer.write(UInt64(bitPattern: Int64(httpResponse.statusCode)))
+            writer.write(UInt32(headerFields.count))
+            for (field, value) in headerFields {
+                writer.write(field)
+                writer.write(value)
+            }
+        } else {
+            guard let archived = try? NSKeyedArchiver.archivedData(withRootObject: response, requiringSecureCoding: true) else { return nil }
+            writer.write(ResponseKind.archived.rawValue)
+            writer.writeBlob(archived)
+        }
+        
+        if let userInfo = cachedResponse.userInfo {
+            guard let archived = try? NSKeyedArchiver.archivedData(withRootObject: userInfo as NSDictionary, requiringSecureCoding: true) else { return nil }
+            writer.write(UInt8(1))
+            writer.writeBlob(archived)
+        } else {
+            writer.write(UInt8(0))
+        }
+        
+        writer.writeBlob(cachedResponse.data)
+        return writer.data
+    }
+    
+    // Reads just enough of an entry to index it.
+    static func header(of data: Data) -> (identifier: String, date: Date)? {
+        var reader = Reader(data)
+        guard let magic = reader.readBytes(entryMagic.count), Array(magic) == entryMagic,
+              let identifier = reader.readString(),
+              let date = reader.readDate() else { return nil }
+        return (identifier, date)
+    }
+    
+    static func cachedResponse(from data: Data, identifier expectedIdentifier: String) -> CachedURLResponse? {
+        var reader = Reader(data)
+        guard let magic = reader.readBytes(entryMagic.count), Array(magic) == entryMagic,
+              let identifier = reader.readString(), identifier == expectedIdentifier,
+              let date = reader.readDate(),
+              let rawStoragePolicy = reader.readUInt8(),
+              let storagePolicy = URLCache.StoragePolicy(rawValue: UInt(rawStoragePolicy)),
+              let rawKind = reader.readUInt8(),
+              let kind = ResponseKind(rawValue: rawKind) else { return nil }
+        
+        let response: URLResponse
+        switch kind {
+        case .http:
+            guard let urlString = reader.readString(),
+                  let url = URL(string: urlString),
+                  let statusCode = reader.readUInt64(),
+                  let headerCount = reader.readUInt32() else { return nil }
+            var headerFields: [String: String] = [:]
+            for _ in 0 ..< headerCount {
+                guard let field = reader.readString(), let value = reader.readString() else { return nil }
+                headerFields[field] = value
+            }
+            guard let httpResponse = HTTPURLResponse(url: url, statusCode: Int(Int64(bitPattern: statusCode)), httpVersion: nil, headerFields: headerFields) else { return nil }
+            response = httpResponse
+        case .archived:
+            guard let archived = reader.readBlob(),
+                  let unarchived = try? NSKeyedUnarchiver.unarchivedObject(ofClass: URLResponse.self, from: archived) else { return nil }
+            response = unarchived
+        }
+        
+        var userInfo: [AnyHashable: Any]?
+        guard let hasUserInfo = reader.readUInt8() else { return nil }
+        if hasUserInfo != 0 {
+            guard let archived = reader.readBlob(),
+                  let dictionary = try? NSKeyedUnarchiver.unarchivedObject(ofClass: NSDictionary.self, from: archived) else { return nil }
+            userInfo = dictionary as? [AnyHashable: Any]
+        }
+        
+        guard let body = reader.readBlob(), reader.isAtEnd else { return nil }
+        
+        let cachedResponse = CachedURLResponse(response: response, data: Data(body), userInfo: userInfo, storagePolicy: storagePolicy)
+        cachedResponse.date = date
+        return cachedResponse
+    }
+}
+
+/* The disk half of URLCache. Next to the entry files the directory holds an
+   append-only journal of the entries that were stored and removed, in order.
+   It is replayed into an in-memory index when the cache is created, so that
+   storing, looking up and evicting a response never lists or stats the
+   directory: each costs one file write, read or removal plus at most one
+   journal append. Eviction walks the index from the least recently used end.
+   Once most of the journal's records are stale it is rewritten from the index.
+
+   Other URLCache instances, possibly in other processes, may share the
+   directory. Before every operation the journal is checked for records they
+   appended, or for having been rewritten or removed, and the index is brought
+   up to date. Recency from lookups is only recorded in memory and reaches the
+   journal when it is rewritten.
+*/
+private final class URLCacheDiskStore {
+    static let entryPathExtension = "cachedurlresponse"
+    static let legacyPathExtension = "storedcachedurlresponse"
+    static let journalFileName = "index.urlcache"
+    
+    private final class Entry {
+        let key: UInt64
+        let identifier: String
+        var size: Int
+        var date: Date
+        var previous: Entry?
+        var next: Entry?
+        
+        init(key: UInt64, identifier: String, size: Int, date: Date) {
+            self.key = key
+            self.identifier = identifier
+            self.size = size
+            self.date = date
+        }
+    }
+    
+    private let directory: URL
+    private let journalURL: URL
+    private let lock = NSLock()
+    
+    // Keyed by the hash of the identifier, which also names the entry's file.
+    private var entries: [UInt64: Entry] = [:]
+    private var leastRecentlyUsed: Entry?
+    private var mostRecentlyUsed: Entry?
+    private var totalSize = 0
+    
+    private var journal: FileHandle?
+    private var journalIdentity: UInt64?
+    private var journalLength: UInt64 = 0
+    private var journalRecordCount = 0
+    
+    init(directory: URL) {
+        self.directory = directory
+        self.journalURL = directory.appendingPathComponent(URLCacheDiskStore.journalFileName)
+        
+        lock.performLocked {
+            if !reloadJournal() {
+                rebuildFromDirectory()
+            }
+        }
+    }
+    
+    deinit {
+        resetIndex()
+    }
+    
+    var currentSize: Int {
+        return lock.performLocked {
+            synchronize()
+            return totalSize
+        }
+    }
+    
+    func cachedResponse(for identifier: String) -> CachedURLResponse? {
+        let key = URLCacheDiskFormat.fnv1a64(identifier.utf8)
+        let found = lock.performLocked { () -> Bool in
+            synchronize()
+            guard let entry = entries[key], entry.identifier == identifier else { return false }
+            return true
+        }
+        guard found else { return nil }
+        
+        let response = (try? Data(contentsOf: fileURL(for: key))).flatMap {
+            URLCacheDiskFormat.cachedResponse(from: $0, identifier: identifier)
+        }
+        
+        lock.performLocked {
+            guard let entry = entries[key], entry.identifier == identifier else { return }
+            if response != nil {
+                unlink(entry)
+                link(entry)
+            } else {
+                // The file is missing or damaged; forget about it.
+                var records = URLCacheDiskFormat.Writer()
+                discard(entry, journalingInto: &records)
+                appendToJournal(records.data, count: 1)
+            }
+        }
+        
+        return response
+    }
+    
+    func store(_ serialized: Data, identifier: String, maximumSize: Int) {
+        let key = URLCacheDiskFormat.fnv1a64(identifier.utf8)
+        let date = Date()
+        
+        lock.performLocked {
+            synchronize()
+            
+            var records = URLCacheDiskFormat.Writer()
+            var recordCount = 0
+            
+            // The file is about to be replaced, whether it held this identifier or one that collides with it.
+            if let existing = entries[key] {
+                remove(existing)
+            }
+            recordCount += evict(maximumSize: maximumSize, journalingInto: &records)
+            
+            do {
+                try serialized.write(to: fileURL(for: key), options: .atomic)
+                
+                let entry = Entry(key: key, identifier: identifier, size: serialized.count, date: date)
+                insert(entry)
+                appendRecord(.store, identifier: identifier, size: entry.size, date: date, to: &records)
+                recordCount += 1
+            } catch { /* Best effort -- do not store on error. */ }
+            
+            appendToJournal(records.data, count: recordCount)
+        }
+    }
+    
+    func removeEntry(for identifier: String) {
+        let key = URLCacheDiskFormat.fnv1a64(identifier.utf8)
+        
+        lock.performLocked {
+            synchronize()
+            guard let entry = entries[key], entry.identifier == identifier else { return }
+            
+            var records = URLCacheDiskFormat.Writer()
+            discard(entry, journalingInto: &records)
+            appendToJournal(records.data, count: 1)
+        }
+    }
+    
+    func removeEntries(since date: Date) {
+        lock.performLocked {
+            synchronize()
+            
+            var records = URLCacheDiskFormat.Writer()
+            var recordCount = 0
+            for entry in entries.values.filter({ $0.date > date }) {
+                discard(entry, journalingInto: &records)
+                recordCount += 1
+            }
+            appendToJournal(records.data, count: recordCount)
+        }
+    }
+    
+    func evict(maximumSize: Int) {
+        lock.performLocked {
+            synchronize()
+            
+            var records = URLCacheDiskFormat.Writer()
+            let recordCount = evict(maximumSize: maximumSize, journalingInto: &records)
+            appendToJournal(records.data, count: recordCount)
+        }
+    }
+    
+    // MARK: Index
+    
+    private func fileURL(for key: UInt64) -> URL {
+        let hex = String(key, radix: 16)
+        let name = String(repeating: "0", count: 16 - hex.count) + hex
+        return directory.appendingPathComponent(name).appendingPathExtension(URLCacheDiskStore.entryPathExtension)
+    }
+    
+    // Appends entry as the most recently used one.
+    private func link(_ entry: Entry) {
+        entry.previous = mostRecentlyUsed
+        entry.next = nil
+        mostRecentlyUsed?.next = entry
+        mostRecentlyUsed = entry
+        if leastRecentlyUsed == nil {
+            leastRecentlyUsed = entry
+        }
+    }
+    
+    private func unlink(_ entry: Entry) {
+        entry.previous?.next = entry.next
+        entry.next?.previous = entry.previous
+        if entry === leastRecentlyUsed {
+            leastRecentlyUsed = entry.next
+        }
+        if entry === mostRecentlyUsed {
+            mostRecentlyUsed = entry.previous
+        }
+        entry.previous = nil
+        entry.next = nil
+    }
+    
+    private func insert(_ entry: Entry) {
+        if let existing = entries[entry.key] {
+            unlink(existing)
+            totalSize -= existing.size
+        }
+        entries[entry.key] = entry
+        link(entry)
+        totalSize += entry.size
+    }
+    
+    private func remove(_ entry: Entry) {
+        unlink(entry)
+        entries.removeValue(forKey: entry.key)
+        totalSize -= entry.size
+    }
+    
+    // Removes the entry along with its file, and journals that.
+    private func discard(_ entry: Entry, journalingInto records: inout URLCacheDiskFormat.Writer) {
+        remove(entry)
+        // Do not interrupt cleanup if one fails.
+        try? FileManager.default.removeItem(at: fileURL(for: entry.key))
+        appendRecord(.remove, identifier: entry.identifier, to: &records)
+    }
+    
+    // Returns the number of journal records written.
+    private func evict(maximumSize: Int, journalingInto records: inout URLCacheDiskFormat.Writer) -> Int {
+        var count = 0
+        while totalSize > maximumSize, let entry = leastRecentlyUsed {
+            discard(entry, journalingInto: &records)
+            count += 1
+        }
+        return count
+    }
+    
+    private func resetIndex() {
+        // Entries link to each other in both directions; break the cycles.
+        while let entry = leastRecentlyUsed {
+            leastRecentlyUsed = entry.next
+            entry.previous = nil
+            entry.next = nil
+        }
+        mostRecentlyUsed = nil
+        entries.removeAll()
+        totalSize = 0
+        
+        try? journal?.close()
+        journal = nil
+        journalIdentity = nil
+        journalLength = 0
+        journalRecordCount = 0
+    }
+    
+    // If the journal is lost, the entry files themselves say what they hold. This
+    // is also how entries written by older versions of this class are cleaned up.
+    private func rebuildFromDirectory() {
+        resetIndex()
+        
+        let urls = (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)) ?? []
+        var found: [Entry] = []
+        for url in urls {
+            let pathExtension = url.pathExtension
+            if pathExtension.caseInsensitiveCompare(URLCacheDiskStore.legacyPathExtension) == .orderedSame {
+                try? FileManager.default.removeItem(at: url)
+                continue
+            }
+            guard pathExtension == URLCacheDiskStore.entryPathExtension,
+                  let data = try? Data(contentsOf: url, options: .alwaysMapped),
+                  let header = URLCacheDiskFormat.header(of: data) else { continue }
+            
+            let key = URLCacheDiskFormat.fnv1a64(header.identifier.utf8)
+            guard url.lastPathComponent == fileURL(for: key).lastPathComponent else {
+                try? FileManager.default.removeItem(at: url)
+                continue
+            }
+            found.append(Entry(key: key, identifier: header.identifier, size: data.count, date: header.date))
+        }
+        
+        for entry in found.sorted(by: { $0.date < $1.date }) {
+            insert(entry)
+        }
+        
+        if !entries.isEmpty {
+            rewriteJournal()
+        }
+    }
+    
+    // MARK: Journal
+    
+    /* The journal starts with "UCJ1", followed by records of the form
+     
+           operation:UInt8 length:UInt32 payload checksum:UInt32
+     
+       A store payload is the entry's size, date and identifier; a remove
+       payload is just the identifier.
+    */
+    
+    private func appendRecord(_ operation: URLCacheDiskFormat.JournalOperation, identifier: String, size: Int = 0, date: Date = .distantPast, to records: inout URLCacheDiskFormat.Writer) {
+        var payload = URLCacheDiskFormat.Writer()
+        if operation == .store {
+            payload.write(UInt64(size))
+            payload.write(date)
+        }
+        payload.writeBytes(identifier.utf8)
+        
+        records.write(operation.rawValue)
+        records.write(UInt32(payload.data.count))
+        records.writeBytes(payload.data)
+        records.write(URLCacheDiskFormat.checksum(payload.data))
+    }
+    
+    // Applies the complete records in data to the index. Returns the number of bytes
+    // consumed, which stops short of a record that is still being written, or nil
+    // if the journal is damaged.
+    private func replay(_ data: Data) -> Int? {
+        var reader = URLCacheDiskFormat.Reader(data)
+        var consumed = 0
+        while !reader.isAtEnd {
+            guard let rawOperation = reader.readUInt8(),
+                  let length = reader.readUInt32(),
+                  let payload = reader.readBytes(Int(length)),
+                  let checksum = reader.readUInt32() else {
+                // Incomplete; another writer may still be appending it.
+                break
+            }
+            guard let operation = URLCacheDiskFormat.JournalOperation(rawValue: rawOperation),
+                  checksum == URLCacheDiskFormat.checksum(payload) else { return nil }
+            
+            var payloadReader = URLCacheDiskFormat.Reader(payload)
+            switch operation {
+            case .store:
+                guard let size = payloadReader.readUInt64(), size <= UInt64(Int.max),
+                      let date = payloadReader.readDate(),
+                      let identifier = String(data: payload[payloadReader.offset...], encoding: .utf8) else { return nil }
+                let key = URLCacheDiskFormat.fnv1a64(identifier.utf8)
+                insert(Entry(key: key, identifier: identifier, size: Int(size), date: date))
+            case .remove:
+                guard let identifier = String(data: payload, encoding: .utf8) else { return nil }
+                let key = URLCacheDiskFormat.fnv1a64(identifier.utf8)
+                if let entry = entries[key], entry.identifier == identifier {
+                    remove(entry)
+                }
+            }
+            
+            journalRecordCount += 1
+            consumed = reader.offset - data.startIndex
+        }
+        return consumed
+    }
+    
+    private func journalAttributes() -> (identity: UInt64, size: UInt64)? {
+        guard let attributes = try? FileManager.default.attributesOfItem(atPath: journalURL.path) else { return nil }
+        let identity = (attributes[.systemFileNumber] as? NSNumber)?.uint64Value ?? 0
+        let size = (attributes[.size] as? NSNumber)?.uint64Value ?? 0
+        return (identity, size)
+    }
+    
+    // Replaces the index with the contents of the journal. Returns false if there is no usable journal.
+    private func reloadJournal() -> Bool {
+        resetIndex()
+        
+        guard let attributes = journalAttributes(),
+              let data = try? Data(contentsOf: journalURL) else { return false }
+        
+        let magic = URLCacheDiskFormat.journalMagic
+        guard data.count >= magic.count, Array(data.prefix(magic.count)) == magic,
+              let consumed = replay(data.dropFirst(magic.count)) else {
+            resetIndex()
+            return false
+        }
+        
+        journalIdentity = attributes.identity
+        journalLength = UInt64(magic.count + consumed)
+        return true
+    }
+    
+    // Picks up whatever other caches sharing the directory did since the last operation.
+    private func synchronize() {
+        guard let attributes = journalAttributes() else {
+            // The journal was removed, along with the entries, presumably.
+            if journalIdentity != nil {
+                resetIndex()
+            }
+            return
+        }
+        
+        if attributes.identity != journalIdentity || attributes.size < journalLength {
+            if !reloadJournal() {
+                rebuildFromDirectory()
+            }
+        } else if attributes.size > journalLength {
+            guard let handle = FileHandle(forReadingAtPath: journalURL.path) else { return }
+            defer { try? handle.close() }
+            
+            guard (try? handle.seek(toOffset: journalLength)) != nil,
+                  let tail = try? handle.readToEnd() else { return }
+            if let consumed = replay(tail) {
+                journalLength += UInt64(consumed)
+            } else {
+                rebuildFromDirectory()
+            }
+        }
+    }
+    
+    private func appendToJournal(_ records: Data, count: Int) {
+        guard count > 0 else { return }
+        
+        // Rewriting also records the new state, so there is no need to append to the old journal first.
+        if journalRecordCount + count > 2 * entries.count + 64 {
+            rewriteJournal()
+            return
+        }
+        
+        if journal == nil {
+            if journalIdentity == nil {
+                guard FileManager.default.createFile(atPath: journalURL.path, contents: Data(URLCacheDiskFormat.journalMagic)),
+                      let attributes = journalAttributes() else { return }
+                journalIdentity = attributes.identity
+                journalLength = attributes.size
+            }
+            journal = try? FileHandle(forWritingTo: journalURL)
+        }
+        
+        do {
+            guard let journal = journal else { return }
+            let end = try journal.seekToEnd()
+            try journal.write(contentsOf: records)
+            if end == journalLength {
+                journalLength += UInt64(records.count)
+            }
+            // Otherwise someone else appended in the meantime; the next synchronize() replays
+            // their records as well as ours, which is harmless.
+            journalRecordCount += count
+        } catch {
+            try? journal?.close()
+            journal = nil
+        }
+    }
+    
+    // Writes the index out as a fresh journal, in least to most recently used order.
+    private func rewriteJournal() {
+        var records = URLCacheDiskFormat.Writer()
+        records.writeBytes(URLCacheDiskFormat.journalMagic)
+        var entry = leastRecentlyUsed
+        while let current = entry {
+            appendRecord(.store, identifier: current.identifier, size: current.size, date: current.date, to: &records)
+            entry = current.next
+        }
+        
+        try? journal?.close()
+        journal = nil
+        
+        do {
+            try records.data.write(to: journalURL, options: .atomic)
+            guard let attributes = journalAttributes() else { throw CocoaError(.fileWriteUnknown) }
+            journalIdentity = attributes.identity
+            journalLength = UInt64(records.data.count)
+            journalRecordCount = entries.count
+        } catch {
+            journalIdentity = nil
+            journalLength = 0
+            journalRecordCount = 0
+        }
+    }
+}
@@ -0,0 +1,184 @@
+// Foundation/URLSession/BodyFileSink.swift - URLSession & libcurl
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+// -----------------------------------------------------------------------------
+///
+/// These are libcurl helpers for the URLSession API code.
+/// - SeeAlso: https://curl.haxx.se/libcurl/c/
+/// - SeeAlso: URLSession.swift
+///
+// -----------------------------------------------------------------------------
+
+#if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
+import SwiftFoundation
+#else
+import Foundation
+#endif
+
+@_implementationOnly import _CFURLSessionInterface
+import Dispatch
+
+
+/// Received body data that is written to a file, i.e. a download.
+///
+/// The data is written using a random access `DispatchIO` channel, so the
+/// writes themselves happen off the work queue and each one goes to the
+/// offset it belongs at. Data is collected into writes of `writeSize` bytes.
+///
+/// At most `maximumBytesInFlight` bytes are held in memory waiting to be
+/// written. Beyond that `write(copying:expectedLength:)` asks the caller to
+/// pause receiving, and the `resumeHandler` is called once enough of it has
+/// been written.
+///
+/// - Note: Calls to `write(copying:expectedLength:)` and `finish(completion:)`
+/// and callbacks from libdispatch should all happen on the same (serial)
+/// queue, and hence this code doesn't have to be thread safe.
+internal final class _BodyFileSink {
+    static var writeSize: Int { return 16 * CFURLSessionMaxWriteSize }
+    static var maximumBytesInFlight: Int { return 4 * writeSize }
+
+    let fileURL: URL
+    fileprivate let fileDescriptor: Int32
+    fileprivate let channel: DispatchIO
+    fileprivate let workQueue: DispatchQueue
+    fileprivate let resumeHandler: () -> Void
+    /// Data that has been received but not yet handed to the channel.
+    fileprivate var pending = DispatchData.empty
+    /// Where the next write goes, i.e. the number of bytes handed to the channel.
+    fileprivate var offset: off_t = 0
+    fileprivate var bytesInFlight = 0
+    fileprivate var isReceivePaused = false
+    fileprivate var isPreallocationDecided = false
+    fileprivate var preallocatedLength: off_t = 0
+    fileprivate var writeError: Int32 = 0
+
+    /// Create a new sink writing to the start of the given file.
+    ///
+    /// - Parameter fileURL: the file to write to. It has to exist.
+    /// - Parameter workQueue: the queue that it's safe to call
+    ///     `write(copying:expectedLength:)` on, and that the `resumeHandler`
+    ///     will be called on.
+    /// - Parameter resumeHandler: Will be called when receiving can carry on
+    ///     after `write(copying:expectedLength:)` asked to pause it.
+    init(fileURL: URL, workQueue: DispatchQueue, resumeHandler: @escaping () -> Void) throws {
+        let fileHandle = try FileHandle(forWritingTo: fileURL)
+        self.fileURL = fileURL
+        self.fileDescriptor = fileHandle.fileDescriptor
+        self.workQueue = workQueue
+        self.resumeHandler = resumeHandler
+        // The channel owns the file handle, and closes it once it is done with it.
+        self.channel = DispatchIO(type: .random, fileDescriptor: fileHandle.fileDescriptor,
+                                  queue: _BodyFileSink.ioQueue,
+                                  cleanupHandler: { _ in try? fileHandle.close() })
+    }
+
+    deinit {
+        channel.close()
+    }
+
+    /// The queue file maintenance runs on, so it never holds up a work queue.
+    fileprivate static let ioQueue = DispatchQueue(label: "org.swift.URLSession.BodyFileSink")
+}
+
+extension _BodyFileSink {
+    /// Copies the given bytes to be written after the ones written so far.
+    ///
+    /// - Parameter expectedLength: The length of the whole body, or a
+    ///   negative number if it isn't known. Only evaluated for the first
+    ///   bytes.
+    /// - Returns: `true` if receiving should be paused until the
+    ///   `resumeHandler` is called.
+    func write(copying bytes: UnsafeRawBufferPointer, expectedLength: @autoclosure () -> Int64) -> Bool {
+        if !isPreallocationDecided {
+            isPreallocationDecided = true
+            preallocate(length: expectedLength())
+        }
+        pending.append(bytes)
+        if pending.count >= _BodyFileSink.writeSize {
+            flush()
+        }
+        guard _BodyFileSink.maximumBytesInFlight <= bytesInFlight + pending.count else { return false }
+        isReceivePaused = true
+        return true
+    }
+
+    /// Starts the file over, for when the request is sent again and its new
+    /// response replaces what has been received so far.
+    ///
+    /// Writes that are already in flight finish first, since they were
+    /// handed to the same channel, and the file is then truncated; the
+    /// next bytes written go to the start of it.
+    func restart() {
+        pending = .empty
+        offset = 0
+        isPreallocationDecided = false
+        preallocatedLength = 0
+        let fileDescriptor = self.fileDescriptor
+        channel.barrier {
+            _ = ftruncate(fileDescriptor, 0)
+        }
+    }
+
+    /// Writes out whatever is left, and calls `completion` on the work queue
+    /// with the first error any write failed with, or 0, once the file is
+    /// complete.
+    func finish(completion: @escaping (Int32) -> Void) {
+        flush()
+        let length = offset
+        let preallocatedLength = self.preallocatedLength
+        let fileDescriptor = self.fileDescriptor
+        // The barrier runs once every write before it is done.
+        channel.barrier {
+#if os(Linux)
+            if length < preallocatedLength {
+                // The body was shorter than announced.
+                _ = ftruncate(fileDescriptor, length)
+            }
+#endif
+            self.workQueue.async {
+                completion(self.writeError)
+            }
+        }
+    }
+}
+
+extension _BodyFileSink {
+    /// Reserves space for the whole file, so that it doesn't get fragmented,
+    /// and the writes can't fail half way through for lack of space.
+    fileprivate func preallocate(length: Int64) {
+#if os(Linux)
+        guard 0 < length else { return }
+        preallocatedLength = off_t(length)
+        let fileDescriptor = self.fileDescriptor
+        channel.barrier {
+            _ = posix_fallocate(fileDescriptor, 0, off_t(length))
+        }
+#endif
+    }
+
+    fileprivate func flush() {
+        guard !pending.isEmpty else { return }
+        let data = pending
+        pending = .empty
+        bytesInFlight += data.count
+        channel.write(offset: offset, data: data, queue: workQueue) { (done: Bool, _: DispatchData?, errno: Int32) in
+            guard done else { return }
+            self.bytesInFlight -= data.count
+            if errno != 0 && self.writeError == 0 {
+                self.writeError = errno
+            }
+            if self.isReceivePaused && self.bytesInFlight <= _BodyFileSink.maximumBytesInFlight / 2 {
+                self.isReceivePaused = false
+                self.resumeHandler()
+            }
+        }
+        offset += off_t(data.count)
+    }
+}
@@ -421,7 +421,7 @@ internal class _HTTPURLProtocol: _NativeProtocol {
             // This matches Darwin.
             if case .waitingForRedirectCompletionHandler(response: let response,_) = nonisolatedSelf.internalState {
                 nonisolatedSelf.task!.response = response
-                nonisolatedSelf.easyHandle.timeoutTimer = nil
+                nonisolatedSelf.easyHandle?.timeoutTimer = nil
                 nonisolatedSelf.internalState = .taskCompleted
             } else {
                 nonisolatedSelf.internalState = .transferFailed
@@ -708,6 +708,7 @@ extension _HTTPURLProtocol {
         // as the final response, i.e. not do any redirection.
         // Otherwise, we'll start a new transfer with the passed in request.
         if let r = request {
+            task?._metrics.redirectCount += 1
             lastRedirectBody = nil
             task?.knownBody = URLSessionTask._Body.none
             startNewTransfer(with: r)
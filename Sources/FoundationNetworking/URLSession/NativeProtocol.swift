@@ -34,6 +34,11 @@ internal let enableDebugOutput: Bool = {
 
 internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
     internal var easyHandle: _EasyHandle!
+    private var easyHandlePool: URLSession._EasyHandlePool?
+    /// When the current transfer was handed to libcurl.
+    private var transferStartDate: Date?
+    /// Body bytes received in the current transfer, after decoding.
+    private var receivedBodyByteCount: Int64 = 0
     internal lazy var tempFileURL: URL = {
         let fileName = NSTemporaryDirectory() + NSUUID().uuidString + ".tmp"
         _ = FileManager.default.createFile(atPath: fileName, contents: nil)
@@ -44,7 +49,12 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
         self.internalState = .initial
         super.init(request: task.originalRequest!, cachedResponse: cachedResponse, client: client)
         self.task = task
-        self.easyHandle = _EasyHandle(delegate: self)
+        if type(of: self).reusesEasyHandle, let pool = (task.session as? URLSession)?.easyHandlePool {
+            self.easyHandlePool = pool
+            self.easyHandle = pool.makeHandle(delegate: self)
+        } else {
+            self.easyHandle = _EasyHandle(delegate: self)
+        }
     }
 
     public required init(request: URLRequest, cachedResponse: CachedURLResponse?, client: URLProtocolClient?) {
@@ -53,6 +63,28 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
         self.easyHandle = _EasyHandle(delegate: self)
     }
 
+    deinit {
+        // Only a task that never completed, e.g. one that was never resumed,
+        // still has its handle at this point.
+        recycleEasyHandle()
+    }
+
+    /// Hands the easy handle back to the session's pool, once it has been
+    /// removed from the multi handle, so that the next task can use it.
+    private func recycleEasyHandle() {
+        // A handle that is still part of a multi handle is freed along with
+        // the transfer rather than re-used.
+        guard let pool = easyHandlePool, let easyHandle = easyHandle, !internalState.isEasyHandleAddedToMultiHandle else { return }
+        self.easyHandle = nil
+        pool.recycle(easyHandle)
+    }
+
+    /// Whether the easy handle goes back to the session's pool once this
+    /// protocol is done with it.
+    class var reusesEasyHandle: Bool {
+        return true
+    }
+
     override class func canonicalRequest(for request: URLRequest) -> URLRequest {
         return request
     }
@@ -85,15 +117,22 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
         }
         didSet {
             if !oldValue.isEasyHandleAddedToMultiHandle && internalState.isEasyHandleAddedToMultiHandle {
+                transferStartDate = Date()
+                receivedBodyByteCount = 0
                 task?.session.add(handle: easyHandle)
             }
             if oldValue.isEasyHandlePaused && !internalState.isEasyHandlePaused {
                 fatalError("Need to solve pausing receive.")
             }
+            if case .taskCompleted = internalState {
+                // Whether the task succeeded or failed, the handle is done
+                // with, and willSet has taken it out of the multi handle.
+                recycleEasyHandle()
+            }
         }
     }
 
-    func didReceive(data: Data) -> _EasyHandle._Action {
+    func didReceive(bytes: UnsafeRawBufferPointer) -> _EasyHandle._Action {
         guard case .transferInProgress(var ts) = internalState else {
             fatalError("Received body data, but no transfer in progress.")
         }
@@ -101,6 +140,7 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
         if let response = validateHeaderComplete(transferState:ts) {
             ts.response = response
         }
+        receivedBodyByteCount += Int64(bytes.count)
 
         // Note this excludes code 300 which should return the response of the redirect and not follow it.
         // For other redirect codes dont notify the delegate of the data received in the redirect response.
@@ -109,17 +149,58 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
                 // Save the response body in case the delegate does not perform a redirect and the 3xx response
                 // including its body needs to be returned to the client.
                 var redirectBody = _http.lastRedirectBody ?? Data()
-                redirectBody.append(data)
+                redirectBody.append(contentsOf: bytes)
                 _http.lastRedirectBody = redirectBody
             }
             return .proceed
         }
 
-        notifyDelegate(aboutReceivedData: data)
-        internalState = .transferInProgress(ts.byAppending(bodyData: data))
+        // This is the one copy made of the body: it goes straight into the
+        // in-memory buffer or file buffer, if there is one, and is passed on
+        // from there.
+        switch ts.bodyDataDrain {
+        case .inMemory(let body):
+            notifyDelegate(aboutReceivedData: body.append(copying: bytes, expectedLength: self.expectedBodyLength(of: ts.response)))
+        case .toFile(let sink):
+            if sink.write(copying: bytes, expectedLength: self.expectedBodyLength(of: ts.response)) {
+                // The file can't keep up; the sink resumes the transfer once
+                // it has caught up. The bytes have been taken, so libcurl must
+                // not be asked to deliver them again.
+                easyHandle.pauseReceive()
+            }
+            notifyDelegate(aboutWrittenByteCount: Int64(bytes.count))
+        case .ignore:
+            notifyDelegate(aboutReceivedData: Data(bytes))
+        }
+        internalState = .transferInProgress(ts)
         return .proceed
     }
 
+    /// The length of the body as it will be received from libcurl, or -1.
+    ///
+    /// libcurl decodes compressed bodies, so `Content-Length` only says how
+    /// long the body is if there's no `Content-Encoding`.
+    private func expectedBodyLength(of response: URLResponse?) -> Int64 {
+        guard let response = response else { return -1 }
+        if let httpResponse = response as? HTTPURLResponse,
+           httpResponse.value(forHTTPHeaderField: "Content-Encoding") != nil {
+            return -1
+        }
+        return response.expectedContentLength
+    }
+
+    /// Adds the metrics of the transfer that just completed to the task's.
+    private func collectTransactionMetrics() {
+        guard let task = task, let fetchStartDate = transferStartDate else { return }
+        let metrics = URLSessionTaskTransactionMetrics(request: task.currentRequest ?? request)
+        if case .transferInProgress(let ts) = internalState {
+            metrics.response = ts.response
+        }
+        easyHandle.fill(metrics, fetchStartDate: fetchStartDate)
+        metrics.countOfResponseBodyBytesAfterDecoding = receivedBodyByteCount
+        task._metrics.transactionMetrics.append(metrics)
+    }
+
     func validateHeaderComplete(transferState: _TransferState) -> URLResponse? {
         guard transferState.isHeaderComplete else {
             fatalError("Received body data, but the header is not complete, yet.")
@@ -140,17 +221,27 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
                 session.delegateQueue.addOperation {
                     dataDelegate.urlSession(session, dataTask: dataTask, didReceive: data)
                 }
-            } else if let downloadDelegate = delegate as? URLSessionDownloadDelegate,
-                      let downloadTask = task as? URLSessionDownloadTask {
-                let fileHandle = try! FileHandle(forWritingTo: self.tempFileURL)
-                _ = fileHandle.seekToEndOfFile()
-                fileHandle.write(data)
-                task.countOfBytesReceived  += Int64(data.count)
+            }
+        default:
+            break
+        }
+    }
+
+    fileprivate func notifyDelegate(aboutWrittenByteCount count: Int64) {
+        guard let task = self.task, let session = task.session as? URLSession else {
+            fatalError("Cannot notify")
+        }
+        switch task.session.behaviour(for: task) {
+        case .taskDelegate(let delegate),
+             .downloadCompletionHandlerWithTaskDelegate(_, let delegate):
+            if let downloadDelegate = delegate as? URLSessionDownloadDelegate,
+               let downloadTask = task as? URLSessionDownloadTask {
+                task.countOfBytesReceived  += count
                 session.delegateQueue.addOperation {
                     downloadDelegate.urlSession(
                         session,
                         downloadTask: downloadTask,
-                        didWriteData: Int64(data.count),
+                        didWriteData: count,
                         totalBytesWritten: task.countOfBytesReceived,
                         totalBytesExpectedToWrite: task.countOfBytesExpectedToReceive
                     )
@@ -219,6 +310,7 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
         // If everything went well, we will simply forward the resulting data
         // to the delegate. But in case of redirects etc. we might send another
         // request.
+        collectTransactionMetrics()
         guard error == nil else {
             internalState = .transferFailed
             failWith(error: error!, request: request)
@@ -268,22 +360,24 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
         easyHandle.timeoutTimer = nil
         // because we deregister the task with the session on internalState being set to taskCompleted
         // we need to do the latter after the delegate/handler was notified/invoked
-        if case .inMemory(let bodyData) = bodyDataDrain {
-            var data = Data()
-            if let body = bodyData {
-                withExtendedLifetime(body) {
-                    data = Data(bytes: body.bytes, count: body.length)
+        if case .inMemory(let body) = bodyDataDrain {
+            self.client?.urlProtocol(self, didLoad: body.data)
+            self.internalState = .taskCompleted
+        } else if case .toFile(let sink) = bodyDataDrain {
+            // The file is only handed over once everything has been written.
+            sink.finish { writeError in
+                guard writeError == 0 else {
+                    self.internalState = .transferFailed
+                    let error = NSError(domain: NSURLErrorDomain, code: NSURLErrorCannotWriteToFile,
+                                        userInfo: [NSUnderlyingErrorKey: NSError(domain: NSPOSIXErrorDomain, code: Int(writeError))])
+                    self.failWith(error: error, request: self.request)
+                    return
                 }
+                self.properties[.temporaryFileURL] = sink.fileURL
+                self.client?.urlProtocolDidFinishLoading(self)
+                self.internalState = .taskCompleted
             }
-            self.client?.urlProtocol(self, didLoad: data)
-            self.internalState = .taskCompleted
-        } else if case .toFile(let url, let fileHandle?) = bodyDataDrain {
-            self.properties[.temporaryFileURL] = url
-            fileHandle.closeFile()
-        } else if task is URLSessionDownloadTask {
-            let fileHandle = try! FileHandle(forWritingTo: self.tempFileURL)
-            fileHandle.closeFile()
-            self.properties[.temporaryFileURL] = self.tempFileURL
+            return
         }
         self.client?.urlProtocolDidFinishLoading(self)
         self.internalState = .taskCompleted
@@ -318,7 +412,15 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
                 switch currentTransferState.requestBodySource {
                 case is _BodyStreamSource:
                     try _InputStreamSPIForFoundationNetworkingUseOnly(inputStream).seek(to: position)
-                    let drain = self.createTransferBodyDataDrain()
+                    let drain: _DataDrain
+                    if case .toFile(let sink) = currentTransferState.bodyDataDrain {
+                        // A second sink on the same file would race the first
+                        // one's writes, so the file is started over instead.
+                        sink.restart()
+                        drain = .toFile(sink)
+                    } else {
+                        drain = self.createTransferBodyDataDrain(workQueue: task!.workQueue)
+                    }
                     let source = _BodyStreamSource(inputStream: inputStream)
                     let transferState = _TransferState(url: url, bodyDataDrain: drain, bodySource: source)
                     self.internalState = .transferInProgress(transferState)
@@ -342,10 +444,20 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
     /// The data drain.
     ///
     /// This depends on what the delegate / completion handler need.
-    fileprivate func createTransferBodyDataDrain() -> _DataDrain {
+    fileprivate func createTransferBodyDataDrain(workQueue: DispatchQueue) -> _DataDrain {
         guard let task = task else {
             fatalError()
         }
+        if task is URLSessionDownloadTask {
+            // Data needs to be written to a file (i.e. a download task).
+            let sink = try! _BodyFileSink(fileURL: self.tempFileURL, workQueue: workQueue, resumeHandler: { [weak self] in
+                // Unpause the easy handle, unless the transfer has ended in
+                // the meantime and the handle has gone on to another one.
+                guard let self = self, case .transferInProgress = self.internalState else { return }
+                self.easyHandle.unpauseReceive()
+            })
+            return .toFile(sink)
+        }
         let s = task.session as! URLSession
         switch s.behaviour(for: task) {
         case .noDelegate:
@@ -354,21 +466,22 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
             // Data will be forwarded to the delegate as we receive it, we don't
             // need to do anything about it.
             return .ignore
-        case .dataCompletionHandler,
-             .dataCompletionHandlerWithTaskDelegate:
+        case .dataCompletionHandler:
             // Data needs to be concatenated in-memory such that we can pass it
             // to the completion handler upon completion.
-            return .inMemory(nil)
+            return .inMemory(_BodyBuffer())
+        case .dataCompletionHandlerWithTaskDelegate:
+            // As above, but the task delegate is given the chunks as well.
+            return .inMemory(_BodyBuffer(handsOutChunks: true))
         case .downloadCompletionHandler,
              .downloadCompletionHandlerWithTaskDelegate:
-            // Data needs to be written to a file (i.e. a download task).
-            let fileHandle = try! FileHandle(forWritingTo: self.tempFileURL)
-            return .toFile(self.tempFileURL, fileHandle)
+            // Only download tasks have these, and they're handled above.
+            return .ignore
         }
     }
 
     func createTransferState(url: URL, body: _Body, workQueue: DispatchQueue) -> _TransferState {
-        let drain = createTransferBodyDataDrain()
+        let drain = createTransferBodyDataDrain(workQueue: workQueue)
         switch body {
         case .none:
             return _TransferState(url: url, bodyDataDrain: drain)
@@ -378,7 +491,7 @@ internal class _NativeProtocol: URLProtocol, _EasyHandleDelegate {
         case .file(let fileURL):
             let source = _BodyFileSource(fileURL: fileURL, workQueue: workQueue, dataAvailableHandler: { [weak self] in
                 // Unpause the easy handle
-                self?.easyHandle.unpauseSend()
+                self?.easyHandle?.unpauseSend()
             })
             return _TransferState(url: url, bodyDataDrain: drain,bodySource: source)
         case .stream(let inputStream):
@@ -475,7 +588,7 @@ extension _NativeProtocol {
             fatalError("Trying to complete the task, but its transfer isn't complete / failed.")
         }
         //We don't want a timeout to be triggered after this. The timeout timer needs to be cancelled.
-        easyHandle.timeoutTimer = nil
+        easyHandle?.timeoutTimer = nil
         self.internalState = .taskCompleted
     }
 
@@ -53,9 +53,9 @@ extension _NativeProtocol {
 extension _NativeProtocol {
     enum _DataDrain {
         /// Concatenate in-memory
-        case inMemory(NSMutableData?)
+        case inMemory(_BodyBuffer)
         /// Write to file
-        case toFile(URL, FileHandle?)
+        case toFile(_BodyFileSink)
         /// Do nothing. Might be forwarded to delegate
         case ignore
     }
@@ -170,28 +170,6 @@ extension _NativeProtocol._TransferState {
     var isHeaderComplete: Bool {
         return response != nil
     }
-    /// Append body data
-    ///
-    /// - Important: This will mutate the existing `NSMutableData` that the
-    ///     struct may already have in place -- copying the data is too
-    ///     expensive. This behaviour
-    func byAppending(bodyData buffer: Data) -> _NativeProtocol._TransferState {
-        switch bodyDataDrain {
-        case .inMemory(let bodyData):
-            let data: NSMutableData = bodyData ?? NSMutableData()
-            data.append(buffer)
-            let drain = _NativeProtocol._DataDrain.inMemory(data)
-            return _NativeProtocol._TransferState(url: url, parsedResponseHeader: parsedResponseHeader, response: response, requestBodySource: requestBodySource, bodyDataDrain: drain)
-        case .toFile(_, let fileHandle):
-             //TODO: Create / open the file for writing
-             // Append to the file
-             _ = fileHandle!.seekToEndOfFile()
-             fileHandle!.write(buffer)
-             return self
-        case .ignore:
-            return self
-        }
-    }
     /// Sets the given body source on the transfer state.
     ///
     /// This can be used to either set the initial body source, or to reset it
@@ -201,3 +179,103 @@ extension _NativeProtocol._TransferState {
                                               parsedResponseHeader: parsedResponseHeader, response: response, requestBodySource: newSource, bodyDataDrain: bodyDataDrain)
     }
 }
+
+extension _NativeProtocol {
+    /// Body data received into memory, kept as the chunks it arrived in.
+    ///
+    /// Each chunk is copied out of libcurl's buffer once, and the resulting
+    /// `Data` is both kept here and passed on to the delegate. When the length
+    /// of the body is known up front, the chunks are copied into consecutive
+    /// parts of a single allocation of that size, and the complete body can
+    /// then be handed over without copying it again.
+    ///
+    /// The chunks kept here and the complete body share that allocation, so
+    /// they must never be handed to anyone who could mutate them. If the
+    /// chunks are also passed to a delegate, `handsOutChunks` has to be set,
+    /// and the delegate is given separate copies of them instead.
+    internal final class _BodyBuffer {
+        /// Bodies claiming to be longer than this are not allocated up front,
+        /// so that a bogus `Content-Length` can't claim memory nothing is
+        /// sent for.
+        static let maximumPreallocatedLength = 32 * 1024 * 1024
+
+        private final class _Storage {
+            let bytes: UnsafeMutableRawBufferPointer
+            var count = 0
+            init(capacity: Int) {
+                bytes = .allocate(byteCount: capacity, alignment: 1)
+            }
+            deinit {
+                bytes.deallocate()
+            }
+        }
+
+        private var storage: _Storage?
+        private var isPreallocationDecided = false
+        private var chunks: [Data] = []
+        /// Whether every chunk so far is in `storage`, one after another.
+        private var isContiguous = true
+        private let handsOutChunks: Bool
+
+        init(handsOutChunks: Bool = false) {
+            self.handsOutChunks = handsOutChunks
+        }
+
+        /// Copies `bytes` into a new chunk at the end of the body and returns
+        /// it, or a separate copy of it if `handsOutChunks` is set.
+        ///
+        /// - Parameter expectedLength: The length of the whole body, or a
+        ///   negative number if it isn't known. Only evaluated for the first
+        ///   chunk.
+        func append(copying bytes: UnsafeRawBufferPointer, expectedLength: @autoclosure () -> Int64) -> Data {
+            if !isPreallocationDecided {
+                isPreallocationDecided = true
+                let length = expectedLength()
+                if length >= Int64(bytes.count) && length <= Int64(_BodyBuffer.maximumPreallocatedLength) {
+                    storage = _Storage(capacity: Int(length))
+                }
+            }
+
+            let chunk: Data
+            if let storage = storage, isContiguous, storage.bytes.count - storage.count >= bytes.count {
+                let region = UnsafeMutableRawBufferPointer(rebasing: storage.bytes[storage.count ..< storage.count + bytes.count])
+                region.copyMemory(from: bytes)
+                storage.count += bytes.count
+                chunk = _BodyBuffer.data(in: UnsafeRawBufferPointer(region), of: storage)
+            } else {
+                // The body turned out longer than announced, e.g. because it
+                // is being decompressed; carry on with separate chunks.
+                isContiguous = false
+                chunk = Data(bytes)
+            }
+            chunks.append(chunk)
+            // A chunk in `storage` is a view of memory the complete body will
+            // share, and `Data` can't tell that it isn't uniquely referenced.
+            guard handsOutChunks, isContiguous else { return chunk }
+            return Data(bytes)
+        }
+
+        /// The complete body, copied into a single `Data` only if it arrived
+        /// in more than one piece of memory.
+        var data: Data {
+            if let storage = storage, isContiguous {
+                return _BodyBuffer.data(in: UnsafeRawBufferPointer(rebasing: storage.bytes[0 ..< storage.count]), of: storage)
+            }
+            if chunks.count == 1 {
+                return chunks[0]
+            }
+            var data = Data(capacity: chunks.reduce(0) { $0 + $1.count })
+            for chunk in chunks {
+                data.append(chunk)
+            }
+            return data
+        }
+
+        private static func data(in region: UnsafeRawBufferPointer, of storage: _Storage) -> Data {
+            guard let baseAddress = region.baseAddress, region.count > 0 else { return Data() }
+            return Data(bytesNoCopy: UnsafeMutableRawPointer(mutating: baseAddress), count: region.count, deallocator: .custom({ _, _ in
+                withExtendedLifetime(storage) { }
+            }))
+        }
+    }
+}
@@ -90,6 +90,8 @@
 /// The `URLSessionTask` class is in charge of configuring its *easy handle*
 /// and adding it to the owning session’s *multi handle*. Adding / removing
 /// the handle effectively resumes / suspends the transfer.
+/// Once a task is done with its easy handle, the handle goes back to the
+/// session's `_EasyHandlePool` to be reset and re-used by a later task.
 ///
 /// The `URLSessionTask` class has subclasses, but this design puts all the
 /// logic into the parent `URLSessionTask`.
@@ -130,6 +132,12 @@
 /// safety beyond that. All work inside a `URLSessionTask` will run on this
 /// work queue, and so will code manipulating the session's *multi handle*.
 ///
+/// Session work queues target a fixed pool of serial *event loop* queues, one
+/// per active processor by default (the `URLSessionEventLoopCount` environment
+/// variable overrides that). Each session is pinned to one event loop when it
+/// is created, so separate sessions proceed in parallel, while a session's
+/// own tasks stay serialized and share its connection limits.
+///
 /// Delegate callbacks are, however, done on the passed in
 /// `delegateQueue`. And any calls into this API need to switch onto the ‘work
 /// queue’ as needed.
@@ -152,13 +160,6 @@
 /// of 60 seconds, but should this be used in stead of the configuration's
 /// timeoutIntervalForRequest even if the request's timeoutInterval has not
 /// been set explicitly?
-///
-/// - TODO: We could re-use EasyHandles once they're complete. That'd be a
-/// performance optimization. Not sure how much that'd help. The URLSession
-/// would have to keep a pool of unused handles.
-///
-/// - TODO: Could make `workQueue` concurrent and use a multiple reader / single
-/// writer approach if it turns out that there's contention.
 // -----------------------------------------------------------------------------
 
 
@@ -188,6 +189,7 @@ public let NSURLSessionTransferSizeUnknown: Int64 = -1
 open class URLSession : NSObject, @unchecked Sendable {
     internal let _configuration: _Configuration
     fileprivate let multiHandle: _MultiHandle
+    internal let easyHandlePool: _EasyHandlePool
     fileprivate var nextTaskIdentifier = 1
     internal let workQueue: DispatchQueue 
     internal let taskRegistry = URLSession._TaskRegistry()
@@ -217,7 +219,16 @@ open class URLSession : NSObject, @unchecked Sendable {
         return URLSession(configuration: configuration, delegate: nil, delegateQueue: nil)
     }()
 
-    private static let sharedQueue = DispatchQueue(label: "org.swift.URLSession.SharedQueue")
+    /// The serial queues that session work queues target.
+    ///
+    /// - SeeAlso: The threading notes at the top of this file.
+    internal static let eventLoops: [DispatchQueue] = {
+        var count = ProcessInfo.processInfo.activeProcessorCount
+        if let value = ProcessInfo.processInfo.environment["URLSessionEventLoopCount"], let requested = Int(value), requested > 0 {
+            count = requested
+        }
+        return (0..<max(count, 1)).map { DispatchQueue(label: "org.swift.URLSession.EventLoop<\($0)>") }
+    }()
 
     /*
      * Customization of URLSession occurs during creation of a new session.
@@ -229,7 +240,7 @@ open class URLSession : NSObject, @unchecked Sendable {
     public /*not inherited*/ init(configuration: URLSessionConfiguration) {
         initializeLibcurl()
         identifier = nextSessionIdentifier()
-        self.workQueue = DispatchQueue(label: "URLSession<\(identifier)>", target: Self.sharedQueue)
+        self.workQueue = DispatchQueue(label: "URLSession<\(identifier)>", target: Self.eventLoops[Int(identifier.magnitude) % Self.eventLoops.count])
         self.delegateQueue = OperationQueue()
         self.delegateQueue.maxConcurrentOperationCount = 1
         self.delegate = nil
@@ -240,6 +251,8 @@ open class URLSession : NSObject, @unchecked Sendable {
         let c = URLSession._Configuration(URLSessionConfiguration: configuration)
         self._configuration = c
         self.multiHandle = _MultiHandle(configuration: c, workQueue: workQueue)
+        // Enough idle handles for as many transfers to one host as the session allows at once.
+        self.easyHandlePool = _EasyHandlePool(maximumIdleCount: max(c.httpMaximumConnectionsPerHost, 1))
         // registering all the protocol classes with URLProtocol
         let _ = URLSession.registerProtocols
     }
@@ -251,7 +264,7 @@ open class URLSession : NSObject, @unchecked Sendable {
     public /*not inherited*/ init(configuration: URLSessionConfiguration, delegate: URLSessionDelegate?, delegateQueue queue: OperationQueue?) {
         initializeLibcurl()
         identifier = nextSessionIdentifier()
-        self.workQueue = DispatchQueue(label: "URLSession<\(identifier)>", target: Self.sharedQueue)
+        self.workQueue = DispatchQueue(label: "URLSession<\(identifier)>", target: Self.eventLoops[Int(identifier.magnitude) % Self.eventLoops.count])
         if let _queue = queue {
            self.delegateQueue = _queue
         } else {
@@ -266,6 +279,8 @@ open class URLSession : NSObject, @unchecked Sendable {
         let c = URLSession._Configuration(URLSessionConfiguration: configuration)
         self._configuration = c
         self.multiHandle = _MultiHandle(configuration: c, workQueue: workQueue)
+        // Enough idle handles for as many transfers to one host as the session allows at once.
+        self.easyHandlePool = _EasyHandlePool(maximumIdleCount: max(c.httpMaximumConnectionsPerHost, 1))
         // registering all the protocol classes with URLProtocol
         let _ = URLSession.registerProtocols
     }
@@ -367,7 +382,7 @@ open class URLSession : NSObject, @unchecked Sendable {
     
      /* flush storage to disk and clear transient network caches.  Invokes completionHandler() on the delegate queue. */
     open func flush(completionHandler: @Sendable @escaping () -> Void) {
-        // We create new CURL handles every request.
+        // Idle CURL handles only keep TLS session IDs.
         delegateQueue.addOperation {
             completionHandler()
         }
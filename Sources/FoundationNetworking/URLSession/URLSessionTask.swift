@@ -115,6 +115,12 @@ open class URLSessionTask : NSObject, NSCopying, @unchecked Sendable {
     
     internal var _callCompletionHandlerInline = false
 
+    /// Metrics for each transfer made for the task, added to as they complete.
+    ///
+    /// - Note: Only to be used on the work queue.
+    internal let _metrics = URLSessionTaskMetrics()
+    private var hasFinishedCollectingMetrics = false
+
     fileprivate enum ProtocolState {
         case toBeCreated
         case awaitingCacheReply(Bag<(URLProtocol?) -> Void>)
@@ -213,6 +219,23 @@ open class URLSessionTask : NSObject, NSCopying, @unchecked Sendable {
             _protocolStorage = .invalidated
         }
     }
+
+    /// Ends the task's metrics and sends them to its delegate, ahead of the
+    /// message that the task has completed.
+    func _finishCollectingMetrics() {
+        let isFirstCall: Bool = syncQ.sync {
+            defer { hasFinishedCollectingMetrics = true }
+            return !hasFinishedCollectingMetrics
+        }
+        guard isFirstCall else { return }
+        let metrics = _metrics
+        let start = metrics.taskInterval.start
+        metrics.taskInterval = DateInterval(start: start, end: max(start, Date()))
+        guard let session = actualSession, let delegate = self.delegate else { return }
+        session.delegateQueue.addOperation {
+            delegate.urlSession(session, task: self, didFinishCollecting: metrics)
+        }
+    }
     
     
     internal var knownBody: _Body?
@@ -476,6 +499,9 @@ open class URLSessionTask : NSObject, NSCopying, @unchecked Sendable {
             if self.suspendCount > 0 { self.suspendCount -= 1 }
             self.updateTaskState()
             if self.suspendCount == 0 {
+                if !self.hasTriggeredResume {
+                    self._metrics.taskInterval = DateInterval(start: Date(), duration: 0)
+                }
                 self.hasTriggeredResume = true
                 self._getProtocol { (urlProtocol) in
                     // The combination of locking in getProtocol and dispatching to the work queue let us use the normally non-Sendable URLProtocol
@@ -1163,7 +1189,8 @@ extension _ProtocolClient : URLProtocolClient {
                 }
             }
         }
-        
+
+        task._finishCollectingMetrics()
         switch session.behaviour(for: task) {
         case .taskDelegate(let delegate):
             if let downloadDelegate = delegate as? URLSessionDownloadDelegate, let downloadTask = task as? URLSessionDownloadTask {
@@ -1333,6 +1360,7 @@ extension _ProtocolClient : URLProtocolClient {
 
     func urlProtocol(task: URLSessionTask, didFailWithError error: Error) {
         guard let session = task.session as? URLSession else { fatalError() }
+        task._finishCollectingMetrics()
         switch session.behaviour(for: task) {
         case .taskDelegate(let delegate):
             session.delegateQueue.addOperation {
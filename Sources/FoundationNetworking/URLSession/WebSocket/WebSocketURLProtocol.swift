@@ -25,6 +25,12 @@ internal class _WebSocketURLProtocol: _HTTPURLProtocol {
         super.init(request: request, cachedResponse: nil, client: client)
     }
     
+    // The handle's connection is taken over for WebSocket frames, so it is
+    // not worth handing to another task.
+    override class var reusesEasyHandle: Bool {
+        return false
+    }
+    
     override class func canInit(with request: URLRequest) -> Bool {
         switch request.url?.scheme {
         case "ws", "wss": return true
@@ -98,7 +104,7 @@ internal class _WebSocketURLProtocol: _HTTPURLProtocol {
         try easyHandle.sendWebSocketsData(data, flags: flags)
     }
     
-    override func didReceive(data: Data) -> _EasyHandle._Action {
+    override func didReceive(bytes: UnsafeRawBufferPointer) -> _EasyHandle._Action {
         guard case .transferInProgress(var ts) = internalState else {
             fatalError("Received web socket data, but no transfer in progress.")
         }
@@ -107,6 +113,8 @@ internal class _WebSocketURLProtocol: _HTTPURLProtocol {
             ts.response = response
         }
 
+        let data = Data(bytes)
+
         // Note this excludes code 300 which should return the response of the redirect and not follow it.
         // For other redirect codes dont notify the delegate of the data received in the redirect response.
         if let httpResponse = ts.response as? HTTPURLResponse,
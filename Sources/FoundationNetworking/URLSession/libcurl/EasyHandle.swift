@@ -64,7 +64,8 @@ internal func xferInfoFunctionSupported() -> Bool {
 /// A single `URLSessionTask` may do multiple, consecutive transfers, and
 /// as a result it will have to reconfigure its easy handle between
 /// transfers. An easy handle can be re-used once its transfer has
-/// completed.
+/// completed, and once its task is done the handle goes back to the
+/// session's `_EasyHandlePool` for the next task.
 ///
 /// - Note: All code assumes that it is being called on a single thread /
 /// `Dispatch` only -- it is intentionally **not** thread safe.
@@ -90,6 +91,64 @@ internal final class _EasyHandle {
     }
 }
 
+extension _EasyHandle {
+    /// Prepares a handle whose task has finished for use by another one.
+    ///
+    /// `curl_easy_reset` puts every option back to its default, but keeps the
+    /// connection state the handle holds itself, such as its TLS session IDs,
+    /// which a new handle would have to build up again. The DNS cache and the
+    /// connection pool belong to the multi handle, so those are shared by
+    /// every handle in the session whether or not it is re-used.
+    func reset(delegate: _EasyHandleDelegate) {
+        CFURLSessionEasyHandleReset(rawHandle)
+        self.delegate = delegate
+        headerList = nil
+        pauseState = []
+        timeoutTimer = nil
+        errorBuffer.withUnsafeMutableBufferPointer { $0.update(repeating: 0) }
+        _config = nil
+        _url = nil
+        setupCallbacks()
+    }
+}
+
+extension URLSession {
+    /// The easy handles of a session's finished tasks, kept for its next ones.
+    ///
+    /// Re-using a handle saves allocating it, and lets the next transfer use
+    /// the TLS session IDs it has already collected.
+    internal final class _EasyHandlePool {
+        private let lock = NSLock()
+        private var idleHandles: [_EasyHandle] = []
+        private let maximumIdleCount: Int
+
+        /// - Parameter maximumIdleCount: Handles returned while this many are
+        ///   already idle are freed instead.
+        init(maximumIdleCount: Int) {
+            self.maximumIdleCount = maximumIdleCount
+        }
+
+        func makeHandle(delegate: _EasyHandleDelegate) -> _EasyHandle {
+            guard let handle = lock.performLocked({ idleHandles.popLast() }) else {
+                return _EasyHandle(delegate: delegate)
+            }
+            handle.reset(delegate: delegate)
+            return handle
+        }
+
+        /// Returns a handle that is no longer part of a multi handle.
+        func recycle(_ handle: _EasyHandle) {
+            handle.timeoutTimer = nil
+            handle.delegate = nil
+            lock.performLocked {
+                if idleHandles.count < maximumIdleCount {
+                    idleHandles.append(handle)
+                }
+            }
+        }
+    }
+}
+
 internal func ==(lhs: _EasyHandle, rhs: _EasyHandle) -> Bool {
     return lhs.rawHandle == rhs.rawHandle
 }
@@ -119,8 +178,10 @@ internal extension _EasyHandle {
 }
 internal protocol _EasyHandleDelegate: AnyObject {
     /// Handle data read from the network.
+    ///
+    /// The bytes belong to libcurl and are only valid until this returns.
     /// - returns: the action to be taken: abort, proceed, or pause.
-    func didReceive(data: Data) -> _EasyHandle._Action
+    func didReceive(bytes: UnsafeRawBufferPointer) -> _EasyHandle._Action
     /// Handle header data read from the network.
     /// - returns: the action to be taken: abort, proceed, or pause.
     func didReceive(headerData data: Data, contentLength: Int64) -> _EasyHandle._Action
@@ -234,30 +295,34 @@ extension _EasyHandle {
                 return
             }
             
-            // Otherwise, search a list of known paths
-            let paths = [
-                "/etc/ssl/certs/ca-certificates.crt",
-                "/etc/pki/tls/certs/ca-bundle.crt",
-                "/usr/share/ssl/certs/ca-bundle.crt",
-                "/usr/local/share/certs/ca-root-nss.crt",
-                "/etc/ssl/cert.pem"
-            ]
-            
-            for path in paths {
-                var isDirectory: ObjCBool = false
-                if FileManager.default.fileExists(atPath: path,
-                                                  isDirectory: &isDirectory)
-                    && !isDirectory.boolValue {
-                    path.withCString { pathPtr in
-                        try! CFURLSession_easy_setopt_ptr(rawHandle, CFURLSessionOptionCAINFO, UnsafeMutablePointer(mutating: pathPtr)).asError()
-                    }
-                    return
+            // Otherwise, use the first of the known paths that exists
+            if let path = _EasyHandle.knownCARootBundlePath {
+                path.withCString { pathPtr in
+                    try! CFURLSession_easy_setopt_ptr(rawHandle, CFURLSessionOptionCAINFO, UnsafeMutablePointer(mutating: pathPtr)).asError()
                 }
             }
         }
 #endif // !os(Windows) && !os(macOS) && !os(iOS) && !os(watchOS) && !os(tvOS)
     }
 
+#if !os(Windows) && !os(macOS) && !os(iOS) && !os(watchOS) && !os(tvOS)
+    /// Searched for once, rather than for every transfer.
+    private static let knownCARootBundlePath: String? = {
+        let paths = [
+            "/etc/ssl/certs/ca-certificates.crt",
+            "/etc/pki/tls/certs/ca-bundle.crt",
+            "/usr/share/ssl/certs/ca-bundle.crt",
+            "/usr/local/share/certs/ca-root-nss.crt",
+            "/etc/ssl/cert.pem"
+        ]
+        
+        return paths.first { path in
+            var isDirectory: ObjCBool = false
+            return FileManager.default.fileExists(atPath: path, isDirectory: &isDirectory) && !isDirectory.boolValue
+        }
+    }()
+#endif // !os(Windows) && !os(macOS) && !os(iOS) && !os(watchOS) && !os(tvOS)
+
     /// Set allowed protocols
     ///
     /// - Note: This has security implications. Not limiting this, someone could
@@ -562,6 +627,76 @@ extension _EasyHandle {
     }
 }
 
+extension _EasyHandle {
+    /// Fills in what libcurl knows about the transfer that just completed.
+    ///
+    /// libcurl measures times from the start of the transfer; they're turned
+    /// into dates by adding them to `fetchStartDate`. A connection that was
+    /// re-used has no name lookup or connect times.
+    /// - SeeAlso: https://curl.se/libcurl/c/curl_easy_getinfo.html#TIMES
+    func fill(_ metrics: URLSessionTaskTransactionMetrics, fetchStartDate: Date) {
+        func date(_ info: CFURLSessionInfo) -> Date? {
+            // Times are in microseconds, and 0 for phases that didn't happen.
+            guard let microseconds = offsetInfo(info), 0 < microseconds else { return nil }
+            return fetchStartDate.addingTimeInterval(TimeInterval(microseconds) / 1_000_000)
+        }
+
+        metrics.resourceFetchType = .networkLoad
+        metrics.fetchStartDate = fetchStartDate
+        metrics.isReusedConnection = longInfo(CFURLSessionInfoNUM_CONNECTS) == 0
+        if !metrics.isReusedConnection {
+            metrics.domainLookupEndDate = date(CFURLSessionInfoNAMELOOKUP_TIME_T)
+            metrics.domainLookupStartDate = metrics.domainLookupEndDate.map { _ in fetchStartDate }
+            metrics.connectStartDate = metrics.domainLookupEndDate ?? fetchStartDate
+            let tcpConnectEndDate = date(CFURLSessionInfoCONNECT_TIME_T)
+            metrics.secureConnectionEndDate = date(CFURLSessionInfoAPPCONNECT_TIME_T)
+            metrics.secureConnectionStartDate = metrics.secureConnectionEndDate.map { _ in tcpConnectEndDate ?? fetchStartDate }
+            metrics.connectEndDate = metrics.secureConnectionEndDate ?? tcpConnectEndDate
+        }
+        metrics.requestStartDate = date(CFURLSessionInfoPRETRANSFER_TIME_T)
+        metrics.responseStartDate = date(CFURLSessionInfoSTARTTRANSFER_TIME_T)
+        // libcurl doesn't say when it finished sending the request; it was at
+        // the latest when the response started.
+        metrics.requestEndDate = metrics.responseStartDate
+        metrics.responseEndDate = date(CFURLSessionInfoTOTAL_TIME_T)
+
+        metrics.countOfRequestHeaderBytesSent = Int64(longInfo(CFURLSessionInfoREQUEST_SIZE) ?? 0)
+        metrics.countOfRequestBodyBytesSent = offsetInfo(CFURLSessionInfoSIZE_UPLOAD_T) ?? 0
+        metrics.countOfRequestBodyBytesBeforeEncoding = metrics.countOfRequestBodyBytesSent
+        metrics.countOfResponseHeaderBytesReceived = Int64(longInfo(CFURLSessionInfoHEADER_SIZE) ?? 0)
+        metrics.countOfResponseBodyBytesReceived = offsetInfo(CFURLSessionInfoSIZE_DOWNLOAD_T) ?? 0
+
+        metrics.remoteAddress = stringInfo(CFURLSessionInfoPRIMARY_IP)
+        metrics.remotePort = longInfo(CFURLSessionInfoPRIMARY_PORT).flatMap { 0 < $0 ? String($0) : nil }
+        metrics.localAddress = stringInfo(CFURLSessionInfoLOCAL_IP)
+        metrics.localPort = longInfo(CFURLSessionInfoLOCAL_PORT).flatMap { 0 < $0 ? String($0) : nil }
+    }
+
+    /// - Returns: `nil` if libcurl is too old to know about `info`.
+    private func offsetInfo(_ info: CFURLSessionInfo) -> Int64? {
+        var value = Int64()
+        guard CFURLSession_easy_getinfo_off_t(rawHandle, info, &value) == CFURLSessionEasyCodeOK else { return nil }
+        return value
+    }
+
+    private func longInfo(_ info: CFURLSessionInfo) -> Int? {
+    #if os(Windows) && (arch(arm64) || arch(x86_64))
+        var value = Int32()
+    #else
+        var value = Int()
+    #endif
+        guard CFURLSession_easy_getinfo_long(rawHandle, info, &value) == CFURLSessionEasyCodeOK else { return nil }
+        return numericCast(value)
+    }
+
+    private func stringInfo(_ info: CFURLSessionInfo) -> String? {
+        var p: UnsafeMutablePointer<Int8>? = nil
+        guard CFURLSession_easy_getinfo_charp(rawHandle, info, &p) == CFURLSessionEasyCodeOK,
+              let cstring = p, cstring.pointee != 0 else { return nil }
+        return String(cString: cstring, encoding: .utf8)
+    }
+}
+
 fileprivate extension _EasyHandle {
     static func from(callbackUserData userdata: UnsafeMutableRawPointer?) -> _EasyHandle? {
         guard let userdata = userdata else { return nil }
@@ -654,8 +789,8 @@ fileprivate extension _EasyHandle {
     /// - SeeAlso: <https://curl.haxx.se/libcurl/c/CURLOPT_WRITEFUNCTION.html>
     func didReceive(data: UnsafeMutablePointer<Int8>, size: Int, nmemb: Int) -> Int {
         let d: Int = {
-            let buffer = Data(bytes: data, count: size*nmemb)
-            switch delegate?.didReceive(data: buffer) {
+            let buffer = UnsafeRawBufferPointer(start: data, count: size*nmemb)
+            switch delegate?.didReceive(bytes: buffer) {
             case .proceed?: return size * nmemb
             case .abort?: return 0
             case .pause?:
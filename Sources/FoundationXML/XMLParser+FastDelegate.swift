@@ -0,0 +1,163 @@
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2026 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+
+#if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
+import SwiftFoundation
+#else
+import Foundation
+#endif
+
+/// A delegate that receives element and text events without the parser
+/// building a `String` or `Dictionary` for each of them.
+///
+/// Element and attribute names are interned: each distinct name is decoded
+/// once per parser and the same `String` is handed out every time it recurs.
+/// Text, CDATA and attribute values are passed as buffers of UTF-8 that point
+/// into the parser's own storage; they are only valid until the method returns,
+/// so copy out whatever needs to be kept.
+///
+/// When a parser has a `fastDelegate`, these events are sent to it instead of
+/// to `delegate`. All other events, including namespace mappings and errors,
+/// are still sent to `delegate`.
+public protocol XMLParserFastDelegate: AnyObject {
+    func parser(_ parser: XMLParser, didStartElement element: XMLParser.ElementName, attributes: XMLParser.Attributes)
+
+    func parser(_ parser: XMLParser, didEndElement element: XMLParser.ElementName)
+
+    // The bytes are the UTF-8 encoding of the characters, and may be only part of a run of text.
+    func parser(_ parser: XMLParser, foundCharacters bytes: UnsafeBufferPointer<UInt8>)
+
+    func parser(_ parser: XMLParser, foundCDATA bytes: UnsafeBufferPointer<UInt8>)
+}
+
+public extension XMLParserFastDelegate {
+    func parser(_ parser: XMLParser, didStartElement element: XMLParser.ElementName, attributes: XMLParser.Attributes) { }
+
+    func parser(_ parser: XMLParser, didEndElement element: XMLParser.ElementName) { }
+
+    func parser(_ parser: XMLParser, foundCharacters bytes: UnsafeBufferPointer<UInt8>) { }
+
+    func parser(_ parser: XMLParser, foundCDATA bytes: UnsafeBufferPointer<UInt8>) { }
+}
+
+extension XMLParser {
+    /// The name of an element, as reported to an `XMLParserFastDelegate`.
+    ///
+    /// Namespaces are always resolved, whatever `shouldProcessNamespaces` is set to.
+    public struct ElementName : Hashable {
+        public let localName: String
+        public let prefix: String?
+        public let namespaceURI: String?
+
+        public var qualifiedName: String {
+            guard let prefix = prefix else { return localName }
+            return prefix + ":" + localName
+        }
+    }
+
+    /// An attribute of an element, as reported to an `XMLParserFastDelegate`.
+    ///
+    /// The value is only valid until the delegate method returns.
+    public struct Attribute {
+        public let localName: String
+        public let prefix: String?
+        public let namespaceURI: String?
+
+        /// The value, with entities already replaced, as UTF-8.
+        public let value: UnsafeBufferPointer<UInt8>
+
+        public var qualifiedName: String {
+            guard let prefix = prefix else { return localName }
+            return prefix + ":" + localName
+        }
+
+        /// Decodes the value into a new `String`.
+        public var stringValue: String {
+            return String(decoding: value, as: UTF8.self)
+        }
+    }
+
+    /// The attributes of an element, read in place from the parser.
+    ///
+    /// Namespace declarations are not included; they are reported through
+    /// `XMLParserDelegate` when `shouldReportNamespacePrefixes` is set. Like
+    /// the values it contains, a collection of attributes is only valid until
+    /// the delegate method it was passed to returns.
+    public struct Attributes : RandomAccessCollection {
+        // Five pointers per attribute: local name, prefix, URI, value and end of value.
+        private let fields: UnsafeMutablePointer<UnsafePointer<UInt8>?>?
+        private let names: _XMLParserNameTable
+
+        public let count: Int
+
+        internal init(_ fields: UnsafeMutablePointer<UnsafePointer<UInt8>?>?, count: Int, names: _XMLParserNameTable) {
+            self.fields = fields
+            self.count = fields == nil ? 0 : count
+            self.names = names
+        }
+
+        public var startIndex: Int { return 0 }
+        public var endIndex: Int { return count }
+
+        public subscript(position: Int) -> Attribute {
+            precondition(position >= 0 && position < count, "Attribute index out of range")
+            let attribute = fields! + position * 5
+            return Attribute(localName: attribute[0].map(names.name) ?? "",
+                             prefix: attribute[1].map(names.name),
+                             namespaceURI: attribute[2].map(names.name),
+                             value: Attributes.value(attribute))
+        }
+
+        /// Returns the value of the first attribute with the given local name,
+        /// comparing names in place rather than decoding them.
+        public subscript(localName localName: String) -> UnsafeBufferPointer<UInt8>? {
+            for position in 0..<count {
+                let attribute = fields! + position * 5
+                if let name = attribute[0], localName.utf8.elementsEqual(_XMLParserNameTable.bytes(name)) {
+                    return Attributes.value(attribute)
+                }
+            }
+            return nil
+        }
+
+        private static func value(_ attribute: UnsafeMutablePointer<UnsafePointer<UInt8>?>) -> UnsafeBufferPointer<UInt8> {
+            guard let value = attribute[3], let end = attribute[4], end > value else {
+                return UnsafeBufferPointer(start: nil, count: 0)
+            }
+            return UnsafeBufferPointer(start: value, count: end - value)
+        }
+    }
+}
+
+/// Decodes each distinct name libxml2 reports once.
+///
+/// libxml2 hands out names from the parser's dictionary, so the same name
+/// arrives at the same address every time; the address is used as the key and
+/// the bytes are checked against the cached string before it is reused.
+internal final class _XMLParserNameTable {
+    private var names: [UnsafePointer<UInt8> : String] = [:]
+
+    static func bytes(_ name: UnsafePointer<UInt8>) -> UnsafeBufferPointer<UInt8> {
+        var length = 0
+        while name[length] != 0 {
+            length += 1
+        }
+        return UnsafeBufferPointer(start: name, count: length)
+    }
+
+    func name(_ bytes: UnsafePointer<UInt8>) -> String {
+        let buffer = _XMLParserNameTable.bytes(bytes)
+        if let name = names[bytes], name.utf8.elementsEqual(buffer) {
+            return name
+        }
+        let name = String(decoding: buffer, as: UTF8.self)
+        names[bytes] = name
+        return name
+    }
+}
@@ -238,6 +238,23 @@ internal func _NSXMLParserStartElementNs(_ ctx: _CFXMLInterface, localname: Unsa
     let parser = ctx.parser
     let reportNamespaces = parser.shouldReportNamespacePrefixes
 
+    if let fastDelegate = parser.fastDelegate {
+        if reportNamespaces {
+            var nsDict = [String:String]()
+            for idx in stride(from: 0, to: Int(nb_namespaces) * 2, by: 2) {
+                let namespaceNameString = namespaces[idx].flatMap { UTF8STRING($0) } ?? ""
+                nsDict[namespaceNameString] = namespaces[idx + 1].flatMap { UTF8STRING($0) } ?? ""
+            }
+            parser._pushNamespaces(nsDict)
+        }
+        let names = parser._names
+        let element = XMLParser.ElementName(localName: names.name(localname),
+                                            prefix: prefix.map(names.name),
+                                            namespaceURI: URI.map(names.name))
+        fastDelegate.parser(parser, didStartElement: element, attributes: XMLParser.Attributes(attributes, count: Int(nb_attributes), names: names))
+        return
+    }
+
     var nsDict = [String:String]()
     var attrDict = [String:String]()
     if nb_attributes + nb_namespaces > 0 {
@@ -319,6 +336,18 @@ internal func _NSXMLParserStartElementNs(_ ctx: _CFXMLInterface, localname: Unsa
 internal func _NSXMLParserEndElementNs(_ ctx: _CFXMLInterface , localname: UnsafePointer<UInt8>, prefix: UnsafePointer<UInt8>?, URI: UnsafePointer<UInt8>?) -> Void {
     let parser = ctx.parser
 
+    if let fastDelegate = parser.fastDelegate {
+        let names = parser._names
+        let element = XMLParser.ElementName(localName: names.name(localname),
+                                            prefix: prefix.map(names.name),
+                                            namespaceURI: URI.map(names.name))
+        fastDelegate.parser(parser, didEndElement: element)
+        if parser.shouldReportNamespacePrefixes {
+            parser._popNamespaces()
+        }
+        return
+    }
+
     var elementName: String = UTF8STRING(localname)!
     var namespaceURI: String? = nil
     var qualifiedName: String? = nil
@@ -347,6 +376,8 @@ internal func _NSXMLParserCharacters(_ ctx: _CFXMLInterface, ch: UnsafePointer<U
     let context = parser._parserContext!
     if _CFXMLInterfaceInRecursiveState(context) != 0 {
         _CFXMLInterfaceResetRecursiveState(context)
+    } else if let fastDelegate = parser.fastDelegate {
+        fastDelegate.parser(parser, foundCharacters: UnsafeBufferPointer(start: ch, count: Int(len)))
     } else {
         if let delegate = parser.delegate {
             let str = String(decoding: UnsafeBufferPointer(start: ch, count: Int(len)), as: UTF8.self)
@@ -366,7 +397,9 @@ internal func _NSXMLParserProcessingInstruction(_ ctx: _CFXMLInterface, target:
 
 internal func _NSXMLParserCdataBlock(_ ctx: _CFXMLInterface, value: UnsafePointer<UInt8>, len: Int32) -> Void {
     let parser = ctx.parser
-    if let delegate = parser.delegate {
+    if let fastDelegate = parser.fastDelegate {
+        fastDelegate.parser(parser, foundCDATA: UnsafeBufferPointer(start: value, count: Int(len)))
+    } else if let delegate = parser.delegate {
         delegate.parser(parser, foundCDATA: Data(bytes: value, count: Int(len)))
     }
 }
@@ -401,14 +434,14 @@ open class XMLParser : NSObject {
     internal var _stream: InputStream?
     internal var _data: Data?
 
-    internal var _chunkSize = Int(4096 * 32) // a suitably large number for a decent chunk size
-    // This chunk of data stores the head of the stream. We know we have enough information for encoding
-    // when there are atleast 4 bytes in here.
-    internal var _bomChunk: Data?
+    // This stores the head of the stream when it arrives in pieces smaller than 4 bytes. We know we have
+    // enough information for encoding when there are atleast 4 bytes in here.
+    internal var _bomChunk: [UInt8] = []
     fileprivate var _parserContext: _CFXMLInterfaceParserContext?
     internal var _delegateAborted = false
     internal var _url: URL?
     internal var _namespaces = [[String:String]]()
+    internal lazy var _names = _XMLParserNameTable()
     
     // initializes the parser with the specified URL.
     public convenience init?(contentsOf url: URL) {
@@ -453,6 +486,9 @@ open class XMLParser : NSObject {
     }
     
     open weak var delegate: XMLParserDelegate?
+
+    // When set, element, character and CDATA events are sent here instead of to the delegate, without building a String or Dictionary for each one.
+    open weak var fastDelegate: XMLParserFastDelegate?
     
     open var shouldProcessNamespaces: Bool = false
     open var shouldReportNamespacePrefixes: Bool = false
@@ -462,6 +498,14 @@ open class XMLParser : NSObject {
     
     open var allowedExternalEntityURLs: Set<URL>?
 
+    // The size of the pieces a stream or file is read and handed to the parser in. Files opened with
+    // init(contentsOf:) are mapped rather than read, and passed to the parser directly from the mapping.
+    open var bufferSize: Int = 4096 * 32 {
+        willSet {
+            precondition(newValue > 0 && newValue <= Int(Int32.max), "XMLParser.bufferSize must be positive and fit in 32 bits")
+        }
+    }
+
     #if os(WASI)
     /// The current parser associated with the current thread. (assuming no multi-threading)
     /// FIXME: Unify the implementation with the other platforms once we unlock `threadDictionary`
@@ -504,80 +548,96 @@ open class XMLParser : NSObject {
     }
 
     internal func parseData(_ data: Data, lastChunkOfData: Bool = false) -> Bool {
+        return data.withUnsafeBytes { (rawBuffer: UnsafeRawBufferPointer) -> Bool in
+            return parseBytes(rawBuffer, lastChunkOfData: lastChunkOfData)
+        }
+    }
+
+    // Pushes the bytes straight into libxml2. The bytes are only read for the duration of the call.
+    internal func parseBytes(_ bytes: UnsafeRawBufferPointer, lastChunkOfData: Bool = false) -> Bool {
         _CFXMLInterfaceSetStructuredErrorFunc(interface, _structuredErrorFunc)
         defer { _CFXMLInterfaceSetStructuredErrorFunc(interface, nil) }
 
-        let handler: _CFXMLInterfaceSAXHandler? = (delegate != nil ? _handler : nil)
-        let unparsedData: Data
+        var unparsedBytes = bytes
         // If the parser context is nil, we have not received enough bytes to create the push parser
         if _parserContext == nil {
-            // Look at the bomChunk and this data
-            let bomChunk: Data = {
-                guard var bomChunk = _bomChunk else {
-                    return data
+            // The first 4 bytes are needed to detect the encoding. Only when they are split across chunks
+            // are they copied, and then only as many as are missing from the head of this chunk.
+            let needed = min(4 - _bomChunk.count, unparsedBytes.count)
+            if !_bomChunk.isEmpty || needed < 4 {
+                _bomChunk.append(contentsOf: unparsedBytes.prefix(needed))
+                unparsedBytes = UnsafeRawBufferPointer(rebasing: unparsedBytes.dropFirst(needed))
+                // If we have not received 4 bytes, save the bomChunk for next pass
+                if _bomChunk.count < 4 {
+                    return true
                 }
-                bomChunk.append(data)
-                return bomChunk
-            }()
-            // If we have not received 4 bytes, save the bomChunk for next pass
-            if bomChunk.count < 4 {
-                _bomChunk = bomChunk
-                return true
-            }
-            // Prepare options (substitute entities, recover on errors)
-            var options = _kCFXMLInterfaceRecover | _kCFXMLInterfaceNoEnt
-            if shouldResolveExternalEntities {
-                options |= _kCFXMLInterfaceDTDLoad
-            }
-            if handler == nil {
-                options |= (_kCFXMLInterfaceNoError | _kCFXMLInterfaceNoWarning)
             }
 
-            // Create the push context with the first 4 bytes
-            bomChunk.withUnsafeBytes { (rawBuffer: UnsafeRawBufferPointer) in
-                let bytes = rawBuffer.baseAddress!.assumingMemoryBound(to: CChar.self)
-                _parserContext = _CFXMLInterfaceCreatePushParserCtxt(handler, interface, bytes, 4, nil)
-            }
-            guard _parserContext != nil else {
+            let created = _bomChunk.isEmpty ? createParserContext(UnsafeRawBufferPointer(rebasing: unparsedBytes.prefix(4)))
+                                            : _bomChunk.withUnsafeBytes { createParserContext($0) }
+            guard created else {
                 if _parserError == nil {
                     _parserError = NSError(domain: XMLParser.errorDomain, code: ErrorCode.outOfMemoryError.rawValue)
                 }
                 return false
-            };
-            _CFXMLInterfaceCtxtUseOptions(_parserContext, options)
-            // Prepare the remaining data for parsing
-            let dataRange = bomChunk.indices
-            let unparsed = Range(uncheckedBounds: (dataRange.startIndex.advanced(by: 4), dataRange.endIndex))
-            unparsedData = bomChunk.subdata(in: unparsed)
-        }
-        else {
-            unparsedData = data
+            }
+            if _bomChunk.isEmpty {
+                unparsedBytes = UnsafeRawBufferPointer(rebasing: unparsedBytes.dropFirst(4))
+            }
+            _bomChunk = []
         }
 
-        let parseResult = unparsedData.withUnsafeBytes { (rawBuffer: UnsafeRawBufferPointer) -> Int32 in
-            let bytes = rawBuffer.baseAddress!.assumingMemoryBound(to: CChar.self)
-            return _CFXMLInterfaceParseChunk(_parserContext, bytes, Int32(unparsedData.count), lastChunkOfData ? 1 : 0)
+        let parseResult: Int32
+        if let base = unparsedBytes.baseAddress {
+            parseResult = _CFXMLInterfaceParseChunk(_parserContext, base.assumingMemoryBound(to: CChar.self), Int32(unparsedBytes.count), lastChunkOfData ? 1 : 0)
+        } else {
+            // An empty chunk still needs somewhere to point
+            var empty: CChar = 0
+            parseResult = _CFXMLInterfaceParseChunk(_parserContext, &empty, 0, lastChunkOfData ? 1 : 0)
         }
 
         let result = _handleParseResult(parseResult)
         return result
     }
 
+    // Creates the push parser from the 4 bytes used to detect the encoding.
+    private func createParserContext(_ bomBytes: UnsafeRawBufferPointer) -> Bool {
+        let handler: _CFXMLInterfaceSAXHandler? = (delegate != nil || fastDelegate != nil ? _handler : nil)
+
+        // Prepare options (substitute entities, recover on errors)
+        var options = _kCFXMLInterfaceRecover | _kCFXMLInterfaceNoEnt
+        if shouldResolveExternalEntities {
+            options |= _kCFXMLInterfaceDTDLoad
+        }
+        if handler == nil {
+            options |= (_kCFXMLInterfaceNoError | _kCFXMLInterfaceNoWarning)
+        }
+
+        // Create the push context with the first 4 bytes
+        let bytes = bomBytes.baseAddress!.assumingMemoryBound(to: CChar.self)
+        _parserContext = _CFXMLInterfaceCreatePushParserCtxt(handler, interface, bytes, 4, nil)
+        guard _parserContext != nil else {
+            return false
+        }
+        _CFXMLInterfaceCtxtUseOptions(_parserContext, options)
+        return true
+    }
+
     internal func parseFrom(_ stream : InputStream) -> Bool {
         var result = true
+        let bufferSize = self.bufferSize
 
-        guard let buffer = malloc(_chunkSize)?.bindMemory(to: UInt8.self, capacity: _chunkSize) else { return false }
+        guard let buffer = malloc(bufferSize)?.bindMemory(to: UInt8.self, capacity: bufferSize) else { return false }
         defer { free(buffer) }
 
         stream.open()
         defer { stream.close() }
         parseLoop: while result {
-            switch stream.read(buffer, maxLength: _chunkSize) {
+            switch stream.read(buffer, maxLength: bufferSize) {
             case let len where len > 0:
-                let data = Data(bytesNoCopy: buffer, count: len, deallocator: .none)
-                result = parseData(data)
+                result = parseBytes(UnsafeRawBufferPointer(start: buffer, count: len))
             case 0:
-                result = parseData(Data(), lastChunkOfData: true)
+                result = parseBytes(UnsafeRawBufferPointer(start: nil, count: 0), lastChunkOfData: true)
                 break parseLoop
             default: // See SR-13516, should be `case ..<0:`
                 result = false
@@ -592,10 +652,32 @@ open class XMLParser : NSObject {
         return result
     }
 
+    // Feeds a mapped file to libxml2 in bufferSize pieces, straight from the mapping.
+    // The mapping is not a copy: if the file is truncated while it is being parsed,
+    // reading past the new end raises SIGBUS, and other writes to the file can be
+    // seen part way through the parse. Only local files are mapped (.mappedIfSafe).
+    internal func parseMapped(_ data: Data) -> Bool {
+        let bufferSize = self.bufferSize
+        return data.withUnsafeBytes { (rawBuffer: UnsafeRawBufferPointer) -> Bool in
+            var offset = 0
+            repeat {
+                let end = min(offset + bufferSize, rawBuffer.count)
+                guard parseBytes(UnsafeRawBufferPointer(rebasing: rawBuffer[offset..<end]), lastChunkOfData: end == rawBuffer.count) else {
+                    return false
+                }
+                offset = end
+            } while offset < rawBuffer.count
+            return true
+        }
+    }
+
     // called to start the event-driven parse. Returns YES in the event of a successful parse, and NO in case of error.
     open func parse() -> Bool {
         return Self.withCurrentParser(self) {
-            if _stream != nil {
+            if let url = _url, url.isFileURL, _stream != nil,
+               let mapped = try? Data(contentsOf: url, options: .mappedIfSafe) {
+                return parseMapped(mapped)
+            } else if _stream != nil {
                 return parseFrom(_stream!)
             } else if _data != nil {
                 return parseData(_data!, lastChunkOfData: true)
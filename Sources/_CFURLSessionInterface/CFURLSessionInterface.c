@@ -43,6 +43,9 @@ CFURLSessionEasyHandle _Nonnull CFURLSessionEasyHandleInit() {
 void CFURLSessionEasyHandleDeinit(CFURLSessionEasyHandle _Nonnull handle) {
     curl_easy_cleanup(handle);
 }
+void CFURLSessionEasyHandleReset(CFURLSessionEasyHandle _Nonnull handle) {
+    curl_easy_reset(handle);
+}
 CFURLSessionEasyCode CFURLSessionEasyHandleSetPauseState(CFURLSessionEasyHandle _Nonnull handle, int send, int receive) {
     int bitmask = 0 | (send ? CURLPAUSE_SEND : CURLPAUSE_SEND_CONT) | (receive ? CURLPAUSE_RECV : CURLPAUSE_RECV_CONT);
     return MakeEasyCode(curl_easy_pause(handle, bitmask));
@@ -127,6 +130,13 @@ CFURLSessionEasyCode CFURLSession_easy_getinfo_charp(CFURLSessionEasyHandle _Non
     return MakeEasyCode(curl_easy_getinfo(curl, info.value, a));
 }
 
+CFURLSessionEasyCode CFURLSession_easy_getinfo_off_t(CFURLSessionEasyHandle _Nonnull curl, CFURLSessionInfo info, int64_t *_Nonnull a) {
+    curl_off_t value = 0;
+    CFURLSessionEasyCode code = MakeEasyCode(curl_easy_getinfo(curl, info.value, &value));
+    *a = (int64_t)value;
+    return code;
+}
+
 CFURLSessionMultiCode CFURLSession_multi_setopt_ptr(CFURLSessionMultiHandle _Nonnull multi_handle, CFURLSessionMultiOption option, void *_Nullable a) {
     return MakeMultiCode(curl_multi_setopt(multi_handle, option.value, a));
 }
@@ -606,6 +616,25 @@ CFURLSessionInfo const CFURLSessionInfoRTSP_CSEQ_RECV = { CURLINFO_RTSP_CSEQ_REC
 CFURLSessionInfo const CFURLSessionInfoPRIMARY_PORT = { CURLINFO_PRIMARY_PORT };
 CFURLSessionInfo const CFURLSessionInfoLOCAL_IP = { CURLINFO_LOCAL_IP };
 CFURLSessionInfo const CFURLSessionInfoLOCAL_PORT = { CURLINFO_LOCAL_PORT };
+#if NS_CURL_CURLINFO_TIME_T_SUPPORTED
+CFURLSessionInfo const CFURLSessionInfoSIZE_UPLOAD_T = { CURLINFO_SIZE_UPLOAD_T };
+CFURLSessionInfo const CFURLSessionInfoSIZE_DOWNLOAD_T = { CURLINFO_SIZE_DOWNLOAD_T };
+CFURLSessionInfo const CFURLSessionInfoTOTAL_TIME_T = { CURLINFO_TOTAL_TIME_T };
+CFURLSessionInfo const CFURLSessionInfoNAMELOOKUP_TIME_T = { CURLINFO_NAMELOOKUP_TIME_T };
+CFURLSessionInfo const CFURLSessionInfoCONNECT_TIME_T = { CURLINFO_CONNECT_TIME_T };
+CFURLSessionInfo const CFURLSessionInfoAPPCONNECT_TIME_T = { CURLINFO_APPCONNECT_TIME_T };
+CFURLSessionInfo const CFURLSessionInfoPRETRANSFER_TIME_T = { CURLINFO_PRETRANSFER_TIME_T };
+CFURLSessionInfo const CFURLSessionInfoSTARTTRANSFER_TIME_T = { CURLINFO_STARTTRANSFER_TIME_T };
+#else
+CFURLSessionInfo const CFURLSessionInfoSIZE_UPLOAD_T = { CURLINFO_NONE };
+CFURLSessionInfo const CFURLSessionInfoSIZE_DOWNLOAD_T = { CURLINFO_NONE };
+CFURLSessionInfo const CFURLSessionInfoTOTAL_TIME_T = { CURLINFO_NONE };
+CFURLSessionInfo const CFURLSessionInfoNAMELOOKUP_TIME_T = { CURLINFO_NONE };
+CFURLSessionInfo const CFURLSessionInfoCONNECT_TIME_T = { CURLINFO_NONE };
+CFURLSessionInfo const CFURLSessionInfoAPPCONNECT_TIME_T = { CURLINFO_NONE };
+CFURLSessionInfo const CFURLSessionInfoPRETRANSFER_TIME_T = { CURLINFO_NONE };
+CFURLSessionInfo const CFURLSessionInfoSTARTTRANSFER_TIME_T = { CURLINFO_NONE };
+#endif
 CFURLSessionInfo const CFURLSessionInfoLASTONE = { CURLINFO_LASTONE };
 
 
@@ -42,6 +42,13 @@
 #define NS_CURL_CURLINFO_CAINFO_SUPPORTED 0
 #endif
 
+// 7.61.0 or later
+#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR > 61) || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR == 61 && LIBCURL_VERSION_PATCH >= 0)
+#define NS_CURL_CURLINFO_TIME_T_SUPPORTED 1
+#else
+#define NS_CURL_CURLINFO_TIME_T_SUPPORTED 0
+#endif
+
 // 7.30.0 or later
 #if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR > 30) || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR == 30 && LIBCURL_VERSION_PATCH >= 0)
 #define NS_CURL_MAX_HOST_CONNECTIONS_SUPPORTED 1
@@ -479,6 +486,14 @@ CF_EXPORT CFURLSessionInfo const CFURLSessionInfoPRIMARY_PORT; // CURLINFO_PRIMA
 CF_EXPORT CFURLSessionInfo const CFURLSessionInfoLOCAL_IP; // CURLINFO_LOCAL_IP
 CF_EXPORT CFURLSessionInfo const CFURLSessionInfoLOCAL_PORT; // CURLINFO_LOCAL_PORT
 CF_EXPORT CFURLSessionInfo const CFURLSessionInfoTLS_SESSION; // CURLINFO_TLS_SESSION
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoSIZE_UPLOAD_T; // CURLINFO_SIZE_UPLOAD_T
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoSIZE_DOWNLOAD_T; // CURLINFO_SIZE_DOWNLOAD_T
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoTOTAL_TIME_T; // CURLINFO_TOTAL_TIME_T
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoNAMELOOKUP_TIME_T; // CURLINFO_NAMELOOKUP_TIME_T
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoCONNECT_TIME_T; // CURLINFO_CONNECT_TIME_T
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoAPPCONNECT_TIME_T; // CURLINFO_APPCONNECT_TIME_T
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoPRETRANSFER_TIME_T; // CURLINFO_PRETRANSFER_TIME_T
+CF_EXPORT CFURLSessionInfo const CFURLSessionInfoSTARTTRANSFER_TIME_T; // CURLINFO_STARTTRANSFER_TIME_T
 CF_EXPORT CFURLSessionInfo const CFURLSessionInfoLASTONE; // CURLINFO_LASTONE
 
 typedef struct CFURLSessionMultiOption {
@@ -617,6 +632,7 @@ CF_EXPORT int const CFURLSessionSeekFail;
 
 CF_EXPORT CFURLSessionEasyHandle _Nonnull CFURLSessionEasyHandleInit(void);
 CF_EXPORT void CFURLSessionEasyHandleDeinit(CFURLSessionEasyHandle _Nonnull handle);
+CF_EXPORT void CFURLSessionEasyHandleReset(CFURLSessionEasyHandle _Nonnull handle);
 CF_EXPORT CFURLSessionEasyCode CFURLSessionEasyHandleSetPauseState(CFURLSessionEasyHandle _Nonnull handle, int send, int receive);
 
 CF_EXPORT CFURLSessionMultiHandle _Nonnull CFURLSessionMultiHandleInit(void);
@@ -655,6 +671,7 @@ CF_EXPORT CFURLSessionEasyCode CFURLSession_easy_setopt_scl(CFURLSessionEasyHand
 CF_EXPORT CFURLSessionEasyCode CFURLSession_easy_getinfo_long(CFURLSessionEasyHandle _Nonnull curl, CFURLSessionInfo info, long *_Nonnull a);
 CF_EXPORT CFURLSessionEasyCode CFURLSession_easy_getinfo_double(CFURLSessionEasyHandle _Nonnull curl, CFURLSessionInfo info, double *_Nonnull a);
 CF_EXPORT CFURLSessionEasyCode CFURLSession_easy_getinfo_charp(CFURLSessionEasyHandle _Nonnull curl, CFURLSessionInfo info, char *_Nullable*_Nonnull a);
+CF_EXPORT CFURLSessionEasyCode CFURLSession_easy_getinfo_off_t(CFURLSessionEasyHandle _Nonnull curl, CFURLSessionInfo info, int64_t *_Nonnull a);
 
 CF_EXPORT CFURLSessionMultiCode CFURLSession_multi_setopt_ptr(CFURLSessionMultiHandle _Nonnull multi_handle, CFURLSessionMultiOption option, void *_Nullable a);
 CF_EXPORT CFURLSessionMultiCode CFURLSession_multi_setopt_l(CFURLSessionMultiHandle _Nonnull multi_handle, CFURLSessionMultiOption option, long a);
@@ -245,6 +245,65 @@ class TestFileHandle : XCTestCase {
         }, "Must throw when encountering a read error")
     }
 
+    func testReadToEndOfLargeFileFromOffset() throws {
+        // Large enough to need more than one read, from an offset that is not page aligned.
+        let size = 17 * 1024 * 1024 + 123
+        let data = Data((0..<size).map { UInt8(truncatingIfNeeded: $0 &* 31 &+ $0 >> 12) })
+        let handle = try FileHandle(forReadingFrom: createTemporaryFile(containing: data))
+        allHandles.append(handle)
+
+        try handle.seek(toOffset: 4099)
+        let rest = try XCTUnwrap(handle.readToEnd())
+        XCTAssertEqual(rest.count, size - 4099)
+        XCTAssertTrue(rest == data[4099...], "Data read to end should match the file from the offset onwards")
+        XCTAssertEqual(try handle.offset(), UInt64(size))
+        XCTAssertNil(try handle.readToEnd(), "EOF should return nil")
+    }
+
+    func testReadToEndOfLargeFileIsNotChangedByLaterWrites() throws {
+        let size = 17 * 1024 * 1024
+        let url = createTemporaryFile(containing: Data(repeating: 0xAA, count: size))
+        let handle = try FileHandle(forReadingFrom: url)
+        allHandles.append(handle)
+
+        let read = try XCTUnwrap(handle.readToEnd())
+
+        let writer = try FileHandle(forWritingTo: url)
+        allHandles.append(writer)
+        try writer.write(contentsOf: Data(repeating: 0x55, count: 4096))
+        try writer.truncate(atOffset: 8192)
+
+        XCTAssertEqual(read.count, size)
+        XCTAssertEqual(read.first, 0xAA)
+        XCTAssertEqual(read.last, 0xAA, "Data read to end must be a copy, not a mapping of the file")
+    }
+
+#if NS_FOUNDATION_ALLOWS_TESTABLE_IMPORT && !os(Windows)
+    func testMappedReadFromOffset() throws {
+        let handle = createFileHandle()
+        try handle.seek(toOffset: 10)
+
+        let mapped = try handle._readDataOfLength(Int.max, untilEOF: true, options: .alwaysMapped).toData()
+        XCTAssertEqual(mapped, content[10...])
+        XCTAssertEqual(try handle.offset(), UInt64(content.count))
+    }
+#endif
+
+    func testReadToEndOfPipe() throws {
+        let pipe = Pipe()
+        let data = Data((0..<(3 * 1024 * 1024 + 17)).map { UInt8(truncatingIfNeeded: $0 &* 7) })
+
+        let writer = Thread {
+            try? pipe.fileHandleForWriting.write(contentsOf: data)
+            try? pipe.fileHandleForWriting.close()
+        }
+        writer.start()
+
+        let received = try XCTUnwrap(pipe.fileHandleForReading.readToEnd())
+        XCTAssertEqual(received.count, data.count)
+        XCTAssertTrue(received == data, "Data read from a pipe should arrive intact and in order")
+    }
+
     func testOffset() {
 #if NS_FOUNDATION_ALLOWS_TESTABLE_IMPORT && !os(Windows)
         // One byte at a time:
@@ -82,6 +82,21 @@ class TestHTTPCookieStorage: XCTestCase {
         checkCookieDomainMatching(for: .groupContainer("test"))
     }
 
+    func test_cookiesForURLWithManyDomains() {
+        checkCookiesForURLWithManyDomains(for: .shared)
+        checkCookiesForURLWithManyDomains(for: .groupContainer("test"))
+    }
+
+    func test_expiredCookiesAreRemoved() {
+        checkExpiredCookiesAreRemoved(for: .shared)
+        checkExpiredCookiesAreRemoved(for: .groupContainer("test"))
+    }
+
+    func test_manyCookiesSetOneAtATime() {
+        // A storage of its own, so that the shared one is left alone.
+        checkManyCookiesSetOneAtATime(in: URLSessionConfiguration.ephemeral.httpCookieStorage!)
+    }
+
     func cookieStorage(for type: StorageType) -> HTTPCookieStorage {
         switch type {
         case .shared:
@@ -308,6 +323,133 @@ class TestHTTPCookieStorage: XCTestCase {
         XCTAssertEqual(storage.cookies(for: superSwiftOrgUrl)!, [])
     }
 
+    func checkCookiesForURLWithManyDomains(for storageType: StorageType) {
+        let storage = cookieStorage(for: storageType)
+        let expires = Date(timeIntervalSinceNow: 1000)
+
+        var cookies: [HTTPCookie] = []
+        for index in 0..<5_000 {
+            let cookie = HTTPCookie(properties: [
+               .name: "TestCookie\(index)",
+               .value: "TestValue\(index)",
+               .path: "/",
+               .domain: index % 2 == 0 ? "host\(index).example.com" : ".host\(index).example.com",
+               .expires: expires,
+            ])!
+            cookies.append(cookie)
+        }
+        let parentCookie = HTTPCookie(properties: [
+           .name: "ParentCookie",
+           .value: "ParentValue",
+           .path: "/",
+           .domain: ".example.com",
+        ])!
+        storage.setCookies(cookies + [parentCookie], for: URL(string: "https://example.com"), mainDocumentURL: nil)
+        XCTAssertEqual(storage.cookies!.count, 5_001)
+
+        XCTAssertEqual(Set(storage.cookies(for: URL(string: "https://host42.example.com")!)!), Set([cookies[42], parentCookie]))
+        XCTAssertEqual(Set(storage.cookies(for: URL(string: "https://www.host43.example.com")!)!), Set([cookies[43], parentCookie]))
+        XCTAssertEqual(storage.cookies(for: URL(string: "https://www.host42.example.com")!)!, [parentCookie])
+        XCTAssertEqual(storage.cookies(for: URL(string: "https://host42.example.org")!)!, [])
+
+        storage.deleteCookie(parentCookie)
+        XCTAssertEqual(storage.cookies(for: URL(string: "https://host42.example.com")!)!, [cookies[42]])
+
+        storage.removeCookies(since: Date(timeIntervalSince1970: 0))
+        XCTAssertEqual(storage.cookies!.count, 0)
+        XCTAssertEqual(storage.cookies(for: URL(string: "https://host42.example.com")!)!, [])
+    }
+
+    func checkManyCookiesSetOneAtATime(in storage: HTTPCookieStorage) {
+        let expires = Date(timeIntervalSinceNow: 1000)
+        let count = 1_000
+
+        func makeCookie(_ index: Int, value: String) -> HTTPCookie {
+            return HTTPCookie(properties: [
+               .name: "TestCookie\(index)",
+               .value: value,
+               .path: "/",
+               .domain: "host\(index % 100).example.com",
+               .expires: expires,
+            ])!
+        }
+
+        // Every call inserts, replaces or removes a single entry.
+        for index in 0..<count {
+            storage.setCookie(makeCookie(index, value: "Original"))
+        }
+        XCTAssertEqual(storage.cookies!.count, count)
+
+        for index in stride(from: 0, to: count, by: 2) {
+            storage.setCookie(makeCookie(index, value: "Replaced"))
+        }
+        XCTAssertEqual(storage.cookies!.count, count)
+
+        for index in stride(from: 0, to: count, by: 4) {
+            storage.deleteCookie(makeCookie(index, value: "Replaced"))
+        }
+        XCTAssertEqual(storage.cookies!.count, count - count / 4)
+
+        // host0 only held cookies that were deleted, host1 only ones that were
+        // never touched again, and host2 only ones that were replaced.
+        XCTAssertEqual(storage.cookies(for: URL(string: "https://host0.example.com")!)!, [])
+        let originals = storage.cookies(for: URL(string: "https://host1.example.com")!)!
+        XCTAssertEqual(originals.count, count / 100)
+        XCTAssertTrue(originals.allSatisfy { $0.value == "Original" })
+        let replaced = storage.cookies(for: URL(string: "https://host2.example.com")!)!
+        XCTAssertEqual(replaced.count, count / 100)
+        XCTAssertTrue(replaced.allSatisfy { $0.value == "Replaced" })
+
+        storage.removeCookies(since: Date(timeIntervalSince1970: 0))
+        XCTAssertEqual(storage.cookies!.count, 0)
+    }
+
+    func checkExpiredCookiesAreRemoved(for storageType: StorageType) {
+        let storage = cookieStorage(for: storageType)
+
+        let shortLivedCookie = HTTPCookie(properties: [
+           .name: "ShortLived",
+           .value: "TestValue",
+           .path: "/",
+           .domain: "swift.org",
+           .expires: Date(timeIntervalSinceNow: 1),
+        ])!
+        let longLivedCookie = HTTPCookie(properties: [
+           .name: "LongLived",
+           .value: "TestValue",
+           .path: "/",
+           .domain: "swift.org",
+           .expires: Date(timeIntervalSinceNow: 1000),
+        ])!
+        storage.setCookie(shortLivedCookie)
+        storage.setCookie(longLivedCookie)
+        XCTAssertEqual(storage.cookies!.count, 2)
+
+        // Replacing a cookie moves its expiry date.
+        let renewedCookie = HTTPCookie(properties: [
+           .name: "ShortLived",
+           .value: "TestValue",
+           .path: "/",
+           .domain: "swift.org",
+           .expires: Date(timeIntervalSinceNow: 1000),
+        ])!
+        storage.setCookie(renewedCookie)
+
+        Thread.sleep(forTimeInterval: 1.5)
+        storage.setCookie(longLivedCookie)
+        XCTAssertEqual(storage.cookies!.count, 2)
+
+        let expiredCookie = HTTPCookie(properties: [
+           .name: "Expired",
+           .value: "TestValue",
+           .path: "/",
+           .domain: "swift.org",
+           .expires: Date(timeIntervalSinceNow: -1),
+        ])!
+        storage.setCookie(expiredCookie)
+        XCTAssertEqual(Set(storage.cookies!), Set([renewedCookie, longLivedCookie]))
+    }
+
     func test_cookieInXDGSpecPath() throws {
 #if !os(Android) && !DARWIN_COMPATIBILITY_TESTS && !os(Windows)// No XDG on native Foundation
         //Test without setting the environment variable
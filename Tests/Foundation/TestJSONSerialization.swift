@@ -814,6 +814,105 @@ extension TestJSONSerialization {
     }
 
 
+    func test_incrementalParser_ndjsonOneByteAtATime() throws {
+        let subject = #"{"id":1,"name":"a \"quoted\" } name"}"# + "\n" + #"[1,[2,{"x":"]"}]]"# + "\n\n" + #"{"id":2}"# + "\n"
+        var parser = JSONSerialization.IncrementalParser()
+        var values: [Any] = []
+        for byte in Array(subject.utf8) {
+            values += try parser.parse(Data([byte]))
+        }
+        values += try parser.finish()
+
+        XCTAssertEqual(values.count, 3)
+        let first = values.first as? [String: Any]
+        XCTAssertEqual(first?["id"] as? Int, 1)
+        XCTAssertEqual(first?["name"] as? String, #"a "quoted" } name"#)
+        let second = values.dropFirst().first as? [Any]
+        XCTAssertEqual(second?.count, 2)
+        XCTAssertEqual(((second?.last as? [Any])?.last as? [String: Any])?["x"] as? String, "]")
+        XCTAssertEqual((values.last as? [String: Any])?["id"] as? Int, 2)
+    }
+
+    func test_incrementalParser_byteOrderMarkOneByteAtATime() throws {
+        var parser = JSONSerialization.IncrementalParser()
+        var values: [Any] = []
+        for byte in [0xEF, 0xBB, 0xBF] + Array(#"{"a":1}"#.utf8) + [0x0A] + Array("[2]".utf8) {
+            values += try parser.parse(Data([byte]))
+        }
+        values += try parser.finish()
+        XCTAssertEqual(values.count, 2)
+        XCTAssertEqual((values.first as? [String: Any])?["a"] as? Int, 1)
+        XCTAssertEqual(values.last as? [Int], [2])
+
+        // Input shorter than a byte order mark is only parsed at the end.
+        var short = JSONSerialization.IncrementalParser()
+        XCTAssertEqual(try short.parse(Data("[]".utf8)).count, 0)
+        let shortValues = try short.finish()
+        XCTAssertEqual(shortValues.count, 1)
+        XCTAssertEqual((shortValues.first as? [Any])?.count, 0)
+
+        // Character indexes still count the byte order mark.
+        var invalid = JSONSerialization.IncrementalParser()
+        XCTAssertNoThrow(try invalid.parse(Data([0xEF])))
+        XCTAssertNoThrow(try invalid.parse(Data([0xBB])))
+        XCTAssertThrowsError(try invalid.parse(Data([0xBF] + Array("x".utf8)))) { error in
+            XCTAssertEqual((error as NSError).userInfo[NSDebugDescriptionErrorKey] as? String, "Invalid value around character 3.")
+        }
+    }
+
+    func test_incrementalParser_valuesAreReturnedAsSoonAsTheyComplete() throws {
+        var parser = JSONSerialization.IncrementalParser(options: .fragmentsAllowed)
+        XCTAssertEqual(try parser.parse(Data("[1, 2".utf8)).count, 0)
+        XCTAssertEqual((try parser.parse(Data(#"]{"a""#.utf8)).first as? [Any])?.count, 2)
+        XCTAssertEqual(try parser.parse(Data(#": true} "str"#.utf8)).count, 1)
+        XCTAssertEqual(try parser.parse(Data(#"ing" 12"#.utf8)).first as? String, "string")
+        // A top-level number is only known to be complete at whitespace or the end of the input.
+        XCTAssertEqual(try parser.parse(Data("34".utf8)).count, 0)
+        XCTAssertEqual(try parser.finish().first as? Int, 1234)
+    }
+
+    func test_incrementalParser_errors() {
+        var fragments = JSONSerialization.IncrementalParser()
+        XCTAssertThrowsError(try fragments.parse(Data(#""fragment" "#.utf8)))
+
+        var truncated = JSONSerialization.IncrementalParser()
+        XCTAssertNoThrow(try truncated.parse(Data(#"{"a": [1, 2"#.utf8)))
+        XCTAssertThrowsError(try truncated.finish()) { error in
+            XCTAssertEqual((error as NSError).userInfo[NSDebugDescriptionErrorKey] as? String, "Unexpected end of file during JSON parse.")
+        }
+
+        // Character indexes are relative to the start of the input, not of the failing value.
+        var invalid = JSONSerialization.IncrementalParser()
+        XCTAssertNoThrow(try invalid.parse(Data("{}\n[1, ".utf8)))
+        XCTAssertThrowsError(try invalid.parse(Data("x]".utf8))) { error in
+            XCTAssertEqual((error as NSError).userInfo[NSDebugDescriptionErrorKey] as? String, "Invalid value around character 7.")
+        }
+    }
+
+    func test_enumerateJSONObjects_withStream() throws {
+        let records = (0..<10_000).map { #"{"id":\#($0),"tags":["a","b"]}"# }
+        let data = Data(records.joined(separator: "\n").utf8)
+
+        let stream = InputStream(data: data)
+        stream.open()
+        defer { stream.close() }
+        var ids: [Int] = []
+        try JSONSerialization.enumerateJSONObjects(with: stream) { value, _ in
+            ids.append(try XCTUnwrap((value as? [String: Any])?["id"] as? Int))
+        }
+        XCTAssertEqual(ids, Array(0..<10_000))
+
+        let stoppingStream = InputStream(data: data)
+        stoppingStream.open()
+        defer { stoppingStream.close() }
+        var count = 0
+        try JSONSerialization.enumerateJSONObjects(with: stoppingStream) { _, stop in
+            count += 1
+            stop = count == 5
+        }
+        XCTAssertEqual(count, 5)
+    }
+
     private func getjsonObjectResult(_ data: Data,
                                      _ objectType: ObjectType,
                                      options opt: JSONSerialization.ReadingOptions = []) throws -> Any {
@@ -1313,6 +1412,20 @@ extension TestJSONSerialization {
         XCTAssertEqual(try trySerialize(json), "[\"j\\/\"]")
     }
 
+    func test_serialize_stringEscapingAtEveryOffset() throws {
+        // Escapes are found eight bytes at a time, so put each one at every
+        // position within a word, next to multi-byte characters.
+        let escapes: [(String, String)] = [("\"", "\\\""), ("\\", "\\\\"), ("/", "\\/"), ("\n", "\\n"), ("\u{1}", "\\u0001"), ("\u{1b}", "\\u001b")]
+        for (character, escaped) in escapes {
+            for offset in 0..<17 {
+                let prefix = String(repeating: "x", count: offset)
+                let subject = prefix + character + "é😀" + prefix
+                XCTAssertEqual(try trySerialize([subject]), "[\"" + prefix + escaped + "é😀" + prefix + "\"]")
+            }
+        }
+        XCTAssertEqual(try trySerialize(["0123456789/abcdef"], options: .withoutEscapingSlashes), "[\"0123456789/abcdef\"]")
+    }
+
     func test_serialize_fragments() {
         XCTAssertEqual(try trySerialize(2, options: .fragmentsAllowed), "2")
         XCTAssertEqual(try trySerialize(false, options: .fragmentsAllowed), "false")
@@ -1376,6 +1489,21 @@ extension TestJSONSerialization {
         XCTAssertEqual(1, res)
     }
     
+    func test_deserialize_integerBoundaries() throws {
+        let subject = "[18446744073709551615, 18446744073709551616, -999999999999999999, 9223372036854775807, -0, 0.5e1, 123456789012345678901234]"
+        let result = try XCTUnwrap(JSONSerialization.jsonObject(with: Data(subject.utf8)) as? [NSNumber])
+        XCTAssertEqual(result.count, 7)
+        XCTAssertEqual(result[0].uint64Value, UInt64.max)
+        // One past UInt64.max no longer fits an integer and keeps its digits as a decimal.
+        XCTAssertTrue(result[1] is NSDecimalNumber)
+        XCTAssertEqual(result[1].decimalValue, Decimal(string: "18446744073709551616"))
+        XCTAssertEqual(result[2].int64Value, -999_999_999_999_999_999)
+        XCTAssertEqual(result[3].int64Value, Int64.max)
+        XCTAssertEqual(result[4].intValue, 0)
+        XCTAssertEqual(result[5].doubleValue, 5)
+        XCTAssertTrue(result[6] is NSDecimalNumber)
+    }
+
     func test_jsonObjectToOutputStreamBuffer() {
         let dict = ["a":["b":1]]
         do {
@@ -1421,6 +1549,37 @@ extension TestJSONSerialization {
         }
     }
     
+    func test_jsonObjectToOutputStreamLargeDocument() throws {
+        // Large enough to be written out in several blocks.
+        let object = (0..<20_000).map { ["id": $0, "name": "Record \"\($0)\"", "path": "/a/b/\($0)"] as [String: Any] }
+        let expected = try JSONSerialization.data(withJSONObject: object, options: [.sortedKeys])
+
+        let filePath = try XCTUnwrap(createTestFile("TestLargeFileOut.json", _contents: Data()))
+        defer { removeTestFile(filePath) }
+        let outputStream = try XCTUnwrap(OutputStream(toFileAtPath: filePath, append: false))
+        outputStream.open()
+        let result = try JSONSerialization.writeJSONObject(object, toStream: outputStream, options: [.sortedKeys])
+        outputStream.close()
+
+        XCTAssertEqual(result, expected.count)
+        XCTAssertEqual(try Data(contentsOf: URL(fileURLWithPath: filePath)), expected)
+    }
+
+    func test_jsonObjectToOutputStreamInvalidLargeDocument() throws {
+        // Invalid only at the end, after several blocks' worth of valid records.
+        var object: [Any] = (0..<20_000).map { ["id": $0, "name": "Record \($0)"] as [String: Any] }
+        object.append(Double.nan)
+
+        let filePath = try XCTUnwrap(createTestFile("TestInvalidFileOut.json", _contents: Data()))
+        defer { removeTestFile(filePath) }
+        let outputStream = try XCTUnwrap(OutputStream(toFileAtPath: filePath, append: false))
+        outputStream.open()
+        XCTAssertThrowsError(try JSONSerialization.writeJSONObject(object, toStream: outputStream, options: []))
+        outputStream.close()
+
+        XCTAssertEqual(try Data(contentsOf: URL(fileURLWithPath: filePath)), Data(), "Nothing should be written for an invalid object")
+    }
+
     func test_jsonObjectToOutputStreamInsufficientBuffer() {
 #if !DARWIN_COMPATIBILITY_TESTS  // Hangs
         let dict = ["a":["b":1]]
@@ -533,6 +533,72 @@ class TestNSArray : XCTestCase {
         XCTAssertTrue(mutableStringsInput1.isEqual(to: Array(mutableStringsInput2)))
     }
 
+    private final class SortRecord : NSObject {
+        let key: Int
+        let position: Int
+
+        init(key: Int, position: Int) {
+            self.key = key
+            self.position = position
+        }
+    }
+
+    func test_sortUsingDescriptorsOnLargeArray() {
+        // Few enough keys that most elements compare equal.
+        let count = 100_000
+        var generator = SystemRandomNumberGenerator()
+        let records = (0..<count).map { SortRecord(key: Int.random(in: 0..<1_000, using: &generator), position: $0) }
+
+        let sorted = NSArray(array: records).sortedArray(using: [NSSortDescriptor(keyPath: \SortRecord.key, ascending: true)])
+        XCTAssertEqual(sorted.count, count)
+
+        let expected = records.sorted { ($0.key, $0.position) < ($1.key, $1.position) }
+        XCTAssertTrue(zip(sorted, expected).allSatisfy { ($0 as! SortRecord) === $1 }, "Sorting should be stable")
+    }
+
+    func test_sortedArrayIsStable() {
+        let input = (0..<10_000).map { NSNumber(value: ($0 * 7_919) % 97) }
+        let byValue: (Any, Any) -> ComparisonResult = { left, right in
+            let l = (left as! NSNumber).intValue
+            let r = (right as! NSNumber).intValue
+            return l < r ? .orderedAscending : (l == r ? .orderedSame : .orderedDescending)
+        }
+        let expected = input.enumerated().sorted { ($0.element.intValue, $0.offset) < ($1.element.intValue, $1.offset) }.map { $0.element }
+
+        for options in [[], NSSortOptions.stable, NSSortOptions.concurrent, [.concurrent, .stable]] as [NSSortOptions] {
+            let result = NSArray(array: input).sortedArray(options: options, usingComparator: byValue)
+            XCTAssertTrue(zip(result, expected).allSatisfy { ($0 as! NSNumber) === $1 }, "Sorting with \(options) should keep equal elements in order")
+        }
+    }
+
+    func test_sortedArrayConcurrently() {
+        // Enough elements that the sort is split into sections on several
+        // threads, with few enough keys that the merges have to keep ties in order.
+        let count = 50_000
+        var generator = SystemRandomNumberGenerator()
+        let records = (0..<count).map { SortRecord(key: Int.random(in: 0..<100, using: &generator), position: $0) }
+        let byKey: (Any, Any) -> ComparisonResult = { left, right in
+            let l = (left as! SortRecord).key
+            let r = (right as! SortRecord).key
+            return l < r ? .orderedAscending : (l == r ? .orderedSame : .orderedDescending)
+        }
+        let expected = records.sorted { ($0.key, $0.position) < ($1.key, $1.position) }
+
+        let sorted = NSArray(array: records).sortedArray(options: .concurrent, usingComparator: byKey)
+        XCTAssertEqual(sorted.count, count)
+        XCTAssertTrue(zip(sorted, expected).allSatisfy { ($0 as! SortRecord) === $1 }, "Sorting concurrently should order every element and keep ties in order")
+    }
+
+    func test_sortedArrayWithInconsistentComparator() {
+        // A comparator that contradicts itself gets no particular order back,
+        // but every element must still be there exactly once.
+        let numbers = NSArray(array: (0..<5_000).map { NSNumber(value: $0) })
+        let results: [ComparisonResult] = [.orderedAscending, .orderedSame, .orderedDescending]
+        let sorted = numbers.sortedArray { _, _ in results.randomElement()! }
+        XCTAssertEqual(Set(sorted.map { ($0 as! NSNumber).intValue }), Set(0..<5_000))
+        XCTAssertEqual(sorted.count, numbers.count)
+    }
+
     func test_equality() {
         let array1 = NSArray(array: ["this", "is", "a", "test", "of", "equal", "with", "strings"])
         let array2 = NSArray(array: ["this", "is", "a", "test", "of", "equal", "with", "strings"])
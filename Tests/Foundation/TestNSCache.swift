@@ -101,6 +101,86 @@ class TestNSCache : XCTestCase {
         
     }
 
+    func test_leastRecentlyUsedIsEvicted() {
+        let cache = NSCache<NSString, NSString>()
+        cache.countLimit = 2
+        
+        cache.setObject("object1", forKey: "1")
+        cache.setObject("object2", forKey: "2")
+        
+        // Reading "1" makes "2" the least recently used object.
+        XCTAssertEqual(cache.object(forKey: "1"), "object1", "should be equal to 'object1'")
+        
+        cache.setObject("object3", forKey: "3")
+        
+        XCTAssertNil(cache.object(forKey: "2"), "should be nil")
+        XCTAssertEqual(cache.object(forKey: "1"), "object1", "should be equal to 'object1'")
+        XCTAssertEqual(cache.object(forKey: "3"), "object3", "should be equal to 'object3'")
+    }
+    
+    private final class CachedValue {
+        let key: Int
+        let cost: Int
+
+        init(key: Int, cost: Int) {
+            self.key = key
+            self.cost = cost
+        }
+    }
+
+    private final class EvictionRecorder: NSObject, NSCacheDelegate, @unchecked Sendable {
+        let lock = NSLock()
+        var evicted = Set<Int>()
+
+        func cache(_ cache: NSCache<AnyObject, AnyObject>, willEvictObject obj: Any) {
+            let value = obj as! CachedValue
+            lock.withLock { _ = evicted.insert(value.key) }
+        }
+    }
+
+    func test_concurrentAccessKeepsLimits() {
+        let threadCount = 8
+        let entriesPerThread = 500
+        let countLimit = 200
+        let totalCostLimit = 400
+
+        nonisolated(unsafe) let cache = NSCache<NSNumber, CachedValue>()
+        cache.countLimit = countLimit
+        cache.totalCostLimit = totalCostLimit
+        let recorder = EvictionRecorder()
+        cache.delegate = recorder
+
+        DispatchQueue.concurrentPerform(iterations: threadCount) { thread in
+            for i in 0..<entriesPerThread {
+                let key = thread * entriesPerThread + i
+                cache.setObject(CachedValue(key: key, cost: 1 + key % 3), forKey: NSNumber(value: key), cost: 1 + key % 3)
+                // Look up an older key, which other threads may have evicted.
+                if let value = cache.object(forKey: NSNumber(value: thread * entriesPerThread + i / 2)) {
+                    XCTAssertEqual(value.key, thread * entriesPerThread + i / 2)
+                }
+            }
+        }
+
+        // The limits may be overshot while threads race, but every insertion
+        // purges back down to them before returning.
+        var remainingCount = 0
+        var remainingCost = 0
+        let evicted = recorder.lock.withLock { recorder.evicted }
+        for key in 0..<(threadCount * entriesPerThread) {
+            if let value = cache.object(forKey: NSNumber(value: key)) {
+                XCTAssertEqual(value.key, key)
+                XCTAssertFalse(evicted.contains(key), "an evicted object should not be returned")
+                remainingCount += 1
+                remainingCost += value.cost
+            } else {
+                XCTAssertTrue(evicted.contains(key), "an object that was not evicted should still be cached")
+            }
+        }
+        XCTAssertGreaterThan(remainingCount, 0)
+        XCTAssertLessThanOrEqual(remainingCount, countLimit)
+        XCTAssertLessThanOrEqual(remainingCost, totalCostLimit)
+        XCTAssertEqual(remainingCount + evicted.count, threadCount * entriesPerThread)
+    }
 
     class TestHashableCacheKey: Hashable {
         let string: String
@@ -325,6 +325,62 @@ class TestNSKeyedArchiver : XCTestCase {
         }
     }
 
+    func test_archive_binaryFormat_largeGraph() throws {
+        let records = (0..<2_000).map { index -> NSDictionary in
+            return NSDictionary(dictionary: [
+                "index" : NSNumber(value: index),
+                "negative" : NSNumber(value: -index),
+                "large" : NSNumber(value: UInt64.max - UInt64(index)),
+                "ratio" : NSNumber(value: Double(index) / 7),
+                "float" : NSNumber(value: Float(index) / 4),
+                "flag" : NSNumber(value: index % 2 == 0),
+                "name" : NSString(string: "record \(index)"),
+                "unicode" : NSString(string: "r\u{E9}sum\u{E9} \(index) \u{1F600}"),
+                "bytes" : NSData(data: Data(repeating: UInt8(truncatingIfNeeded: index), count: index % 40)),
+                "date" : NSDate(timeIntervalSinceReferenceDate: Double(index) * 3_600),
+            ])
+        }
+        let array = NSArray(array: records)
+        let data = try NSKeyedArchiver.archivedData(withRootObject: array, requiringSecureCoding: true)
+
+        // The archive must be a binary property list that CF can read on its own.
+        var format = PropertyListSerialization.PropertyListFormat.xml
+        let plist = try PropertyListSerialization.propertyList(from: data, options: [], format: &format) as? [String : Any]
+        XCTAssertEqual(format, .binary)
+        XCTAssertEqual(plist?["$archiver"] as? String, "NSKeyedArchiver")
+        XCTAssertEqual((plist?["$version"] as? NSNumber)?.intValue, 100000)
+        XCTAssertEqual((plist?["$objects"] as? [Any])?.first as? String, "$null")
+
+        let unarchived = try NSKeyedUnarchiver.unarchivedObject(ofClasses: [NSArray.self, NSDictionary.self, NSString.self, NSNumber.self, NSData.self, NSDate.self], from: data) as? NSArray
+        XCTAssertEqual(unarchived, array)
+    }
+
+    func test_archive_outputFormatChangedWhileEncoding() throws {
+        // Large enough that part of the binary archive is written out before the format changes.
+        let first = NSArray(array: (0..<5_000).map { NSString(string: "first \($0)") })
+        let second = NSArray(array: (0..<100).map { NSNumber(value: $0) })
+        let classes: [AnyClass] = [NSArray.self, NSString.self, NSNumber.self]
+
+        for (initial, final) in [(PropertyListSerialization.PropertyListFormat.binary, PropertyListSerialization.PropertyListFormat.xml), (.xml, .binary)] {
+            let archiver = NSKeyedArchiver(requiringSecureCoding: true)
+            archiver.outputFormat = initial
+            archiver.encode(first, forKey: "first")
+            archiver.outputFormat = final
+            archiver.encode(second, forKey: "second")
+            archiver.encode(first, forKey: "again")
+            let data = archiver.encodedData
+
+            var format = initial
+            _ = try PropertyListSerialization.propertyList(from: data, options: [], format: &format)
+            XCTAssertEqual(format, final)
+
+            let unarchiver = try NSKeyedUnarchiver(forReadingFrom: data)
+            XCTAssertEqual(unarchiver.decodeObject(of: classes, forKey: "first") as? NSArray, first)
+            XCTAssertEqual(unarchiver.decodeObject(of: classes, forKey: "second") as? NSArray, second)
+            XCTAssertEqual(unarchiver.decodeObject(of: classes, forKey: "again") as? NSArray, first)
+        }
+    }
+
     func test_archiveRootObject_String() {
         let filePath = NSTemporaryDirectory() + "testdir\(NSUUID().uuidString)"
         let result = NSKeyedArchiver.archiveRootObject("Hello", toFile: filePath)
@@ -336,6 +392,18 @@ class TestNSKeyedArchiver : XCTestCase {
         }
     }
 
+    func test_archiveRootObject_roundTrip() {
+        let filePath = NSTemporaryDirectory() + "testdir\(NSUUID().uuidString)"
+        let array = NSArray(array: (0..<10_000).map { NSString(string: "element \($0)") })
+        XCTAssertTrue(NSKeyedArchiver.archiveRootObject(array, toFile: filePath))
+        XCTAssertEqual(NSKeyedUnarchiver.unarchiveObject(withFile: filePath) as? NSArray, array)
+        do {
+            try FileManager.default.removeItem(atPath: filePath)
+        } catch {
+            XCTFail("Failed to clean up file")
+        }
+    }
+
     func test_archiveRootObject_URLRequest() {
         let filePath = NSTemporaryDirectory() + "testdir\(NSUUID().uuidString)"
         let url = URL(string: "http://swift.org")!
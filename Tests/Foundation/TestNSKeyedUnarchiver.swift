@@ -122,4 +122,19 @@ class TestNSKeyedUnarchiver : XCTestCase {
         let uuid = NSUUID(uuidString: "0AD863BA-7584-40CF-8896-BD87B3280C34")
         try test_unarchive_from_file("NSKeyedUnarchiver-UUIDTest", uuid!)
     }
+    
+    func test_unarchive_sharedObjects() throws {
+        let shared = NSMutableArray(array: ["shared"])
+        let array = NSArray(array: [shared, "other", shared])
+        let data = try NSKeyedArchiver.archivedData(withRootObject: array, requiringSecureCoding: true)
+        
+        let unarchived = try XCTUnwrap(NSKeyedUnarchiver.unarchivedObject(ofClasses: [NSArray.self, NSMutableArray.self, NSString.self], from: data) as? NSArray)
+        XCTAssertEqual(unarchived, array)
+        XCTAssertTrue(unarchived[0] as AnyObject === unarchived[2] as AnyObject)
+    }
+    
+    func test_unarchive_truncatedArchive() throws {
+        let data = try NSKeyedArchiver.archivedData(withRootObject: NSArray(array: ["baa", "baa", "black", "sheep"]), requiringSecureCoding: true)
+        XCTAssertThrowsError(try NSKeyedUnarchiver.unarchivedObject(ofClasses: [NSArray.self, NSString.self], from: data.prefix(data.count - 8)))
+    }
 }
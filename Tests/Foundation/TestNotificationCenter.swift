@@ -129,7 +129,50 @@ class TestNotificationCenter : XCTestCase {
         notificationCenter.post(name: notificationName, object: nil)
         XCTAssertTrue(flag)
     }
-    
+
+    func test_concurrentPostsWhileObserversChange() {
+        let notificationCenter = NotificationCenter()
+        let names = (0..<32).map { Notification.Name(rawValue: "test_concurrentPostsWhileObserversChange_\($0)") }
+        let lock = NSLock()
+        nonisolated(unsafe) var namedCount = 0
+        nonisolated(unsafe) var anyNameCount = 0
+
+        let namedObservers = names.map { name in
+            notificationCenter.addObserver(forName: name, object: nil, queue: nil) { notification in
+                XCTAssertEqual(notification.name, name)
+                lock.withLock { namedCount += 1 }
+            }
+        }
+        let anyNameObserver = notificationCenter.addObserver(forName: nil, object: nil, queue: nil) { _ in
+            lock.withLock { anyNameCount += 1 }
+        }
+
+        let postsPerIteration = 100
+        DispatchQueue.concurrentPerform(iterations: names.count * 2) { iteration in
+            if iteration < names.count {
+                for _ in 0..<postsPerIteration {
+                    notificationCenter.post(name: names[iteration], object: nil)
+                }
+            } else {
+                // Observers coming and going must not disturb posts that are already delivering.
+                let name = names[iteration - names.count]
+                for _ in 0..<postsPerIteration {
+                    let transient = notificationCenter.addObserver(forName: name, object: NotificationCenterDummyObject(), queue: nil) { _ in }
+                    self.removeObserver(transient, notificationCenter: notificationCenter)
+                }
+            }
+        }
+
+        XCTAssertEqual(namedCount, names.count * postsPerIteration)
+        XCTAssertEqual(anyNameCount, names.count * postsPerIteration)
+
+        namedObservers.forEach { removeObserver($0, notificationCenter: notificationCenter) }
+        removeObserver(anyNameObserver, notificationCenter: notificationCenter)
+        notificationCenter.post(name: names[0], object: nil)
+        XCTAssertEqual(namedCount, names.count * postsPerIteration)
+        XCTAssertEqual(anyNameCount, names.count * postsPerIteration)
+    }
+
     func test_observeOnPostingQueue() {
         let notificationCenter = NotificationCenter()
         let name = Notification.Name(rawValue: "\(#function)_name")
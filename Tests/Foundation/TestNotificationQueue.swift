@@ -183,6 +183,46 @@ class TestNotificationQueue : XCTestCase {
         NotificationCenter.default.removeObserver(obs)
     }
 
+    func test_postAsapCoalescesManyNotificationsInOrder() {
+        let notificationCenter = NotificationCenter()
+        let queue = NotificationQueue(notificationCenter: notificationCenter)
+        let names = (0..<100).map { Notification.Name(rawValue: "test_postAsapCoalescesManyNotificationsInOrder_\($0)") }
+        let senders = (0..<10).map { _ in DummyObject() }
+        nonisolated(unsafe) var posted: [(Notification.Name, DummyObject?)] = []
+        let obs = notificationCenter.addObserver(forName: nil, object: nil, queue: nil) { notification in
+            posted.append((notification.name, notification.object as? DummyObject))
+        }
+
+        // Each name is enqueued repeatedly for every sender; only the last one for each pair survives.
+        for _ in 0..<10 {
+            for name in names {
+                for sender in senders {
+                    queue.enqueue(Notification(name: name, object: sender), postingStyle: .asap)
+                }
+            }
+        }
+        // Replaces every pending notification sent by the first sender with this one.
+        queue.enqueue(Notification(name: names[0], object: senders[0]), postingStyle: .asap, coalesceMask: .onSender, forModes: nil)
+        // Not coalesced, so both are posted.
+        queue.enqueue(Notification(name: names[1], object: nil), postingStyle: .asap, coalesceMask: [], forModes: nil)
+        queue.enqueue(Notification(name: names[1], object: nil), postingStyle: .asap, coalesceMask: [], forModes: nil)
+
+        scheduleTimer(withInterval: 0.001)
+
+        var expected: [(Notification.Name, DummyObject?)] = []
+        for name in names {
+            for sender in senders.dropFirst() {
+                expected.append((name, sender))
+            }
+        }
+        expected.append((names[0], senders[0]))
+        expected.append((names[1], nil))
+        expected.append((names[1], nil))
+        XCTAssertEqual(posted.count, expected.count)
+        XCTAssertTrue(zip(posted, expected).allSatisfy { $0.0 == $1.0 && $0.1 === $1.1 }, "Notifications were not posted once each in the order they were enqueued")
+        notificationCenter.removeObserver(obs)
+    }
+
     func test_notificationQueueLifecycle() {
         // check that notificationqueue is associated with current thread. when the thread is destroyed, the queue should be deallocated as well
         nonisolated(unsafe) weak var notificationQueue: NotificationQueue?
@@ -80,4 +80,149 @@ class TestPropertyListSerialization : XCTestCase {
             XCTAssertEqual(nserror.userInfo[NSDebugDescriptionErrorKey] as? String, "Cannot parse a NULL or zero-length data")
         }
     }
+
+    func test_binaryWriterUniquesEqualLeaves() throws {
+        let shared = NSString(string: "shared value")
+        let plist = NSArray(array: (0..<1_000).map { index -> Any in
+            switch index % 4 {
+            case 0: return shared
+            case 1: return NSString(string: "shared value")
+            case 2: return NSNumber(value: 123_456)
+            default: return NSArray(array: [shared, NSNumber(value: 123_456)])
+            }
+        })
+        let data = try PropertyListSerialization.data(fromPropertyList: plist, format: .binary, options: 0)
+
+        // One string, one number, 250 small arrays and the root array.
+        XCTAssertLessThan(data.count, 5_000)
+        let decoded = try PropertyListSerialization.propertyList(from: data, format: nil) as? NSArray
+        XCTAssertEqual(decoded, plist)
+    }
+
+    func test_binaryView() throws {
+        let plist: [String : Any] = [
+            "string" : "hello",
+            "unicode" : "h\u{E9}llo \u{1F600}",
+            "integer" : -42,
+            "large" : UInt64.max,
+            "real" : 2.5,
+            "flag" : true,
+            "date" : Date(timeIntervalSinceReferenceDate: 1_000),
+            "data" : Data([0, 1, 2, 3]),
+            "array" : [1, "two", [3]],
+        ]
+        let data = try PropertyListSerialization.data(fromPropertyList: plist, format: .binary, options: 0)
+        let view = try PropertyListSerialization.BinaryView(data: data)
+
+        let root = view.root
+        XCTAssertEqual(root.kind, .dictionary)
+        XCTAssertEqual(root.count, plist.count)
+        XCTAssertEqual(root["string"]?.stringValue, "hello")
+        XCTAssertEqual(root["string"]?.withUnsafeBytes { Array($0) }, Array("hello".utf8))
+        XCTAssertEqual(root["unicode"]?.stringValue, "h\u{E9}llo \u{1F600}")
+        XCTAssertEqual(root["integer"]?.integerValue, -42)
+        XCTAssertNil(root["integer"]?.unsignedIntegerValue)
+        XCTAssertEqual(root["large"]?.unsignedIntegerValue, UInt64.max)
+        XCTAssertNil(root["large"]?.integerValue)
+        XCTAssertEqual(root["real"]?.doubleValue, 2.5)
+        XCTAssertEqual(root["flag"]?.boolValue, true)
+        XCTAssertEqual(root["date"]?.dateValue, Date(timeIntervalSinceReferenceDate: 1_000))
+        XCTAssertEqual(root["data"]?.dataValue, Data([0, 1, 2, 3]))
+        XCTAssertNil(root["missing"])
+
+        let array = try XCTUnwrap(root["array"])
+        XCTAssertEqual(array.kind, .array)
+        XCTAssertEqual(array.count, 3)
+        XCTAssertEqual(array[0]?.integerValue, 1)
+        XCTAssertEqual(array[1]?.stringValue, "two")
+        XCTAssertEqual(array[2]?[0]?.integerValue, 3)
+        XCTAssertNil(array[3])
+        XCTAssertEqual(array.propertyList as? NSArray, NSArray(array: [1, "two", [3]]))
+
+        let keys = (0..<root.count).compactMap { root.key(at: $0)?.stringValue }
+        XCTAssertEqual(Set(keys), Set(plist.keys))
+        XCTAssertEqual(root.value(at: keys.firstIndex(of: "string")!)?.stringValue, "hello")
+    }
+
+    func test_binaryView_mappedFile() throws {
+        let plist = Dictionary(uniqueKeysWithValues: (0..<10_000).map { ("key \($0)", "value \($0)") })
+        let data = try PropertyListSerialization.data(fromPropertyList: plist, format: .binary, options: 0)
+        let url = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent("TestPropertyListSerialization-\(UUID().uuidString).plist")
+        try data.write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        let view = try PropertyListSerialization.BinaryView(contentsOf: url)
+        XCTAssertEqual(view.root.count, 10_000)
+        XCTAssertEqual(view.root["key 9999"]?.stringValue, "value 9999")
+        XCTAssertEqual(view.root["key 0"]?.stringValue, "value 0")
+    }
+
+    func test_binaryView_invalidData() {
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: Data())) { error in
+            XCTAssertEqual(CocoaError(_nsError: error as NSError).code, .propertyListReadCorrupt)
+        }
+        let xml = try! PropertyListSerialization.data(fromPropertyList: ["key" : "value"], format: .xml, options: 0)
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: xml))
+    }
+
+    func test_binaryView_unicodeKeys() throws {
+        let plist: [String : Any] = ["caf\u{E9}" : 1, "\u{1F600}" : 2, "cafe" : 3, "caf\u{E9}s" : 4]
+        let data = try PropertyListSerialization.data(fromPropertyList: plist, format: .binary, options: 0)
+        let root = try PropertyListSerialization.BinaryView(data: data).root
+        XCTAssertEqual(root["caf\u{E9}"]?.integerValue, 1)
+        XCTAssertEqual(root["\u{1F600}"]?.integerValue, 2)
+        XCTAssertEqual(root["cafe"]?.integerValue, 3)
+        XCTAssertEqual(root["caf\u{E9}s"]?.integerValue, 4)
+        XCTAssertNil(root["\u{1F601}"])
+    }
+
+    /// Assembles a binary property list from encoded objects, with one-byte offsets and references.
+    private func binaryPlist(_ objects: [[UInt8]], top: UInt64 = 0, offsets: [UInt8]? = nil, offsetTableOffset: UInt64? = nil) -> Data {
+        func bigEndian(_ value: UInt64) -> [UInt8] {
+            return withUnsafeBytes(of: value.bigEndian) { Array($0) }
+        }
+        var bytes = Array("bplist00".utf8)
+        var table: [UInt8] = []
+        for object in objects {
+            table.append(UInt8(bytes.count))
+            bytes += object
+        }
+        let tableOffset = UInt64(bytes.count)
+        bytes += offsets ?? table
+        bytes += [0, 0, 0, 0, 0, 0, 1, 1]
+        bytes += bigEndian(UInt64(objects.count)) + bigEndian(top) + bigEndian(offsetTableOffset ?? tableOffset)
+        return Data(bytes)
+    }
+
+    func test_binaryView_malformedData() throws {
+        // An array holding `true`, to check that the helper builds something readable.
+        let valid = try PropertyListSerialization.BinaryView(data: binaryPlist([[0xA1, 0x01], [0x09]]))
+        XCTAssertEqual(valid.root[0]?.boolValue, true)
+
+        // Bad trailers: a top object past the end of the table, an offset table past
+        // the trailer, and a trailer cut short.
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: binaryPlist([[0x09]], top: 1)))
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: binaryPlist([[0x09]], offsetTableOffset: 1 << 40)))
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: binaryPlist([[0x09]]).dropLast()))
+
+        // Offset table entries past the objects, or pointing into the header.
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: binaryPlist([[0xA1, 0x01], [0x09]], offsets: [8, 200])))
+        let intoHeader = try PropertyListSerialization.BinaryView(data: binaryPlist([[0xA1, 0x01], [0x09]], offsets: [8, 3]))
+        XCTAssertEqual(intoHeader.root.count, 1)
+        XCTAssertNil(intoHeader.root[0])
+
+        // A reference to an object that does not exist.
+        let dangling = try PropertyListSerialization.BinaryView(data: binaryPlist([[0xA1, 0x05], [0x09]]))
+        XCTAssertNil(dangling.root[0])
+        XCTAssertNil(dangling.root.propertyList)
+
+        // A count larger than the data that follows it.
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: binaryPlist([[0xAF, 0x10, 0xFF]])))
+        XCTAssertThrowsError(try PropertyListSerialization.BinaryView(data: binaryPlist([[0x5F, 0x13, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF]])))
+
+        // An array that contains itself can be walked, but not turned into a property list.
+        let cyclic = try PropertyListSerialization.BinaryView(data: binaryPlist([[0xA1, 0x00]]))
+        XCTAssertEqual(cyclic.root[0]?[0]?[0]?.kind, .array)
+        XCTAssertNil(cyclic.root.propertyList)
+    }
 }
@@ -165,6 +165,89 @@ class TestRunLoop : XCTestCase {
         
         XCTAssertTrue(timerFired, "Time should fire already")
     }
+
+    func test_timersFireInDeadlineOrderUnlessCancelled() {
+        let runLoop = RunLoop.current
+        let count = 300
+        let base = Date(timeIntervalSinceNow: 0.1)
+
+        // Scatter the fire dates so that insertion order and fire order differ.
+        var offsets = Array(0..<count)
+        offsets.shuffle()
+
+        // Protected by the ordering of the run loop
+        nonisolated(unsafe) var fired: [Int] = []
+
+        var timers: [Timer] = []
+        for i in 0..<count {
+            let timer = Timer(fire: base.addingTimeInterval(Double(offsets[i]) * 0.001), interval: 0, repeats: false) { _ in
+                fired.append(i)
+            }
+            runLoop.add(timer, forMode: .default)
+            timers.append(timer)
+        }
+        for i in stride(from: 0, to: count, by: 2) {
+            timers[i].invalidate()
+        }
+
+        let deadline = Date(timeIntervalSinceNow: 10)
+        while fired.count < count / 2 && Date() < deadline {
+            _ = runLoop.run(mode: .default, before: Date(timeIntervalSinceNow: 0.05))
+        }
+        // Give any invalidated timer that would wrongly fire the chance to.
+        runLoop.run(until: base.addingTimeInterval(Double(count) * 0.001 + 0.05))
+
+        XCTAssertEqual(fired.count, count / 2)
+        XCTAssertTrue(fired.allSatisfy { $0 % 2 == 1 }, "Invalidated timers should not fire")
+        XCTAssertEqual(fired.map { offsets[$0] }, fired.map { offsets[$0] }.sorted(), "Timers should fire in fire date order")
+    }
+
+    func test_statistics() {
+        let runLoop = RunLoop.current
+        let mode = RunLoop.Mode("test_statistics")
+        XCTAssertNil(runLoop.statistics(forMode: mode))
+
+        // Protected by the ordering of the run loop
+        nonisolated(unsafe) var timerFired = false
+        nonisolated(unsafe) var blockPerformed = false
+        let timer = Timer(timeInterval: 0.05, repeats: false) { _ in
+            timerFired = true
+        }
+        runLoop.add(timer, forMode: mode)
+        runLoop.perform(inModes: [mode]) {
+            blockPerformed = true
+        }
+
+        let deadline = Date(timeIntervalSinceNow: 5)
+        while !timerFired && Date() < deadline {
+            _ = runLoop.run(mode: mode, before: deadline)
+        }
+        XCTAssertTrue(timerFired)
+        XCTAssertTrue(blockPerformed)
+
+        guard let stats = runLoop.statistics(forMode: mode) else {
+            XCTFail("Statistics should exist for a mode that has been run")
+            return
+        }
+        XCTAssertGreaterThan(stats.wakeUps, 0)
+        XCTAssertGreaterThan(stats.timeAsleep, 0)
+        XCTAssertEqual(stats.timers.count, 1)
+        XCTAssertEqual(stats.timers.histogram.count, 20)
+        XCTAssertEqual(stats.timers.histogram.reduce(0, +), 1)
+        XCTAssertNotNil(stats.timers.slowestCallout)
+        XCTAssertGreaterThanOrEqual(stats.timers.totalDuration, stats.timers.maxDuration)
+        XCTAssertEqual(stats.totalTimerLateness, stats.maxTimerLateness)
+
+        let allModes = runLoop.statistics()
+        XCTAssertNotNil(allModes)
+        XCTAssertGreaterThanOrEqual(allModes?.timers.count ?? 0, stats.timers.count)
+
+        runLoop.resetStatistics(forMode: mode)
+        let reset = runLoop.statistics(forMode: mode)
+        XCTAssertEqual(reset?.wakeUps, 0)
+        XCTAssertEqual(reset?.timers.count, 0)
+        XCTAssertNil(reset?.timers.slowestCallout)
+    }
 }
 
 class TestPort: Port {
@@ -148,4 +148,76 @@ class TestSocketPort : XCTestCase {
             port.invalidate()
         }
     }
+
+    #if os(Linux)
+    // Schedules enough listening sockets that their descriptors go well past FD_SETSIZE,
+    // then checks that the ports at the top of that range still receive messages.
+    func testSendingMessagesWithTenThousandScheduledPorts() throws {
+        let portCount = 10_000
+        let needed = rlim_t(portCount + 1024)
+
+        var originalLimit = rlimit()
+        guard getrlimit(__rlimit_resource_t(RLIMIT_NOFILE.rawValue), &originalLimit) == 0 else {
+            throw XCTSkip("Could not read RLIMIT_NOFILE")
+        }
+        if originalLimit.rlim_cur < needed {
+            guard originalLimit.rlim_max >= needed else {
+                throw XCTSkip("RLIMIT_NOFILE hard limit \(originalLimit.rlim_max) is below \(needed)")
+            }
+            var raisedLimit = originalLimit
+            raisedLimit.rlim_cur = needed
+            guard setrlimit(__rlimit_resource_t(RLIMIT_NOFILE.rawValue), &raisedLimit) == 0 else {
+                throw XCTSkip("Could not raise RLIMIT_NOFILE to \(needed)")
+            }
+        }
+        defer { setrlimit(__rlimit_resource_t(RLIMIT_NOFILE.rawValue), &originalLimit) }
+
+        var localPorts = [SocketPort]()
+        localPorts.reserveCapacity(portCount)
+        defer {
+            for port in localPorts {
+                port.setDelegate(nil)
+                port.remove(from: .main, forMode: .default)
+                port.invalidate()
+            }
+        }
+        for _ in 0..<portCount {
+            let local = try XCTUnwrap(SocketPort(tcpPort: 0))
+            local.schedule(in: .main, forMode: .default)
+            localPorts.append(local)
+        }
+
+        let data = Data("I cannot weave".utf8)
+        var remotePorts = [SocketPort]()
+        var delegates = [TestPortDelegateWithBlock]()
+        defer {
+            for port in remotePorts {
+                port.remove(from: .main, forMode: .default)
+                port.invalidate()
+            }
+        }
+        for local in localPorts.suffix(16) {
+            let tcpPort = try UInt16(XCTUnwrap(tcpOrUdpPort(of: local)))
+            let remote = try XCTUnwrap(SocketPort(remoteWithTCPPort: tcpPort, host: "localhost"))
+            remote.schedule(in: .main, forMode: .default)
+            remotePorts.append(remote)
+
+            let received = expectation(description: "Message received on port \(tcpPort)")
+            let delegate = TestPortDelegateWithBlock { message in
+                XCTAssertEqual(message.components as? [AnyHashable], [data as NSData])
+                received.fulfill()
+            }
+            delegates.append(delegate)
+            local.setDelegate(delegate)
+        }
+
+        withExtendedLifetime(delegates) {
+            for remote in remotePorts {
+                let sent = remote.send(before: Date(timeIntervalSinceNow: 5), components: NSMutableArray(array: [data]), from: nil, reserved: 0)
+                XCTAssertTrue(sent)
+            }
+            waitForExpectations(timeout: 30.0)
+        }
+    }
+    #endif
 }
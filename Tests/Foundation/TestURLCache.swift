@@ -7,6 +7,14 @@
 // See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
 //
 
+#if NS_FOUNDATION_ALLOWS_TESTABLE_IMPORT
+    #if canImport(SwiftFoundationNetworking) && !DEPLOYMENT_RUNTIME_OBJC
+        @testable import SwiftFoundationNetworking
+    #else
+        @testable import FoundationNetworking
+    #endif
+#endif
+
 class TestURLCache : XCTestCase {
     
     let aBit = 2 * 1024 /* 2 KB */
@@ -29,7 +37,7 @@ class TestURLCache : XCTestCase {
             let (request, response) = try cachePair(for: "https://google.com/", ofSize: aBit, storagePolicy: .allowed)
             cache.storeCachedResponse(response, for: request)
             
-            XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 1)
+            XCTAssertEqual(try diskEntryCount(), 1)
             XCTAssertNotNil(cache.cachedResponse(for: request))
         }
         
@@ -41,7 +49,7 @@ class TestURLCache : XCTestCase {
             let (request, response) = try cachePair(for: "https://google.com/", ofSize: aBit, storagePolicy: .allowedInMemoryOnly)
             cache.storeCachedResponse(response, for: request)
             
-            XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 0)
+            XCTAssertEqual(try diskEntryCount(), 0)
             XCTAssertNotNil(cache.cachedResponse(for: request))
         }
         
@@ -53,7 +61,7 @@ class TestURLCache : XCTestCase {
             let (request, response) = try cachePair(for: "https://google.com/", ofSize: aBit, storagePolicy: .notAllowed)
             cache.storeCachedResponse(response, for: request)
             
-            XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 0)
+            XCTAssertEqual(try diskEntryCount(), 0)
             XCTAssertNil(cache.cachedResponse(for: request))
         }
         
@@ -65,7 +73,7 @@ class TestURLCache : XCTestCase {
         let (request, response) = try cachePair(for: "https://google.com/", ofSize: aBit)
         cache.storeCachedResponse(response, for: request)
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 0)
+        XCTAssertEqual(try diskEntryCount(), 0)
         XCTAssertNotNil(cache.cachedResponse(for: request))
     }
     
@@ -80,13 +88,13 @@ class TestURLCache : XCTestCase {
             cache.storeCachedResponse(response, for: request)
         }
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 3)
+        XCTAssertEqual(try diskEntryCount(), 3)
         for url in urls {
             XCTAssertNotNil(cache.cachedResponse(for: URLRequest(url: URL(string: url)!)))
         }
         
         cache.diskCapacity = 0
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 0)
+        XCTAssertEqual(try diskEntryCount(), 0)
         for url in urls {
             XCTAssertNotNil(cache.cachedResponse(for: URLRequest(url: URL(string: url)!)))
         }
@@ -97,7 +105,7 @@ class TestURLCache : XCTestCase {
         let (request, response) = try cachePair(for: "https://google.com/", ofSize: aBit)
         cache.storeCachedResponse(response, for: request)
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 1)
+        XCTAssertEqual(try diskEntryCount(), 1)
         XCTAssertNotNil(cache.cachedResponse(for: request))
         
         // Ensure that the fulfillment doesn't come from memory:
@@ -148,7 +156,7 @@ class TestURLCache : XCTestCase {
         let request = URLRequest(url: URL(string: urls[0])!)
         cache.removeCachedResponse(for: request)
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 2)
+        XCTAssertEqual(try diskEntryCount(), 2)
         
         var first = true
         for request in urls.map({ URLRequest(url: URL(string: $0)!) }) {
@@ -173,11 +181,11 @@ class TestURLCache : XCTestCase {
             cache.storeCachedResponse(response, for: request)
         }
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 3)
+        XCTAssertEqual(try diskEntryCount(), 3)
         
         cache.removeAllCachedResponses()
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 0)
+        XCTAssertEqual(try diskEntryCount(), 0)
         
         for request in urls.map({ URLRequest(url: URL(string: $0)!) }) {
             XCTAssertNil(cache.cachedResponse(for: request))
@@ -202,7 +210,7 @@ class TestURLCache : XCTestCase {
         
         cache.removeCachedResponses(since: Date(timeIntervalSinceNow: -3.5))
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 1)
+        XCTAssertEqual(try diskEntryCount(), 1)
         
         first = true
         for request in urls.map({ URLRequest(url: URL(string: $0)!) }) {
@@ -228,13 +236,107 @@ class TestURLCache : XCTestCase {
         let (requestB, responseB) = try cachePair(for: url, ofSize: aBit, startingWith: 2)
         cache.storeCachedResponse(responseB, for: requestB)
         
-        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).count, 1)
+        XCTAssertEqual(try diskEntryCount(), 1)
         
         let response = cache.cachedResponse(for: requestB)
         XCTAssertNotNil(response)
         XCTAssertEqual((try XCTUnwrap(response)).data, responseB.data)
     }
     
+    func testEntriesSurviveReopening() throws {
+        let urls = [ "https://apple.com/",
+                     "https://google.com/",
+                     "https://facebook.com/" ]
+        
+        do {
+            let cache = try self.cache(memoryCapacity: 0, diskCapacity: lots)
+            for (request, response) in try urls.map({ try cachePair(for: $0, ofSize: aBit) }) {
+                cache.storeCachedResponse(response, for: request)
+            }
+            cache.removeCachedResponse(for: URLRequest(url: URL(string: urls[0])!))
+        }
+        
+        let cache = try self.cache(memoryCapacity: 0, diskCapacity: lots)
+        XCTAssertEqual(try diskEntryCount(), 2)
+        XCTAssertNil(cache.cachedResponse(for: URLRequest(url: URL(string: urls[0])!)))
+        for url in urls.dropFirst() {
+            XCTAssertNotNil(cache.cachedResponse(for: URLRequest(url: URL(string: url)!)))
+        }
+        XCTAssertGreaterThan(cache.currentDiskUsage, 2 * aBit)
+    }
+    
+    func testDiskEvictionIsLeastRecentlyUsedFirst() throws {
+        let cache = try self.cache(memoryCapacity: 0, diskCapacity: lots)
+        
+        let urls = [ "https://apple.com/",
+                     "https://google.com/",
+                     "https://facebook.com/" ]
+        
+        for (request, response) in try urls.map({ try cachePair(for: $0, ofSize: aBit) }) {
+            cache.storeCachedResponse(response, for: request)
+        }
+        
+        // Using the oldest entry makes the second one the least recently used.
+        XCTAssertNotNil(cache.cachedResponse(for: URLRequest(url: URL(string: urls[0])!)))
+        
+        cache.diskCapacity = cache.currentDiskUsage - 1
+        
+        XCTAssertEqual(try diskEntryCount(), 2)
+        XCTAssertNotNil(cache.cachedResponse(for: URLRequest(url: URL(string: urls[0])!)))
+        XCTAssertNil(cache.cachedResponse(for: URLRequest(url: URL(string: urls[1])!)))
+        XCTAssertNotNil(cache.cachedResponse(for: URLRequest(url: URL(string: urls[2])!)))
+    }
+    
+    func testIndexIsRebuiltIfLost() throws {
+        let url = "https://apple.com/"
+        let (request, response) = try cachePair(for: url, ofSize: aBit, startingWith: 7)
+        
+        do {
+            let cache = try self.cache(memoryCapacity: 0, diskCapacity: lots)
+            cache.storeCachedResponse(response, for: request)
+        }
+        
+        for file in try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path) where !file.hasSuffix(".cachedurlresponse") {
+            try FileManager.default.removeItem(at: writableTestDirectoryURL.appendingPathComponent(file))
+        }
+        
+        let cache = try self.cache(memoryCapacity: 0, diskCapacity: lots)
+        let storedResponse = try XCTUnwrap(cache.cachedResponse(for: request))
+        XCTAssertEqual(storedResponse, response)
+        XCTAssertEqual(storedResponse.data.first, 7)
+    }
+    
+    func testMemoryEvictionIsLeastRecentlyUsedFirst() throws {
+        let pairs = try [ "https://apple.com/",
+                          "https://google.com/",
+                          "https://facebook.com/" ].map { try cachePair(for: $0, ofSize: aBit, storagePolicy: .allowedInMemoryOnly) }
+        let cache = try self.cache(memoryCapacity: lots, diskCapacity: 0)
+        
+        for (request, response) in pairs {
+            cache.storeCachedResponse(response, for: request)
+        }
+        XCTAssertEqual(cache.currentMemoryUsage, 3 * aBit)
+        
+        // Storing a response again replaces it instead of counting it twice.
+        cache.storeCachedResponse(pairs[2].1, for: pairs[2].0)
+        XCTAssertEqual(cache.currentMemoryUsage, 3 * aBit)
+        
+        // Using the oldest entry makes the second one the least recently used.
+        XCTAssertNotNil(cache.cachedResponse(for: pairs[0].0))
+        
+        cache.memoryCapacity = 2 * aBit
+        
+        XCTAssertEqual(cache.currentMemoryUsage, 2 * aBit)
+        XCTAssertNotNil(cache.cachedResponse(for: pairs[0].0))
+        XCTAssertNil(cache.cachedResponse(for: pairs[1].0))
+        XCTAssertNotNil(cache.cachedResponse(for: pairs[2].0))
+        
+        let statistics = cache.memoryCacheStatistics
+        XCTAssertEqual(statistics.hits, 3)
+        XCTAssertEqual(statistics.misses, 1)
+        XCTAssertEqual(statistics.evictions, 1)
+    }
+    
     // -----
     
     func cache(memoryCapacity: Int = 0, diskCapacity: Int = 0) throws -> URLCache {
@@ -255,6 +357,13 @@ class TestURLCache : XCTestCase {
         return (request, CachedURLResponse(response: response, data: data, storagePolicy: storagePolicy))
     }
     
+    func diskEntryCount() throws -> Int {
+        // The directory also holds the cache's index, which is not an entry.
+        return try FileManager.default.contentsOfDirectory(atPath: writableTestDirectoryURL.path).filter {
+            $0.hasSuffix(".cachedurlresponse")
+        }.count
+    }
+    
     var writableTestDirectoryURL: URL!
     
     override func setUp() {
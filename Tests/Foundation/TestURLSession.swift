@@ -105,6 +105,91 @@ final class TestURLSession: LoopbackServerTest, @unchecked Sendable {
         XCTAssertEqual("London", result, "Did not receive expected value")
     }
 
+    func test_reusedEasyHandlesStartFromDefaults() async throws {
+        guard #available(macOS 12.0, iOS 15.0, watchOS 8.0, tvOS 15.0, *) else { return }
+        // Requests on one session that run one after another pick up each
+        // other's easy handles; none of the options of the previous request
+        // may carry over.
+        let session = URLSession(configuration: .default)
+        let url = URL(string: "http://127.0.0.1:\(TestURLSession.serverPort)/requestHeaders")!
+        var headRequest = URLRequest(url: url)
+        headRequest.httpMethod = "HEAD"
+        headRequest.setValue("yes", forHTTPHeaderField: "X-Previous-Request")
+
+        for _ in 0..<5 {
+            let (headData, headResponse) = try await session.data(for: headRequest)
+            XCTAssertEqual((headResponse as? HTTPURLResponse)?.statusCode, 200)
+            XCTAssertTrue(headData.isEmpty)
+
+            let (data, response) = try await session.data(from: url)
+            XCTAssertEqual((response as? HTTPURLResponse)?.statusCode, 200)
+            let headers = String(decoding: data, as: UTF8.self)
+            XCTAssertFalse(headers.isEmpty, "The body should not be skipped as it was for HEAD")
+            XCTAssertFalse(headers.contains("X-Previous-Request"), "Headers should not carry over: \(headers)")
+        }
+        session.finishTasksAndInvalidate()
+    }
+
+    func test_largeBodyReceivedInChunks() async throws {
+        guard #available(macOS 12.0, iOS 15.0, watchOS 8.0, tvOS 15.0, *) else { return }
+        // The body arrives in many writes from libcurl; whether it is collected
+        // into the announced Content-Length or chunk by chunk, the completion
+        // handler and the task delegate must see the same bytes that were sent.
+        final class ChunkCollectingDelegate: NSObject, URLSessionDataDelegate, @unchecked Sendable {
+            let lock = NSLock()
+            var received = Data()
+            func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+                lock.withLock { received.append(data) }
+            }
+        }
+        let body = String((0..<(256 * 1024)).map { Character(UnicodeScalar(UInt8(65 + $0 % 26))) })
+        var request = URLRequest(url: try XCTUnwrap(URL(string: "http://127.0.0.1:\(TestURLSession.serverPort)/echo")))
+        request.httpMethod = "POST"
+        request.httpBody = Data(body.utf8)
+
+        let session = URLSession(configuration: .default)
+        let (data, response) = try await session.data(for: request)
+        XCTAssertEqual((response as? HTTPURLResponse)?.statusCode, 200)
+        XCTAssertEqual(data, Data(body.utf8))
+
+        let delegate = ChunkCollectingDelegate()
+        let (delegatedData, _) = try await session.data(for: request, delegate: delegate)
+        XCTAssertEqual(delegatedData, Data(body.utf8))
+        XCTAssertEqual(delegate.lock.withLock { delegate.received }, Data(body.utf8))
+
+        let gzipped = try await session.data(from: try XCTUnwrap(URL(string: "http://127.0.0.1:\(TestURLSession.serverPort)/gzipped-response")))
+        XCTAssertEqual(String(decoding: gzipped.0, as: UTF8.self), "Hello World!")
+        session.finishTasksAndInvalidate()
+    }
+
+    func test_mutatingReceivedChunkLeavesBodyIntact() async throws {
+        guard #available(macOS 12.0, iOS 15.0, watchOS 8.0, tvOS 15.0, *) else { return }
+        // The delegate owns the chunks it is given: scribbling over them must
+        // not show up in the body passed to the completion handler.
+        final class ChunkScribblingDelegate: NSObject, URLSessionDataDelegate, @unchecked Sendable {
+            let lock = NSLock()
+            var received = Data()
+            func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+                var chunk = data
+                lock.withLock { received.append(chunk) }
+                chunk.resetBytes(in: 0..<chunk.count)
+                XCTAssertTrue(chunk.allSatisfy { $0 == 0 })
+            }
+        }
+        let body = Data((0..<(256 * 1024)).map { UInt8(65 + $0 % 26) })
+        var request = URLRequest(url: try XCTUnwrap(URL(string: "http://127.0.0.1:\(TestURLSession.serverPort)/echo")))
+        request.httpMethod = "POST"
+        request.httpBody = body
+
+        let session = URLSession(configuration: .default)
+        let delegate = ChunkScribblingDelegate()
+        let (data, response) = try await session.data(for: request, delegate: delegate)
+        XCTAssertEqual((response as? HTTPURLResponse)?.statusCode, 200)
+        XCTAssertEqual(data, body)
+        XCTAssertEqual(delegate.lock.withLock { delegate.received }, body)
+        session.finishTasksAndInvalidate()
+    }
+
     func test_asyncDataFromURLWithDelegate() async throws {
         guard #available(macOS 12.0, iOS 15.0, watchOS 8.0, tvOS 15.0, *) else { return }
         // Sendable note: Access to ivars is essentially serialized by the XCTestExpectation. It would be better to do it with a lock, but this is sufficient for now.
@@ -324,6 +409,25 @@ final class TestURLSession: LoopbackServerTest, @unchecked Sendable {
         XCTAssertNotNil(location, "Download location was nil")
     }
 
+    func test_largeDownloadIsWrittenCompletely() async throws {
+        guard #available(macOS 12.0, iOS 15.0, watchOS 8.0, tvOS 15.0, *) else { return }
+        // Large enough for receiving to be paused while the file catches up.
+        let body = String((0..<(4 * 1024 * 1024)).map { Character(UnicodeScalar(UInt8(65 + $0 % 26))) })
+        var request = URLRequest(url: try XCTUnwrap(URL(string: "http://127.0.0.1:\(TestURLSession.serverPort)/echo")))
+        request.httpMethod = "POST"
+        request.httpBody = Data(body.utf8)
+
+        let session = URLSession(configuration: .default)
+        let (location, response) = try await session.download(for: request)
+        XCTAssertEqual((response as? HTTPURLResponse)?.statusCode, 200)
+        XCTAssertEqual(try Data(contentsOf: location), Data(body.utf8))
+
+        // Without a usable Content-Length nothing is preallocated.
+        let (gzippedLocation, _) = try await session.download(from: try XCTUnwrap(URL(string: "http://127.0.0.1:\(TestURLSession.serverPort)/gzipped-response")))
+        XCTAssertEqual(String(decoding: try Data(contentsOf: gzippedLocation), as: UTF8.self), "Hello World!")
+        session.finishTasksAndInvalidate()
+    }
+
     func test_asyncDownloadFromURLWithDelegate() async throws {
         guard #available(macOS 12.0, iOS 15.0, watchOS 8.0, tvOS 15.0, *) else { return }
         // Sendable note: Access to ivars is essentially serialized by the XCTestExpectation. It would be better to do it with a lock, but this is sufficient for now.
@@ -698,6 +802,36 @@ final class TestURLSession: LoopbackServerTest, @unchecked Sendable {
         #endif
     }
 
+    func test_concurrentRequestsOnOneSession() async throws {
+        #if os(Windows)
+        throw XCTSkip("This test is currently disabled on Windows")
+        #else
+        let urlString = "http://127.0.0.1:\(TestURLSession.serverPort)/Peru"
+        let session = URLSession(configuration: .default, delegate: nil, delegateQueue: nil)
+        let url = URL(string: urlString)!
+        let count = 20
+        let expect = expectation(description: "\(count) concurrent GET \(urlString)")
+        expect.expectedFulfillmentCount = count
+
+        let lock = NSLock()
+        nonisolated(unsafe) var bodies: [String?] = []
+        for _ in 0..<count {
+            let task = session.dataTask(with: url) { data, response, error in
+                defer { expect.fulfill() }
+                XCTAssertNil(error)
+                XCTAssertEqual((response as? HTTPURLResponse)?.statusCode, 200)
+                let body = data.flatMap { String(data: $0, encoding: .utf8) }
+                lock.withLock { bodies.append(body) }
+            }
+            task.resume()
+        }
+        waitForExpectations(timeout: 30)
+
+        XCTAssertEqual(bodies, Array(repeating: "Lima", count: count))
+        session.finishTasksAndInvalidate()
+        #endif
+    }
+
     func test_httpRedirectionWithCode300() async throws {
         let statusCode = 300
         for method in httpMethods {
@@ -1121,6 +1255,57 @@ final class TestURLSession: LoopbackServerTest, @unchecked Sendable {
         #endif
     }
 
+    func test_taskMetrics() async throws {
+        // Sendable note: Access to ivars is serialized by the XCTestExpectation.
+        final class MetricsDelegate: NSObject, URLSessionDataDelegate, @unchecked Sendable {
+            var metrics: URLSessionTaskMetrics?
+            let expectation: XCTestExpectation
+            init(expectation: XCTestExpectation) {
+                self.expectation = expectation
+            }
+            func urlSession(_ session: URLSession, task: URLSessionTask, didFinishCollecting metrics: URLSessionTaskMetrics) {
+                XCTAssertNil(self.metrics, "Metrics should only be delivered once")
+                self.metrics = metrics
+            }
+            func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+                XCTAssertNil(error)
+                XCTAssertNotNil(metrics, "Metrics should be delivered before the task completes")
+                expectation.fulfill()
+            }
+        }
+
+        let delegate = MetricsDelegate(expectation: expectation(description: "metrics"))
+        let session = URLSession(configuration: .default, delegate: delegate, delegateQueue: nil)
+        let url = try XCTUnwrap(URL(string: "http://127.0.0.1:\(TestURLSession.serverPort)/redirect/2"))
+        session.dataTask(with: url).resume()
+        waitForExpectations(timeout: 12)
+        session.finishTasksAndInvalidate()
+
+        let metrics = try XCTUnwrap(delegate.metrics)
+        XCTAssertEqual(metrics.redirectCount, 2)
+        XCTAssertEqual(metrics.transactionMetrics.count, 3)
+        XCTAssertEqual(metrics.transactionMetrics.map { $0.request.url?.path }, ["/redirect/2", "/redirect/1", "/jsonBody"])
+        for transaction in metrics.transactionMetrics {
+            XCTAssertEqual(transaction.resourceFetchType, .networkLoad)
+            XCTAssertEqual(transaction.remoteAddress, "127.0.0.1")
+            XCTAssertEqual(transaction.remotePort, String(TestURLSession.serverPort))
+            XCTAssertGreaterThan(transaction.countOfResponseHeaderBytesReceived, 0)
+            XCTAssertGreaterThan(transaction.countOfRequestHeaderBytesSent, 0)
+            let fetchStart = try XCTUnwrap(transaction.fetchStartDate)
+            let responseStart = try XCTUnwrap(transaction.responseStartDate)
+            let responseEnd = try XCTUnwrap(transaction.responseEndDate)
+            XCTAssertLessThanOrEqual(fetchStart, responseStart)
+            XCTAssertLessThanOrEqual(responseStart, responseEnd)
+            XCTAssertTrue(metrics.taskInterval.contains(fetchStart))
+            if !transaction.isReusedConnection, let connectEnd = transaction.connectEndDate {
+                XCTAssertLessThanOrEqual(connectEnd, responseStart)
+            }
+        }
+        let last = try XCTUnwrap(metrics.transactionMetrics.last)
+        XCTAssertEqual((last.response as? HTTPURLResponse)?.statusCode, 200)
+        XCTAssertEqual(last.countOfResponseBodyBytesAfterDecoding, last.response?.expectedContentLength)
+    }
+
     func test_willPerformRedirect() async throws {
         let urlString = "http://127.0.0.1:\(TestURLSession.serverPort)/redirect/1"
         let url = try XCTUnwrap(URL(string: urlString))
@@ -199,6 +199,100 @@ class TestXMLParser : XCTestCase {
         ElementNameChecker("myPrefix:myLocalName").check()
     }
 
+    func test_bufferSize() throws {
+        let xml = TestXMLParser.xmlUnderTest(encoding: .utf16LittleEndian)
+        let data = xml.data(using: .utf16LittleEndian)!
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("TestXMLParser-\(UUID().uuidString).xml")
+        try data.write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        // Text may be reported in pieces when it spans chunks.
+        func coalesced(_ events: [XMLParserDelegateEvent]) -> [XMLParserDelegateEvent] {
+            var result: [XMLParserDelegateEvent] = []
+            for event in events {
+                if case .foundCharacters(let string) = event, case .foundCharacters(let previous)? = result.last {
+                    result[result.count - 1] = .foundCharacters(previous + string)
+                } else {
+                    result.append(event)
+                }
+            }
+            return result
+        }
+
+        // Sizes smaller than the 4 bytes used to detect the encoding split it across chunks.
+        for bufferSize in [1, 3, 5, 64, 4096 * 32] {
+            let fileParser = try XCTUnwrap(XMLParser(contentsOf: url))
+            let fileStream = XMLParserDelegateEventStream()
+            fileParser.delegate = fileStream
+            fileParser.bufferSize = bufferSize
+            XCTAssertTrue(fileParser.parse(), "bufferSize \(bufferSize)")
+            XCTAssertEqual(coalesced(fileStream.events), TestXMLParser.xmlUnderTestExpectedEvents(), "bufferSize \(bufferSize)")
+
+            let streamParser = XMLParser(stream: InputStream(data: data))
+            let streamStream = XMLParserDelegateEventStream()
+            streamParser.delegate = streamStream
+            streamParser.bufferSize = bufferSize
+            XCTAssertTrue(streamParser.parse(), "bufferSize \(bufferSize)")
+            XCTAssertEqual(coalesced(streamStream.events), TestXMLParser.xmlUnderTestExpectedEvents(), "bufferSize \(bufferSize)")
+        }
+    }
+
+    func test_fastDelegate() {
+        class Delegate: NSObject, XMLParserFastDelegate, XMLParserDelegate {
+            var events: [String] = []
+            var text = [UInt8]()
+            var mappedPrefixes: [String] = []
+
+            func parser(_ parser: XMLParser, didStartElement element: XMLParser.ElementName, attributes: XMLParser.Attributes) {
+                let attributeDescriptions = attributes.map { "\($0.qualifiedName)=\($0.stringValue)" }
+                events.append("start \(element.qualifiedName) {\(element.namespaceURI ?? "")} [\(attributeDescriptions.joined(separator: " "))]")
+                if let id = attributes[localName: "id"] {
+                    events.append("id \(String(decoding: id, as: UTF8.self))")
+                }
+                XCTAssertNil(attributes[localName: "missing"])
+            }
+            func parser(_ parser: XMLParser, didEndElement element: XMLParser.ElementName) {
+                events.append("end \(element.qualifiedName)")
+            }
+            func parser(_ parser: XMLParser, foundCharacters bytes: UnsafeBufferPointer<UInt8>) {
+                text.append(contentsOf: bytes)
+            }
+            func parser(_ parser: XMLParser, foundCDATA bytes: UnsafeBufferPointer<UInt8>) {
+                events.append("cdata \(String(decoding: bytes, as: UTF8.self))")
+            }
+            func parser(_ parser: XMLParser, didStartMappingPrefix prefix: String, toURI namespaceURI: String) {
+                mappedPrefixes.append(prefix)
+            }
+            func parser(_ parser: XMLParser, didStartElement elementName: String, namespaceURI: String?, qualifiedName qName: String?, attributes attributeDict: [String : String]) {
+                XCTFail("Element events should only be sent to the fast delegate")
+            }
+        }
+
+        let xml = """
+        <root xmlns="urn:default" xmlns:x="urn:x"><x:item id="1" x:kind="a&amp;b">caf\u{E9}</x:item><item id="2"><![CDATA[<raw>]]></item></root>
+        """
+        let parser = XMLParser(data: Data(xml.utf8))
+        let delegate = Delegate()
+        defer { _fixLifetime(delegate) }
+        parser.delegate = delegate
+        parser.fastDelegate = delegate
+        parser.shouldReportNamespacePrefixes = true
+        XCTAssertTrue(parser.parse())
+        XCTAssertEqual(delegate.events, [
+            "start root {urn:default} []",
+            "start x:item {urn:x} [id=1 x:kind=a&b]",
+            "id 1",
+            "end x:item",
+            "start item {urn:default} [id=2]",
+            "id 2",
+            "cdata <raw>",
+            "end item",
+            "end root",
+        ])
+        XCTAssertEqual(String(decoding: delegate.text, as: UTF8.self), "caf\u{E9}")
+        XCTAssertEqual(Set(delegate.mappedPrefixes), ["", "x"])
+    }
+
     func testExternalEntity() throws {
         class Delegate: XMLParserDelegateEventStream {
             override func parserDidStartDocument(_ parser: XMLParser) {